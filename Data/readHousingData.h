@@ -6,6 +6,8 @@
 #define READHOUSINGDATA_H
 
 #include "csv.h"
+#include "../Math/Layout.h"
+#include "../Math/Matrix.h"
 
 struct HousingRecord {
     float longitude;
@@ -58,27 +60,36 @@ std::vector<HousingRecord> readHousingData(const std::string& filename) {
     return records;
 }
 
-std::pair<Math::Matrix<float>, Math::Matrix<float>> getXandYVectors(const std::vector<HousingRecord> &records) {
+std::pair<Math::Matrix<float>, Math::Matrix<float>> getXandYVectors(const std::vector<HousingRecord> &records,
+                                                                    Math::Layout layout = Math::Layout::FeatureMajor) {
     using namespace Math;
-    Matrix<float> X(12, records.size(), 0); // 9 features
-    Matrix<float> Y(1, records.size(), 0); // target variable
+    constexpr std::size_t features = 12;
+    const bool featureMajor = layout == Layout::FeatureMajor;
+    Matrix<float> X(featureMajor ? features : records.size(), featureMajor ? records.size() : features, 0); // 9 features
+    Matrix<float> Y(featureMajor ? 1 : records.size(), featureMajor ? records.size() : 1, 0); // target variable
 
     for (std::size_t i = 0; i < records.size(); ++i) {
         const auto& r = records[i];
-        X(0, i) = r.longitude;
-        X(1, i) = r.latitude;
-        X(2, i) = r.housingMedianAge;
-        X(3, i) = r.totalRooms;
-        X(4, i) = r.totalBedrooms;
-        X(5, i) = r.population;
-        X(6, i) = r.households;
-        X(7,i) = (r.totalBedrooms+1)/(r.households+1); // bedrooms per household
-        X(8, i) = (r.totalBedrooms+1)/(r.totalRooms+1); // bedrooms per room
-        X(9, i) = (r.population+1)/(r.households+1);
-        X(10, i) = r.medianIncome;
-        X(11, i) = r.oceanProximity; // categorical feature as numeric (not optimal) one-hot-encoding better?
+        const float sample[features] = {
+            r.longitude,
+            r.latitude,
+            r.housingMedianAge,
+            r.totalRooms,
+            r.totalBedrooms,
+            r.population,
+            r.households,
+            (r.totalBedrooms+1)/(r.households+1), // bedrooms per household
+            (r.totalBedrooms+1)/(r.totalRooms+1), // bedrooms per room
+            (r.population+1)/(r.households+1),
+            r.medianIncome,
+            r.oceanProximity // categorical feature as numeric (not optimal) one-hot-encoding better?
+        };
 
-        Y(0, i) = r.medianHouseValue; // Target label
+        // One sample is a column (feature-major) or a contiguous row (sample-major)
+        for (std::size_t f = 0; f < features; ++f)
+            (featureMajor ? X.unchecked(f, i) : X.unchecked(i, f)) = sample[f];
+
+        (featureMajor ? Y.unchecked(0, i) : Y.unchecked(i, 0)) = r.medianHouseValue; // Target label
     }
 
     return std::make_pair(X, Y);
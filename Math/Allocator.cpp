@@ -0,0 +1,25 @@
+//
+// Created by timwe on 11/19/2025.
+//
+
+#include "Allocator.h"
+
+#include <atomic>
+
+namespace Math::Memory {
+    namespace {
+        // function static, matrices may be created during static initialisation of other translation units
+        std::atomic<std::pmr::memory_resource*>& current() noexcept {
+            static std::atomic<std::pmr::memory_resource*> resource{std::pmr::new_delete_resource()};
+            return resource;
+        }
+    }
+
+    std::pmr::memory_resource* defaultResource() noexcept {
+        return current().load(std::memory_order_acquire);
+    }
+
+    std::pmr::memory_resource* setDefaultResource(std::pmr::memory_resource* resource) noexcept {
+        return current().exchange(resource ? resource : std::pmr::new_delete_resource(), std::memory_order_acq_rel);
+    }
+} // Math::Memory
@@ -0,0 +1,99 @@
+//
+// Created by timwe on 11/19/2025.
+//
+
+#ifndef NEUROINFORMATICS_ALLOCATOR_H
+#define NEUROINFORMATICS_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Storage of Matrix. Every buffer starts on a cache line, so with the default stride (multiple of 8 floats / 4 doubles)
+ * every row starts 32 byte aligned. The memory comes from a std::pmr::memory_resource, the hook for arenas and pools:
+ *
+ *      std::pmr::monotonic_buffer_resource arena(1 << 20);
+ *      Math::Matrix<float> A(64, 128, 0, &arena);      // lives in the arena, freeing it is a no-op
+ *      Math::Memory::setDefaultResource(&arena);       // or for every matrix created from now on
+ *
+ * Construction without arguments is default-initialisation, so resize() doesn't memset; Matrix decides when a
+ * buffer needs zeroes (see Math::uninitialized).
+ * Copies of a matrix go to the default resource (like std::pmr), moves and swaps keep their memory.
+ */
+
+namespace Math {
+    // Matrix constructor tag: the valid elements are left uninitialised (padding is still zeroed), for results that
+    // get overwritten anyway
+    struct Uninitialized {
+        explicit Uninitialized() = default;
+    };
+    inline constexpr Uninitialized uninitialized{};
+}
+
+namespace Math::Memory {
+    inline constexpr std::size_t alignment = 64; // cache line, also a full AVX-512 register
+
+    // Resource new matrices use when none is given, new/delete until changed
+    [[nodiscard]] std::pmr::memory_resource* defaultResource() noexcept;
+    std::pmr::memory_resource* setDefaultResource(std::pmr::memory_resource* resource) noexcept; // returns the previous one, nullptr resets to new/delete
+
+    template<class T>
+    class AlignedAllocator {
+    private:
+        std::pmr::memory_resource* resource_;
+
+        template<class U>
+        friend class AlignedAllocator;
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        AlignedAllocator() noexcept : resource_(defaultResource()) {}
+        AlignedAllocator(std::pmr::memory_resource* resource) noexcept : resource_(resource ? resource : defaultResource()) {}
+        template<class U>
+        AlignedAllocator(const AlignedAllocator<U>& other) noexcept : resource_(other.resource_) {}
+
+        [[nodiscard]] T* allocate(std::size_t n) {
+            if (n > static_cast<std::size_t>(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(this->resource_->allocate(n * sizeof(T), std::max(alignment, alignof(T))));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            this->resource_->deallocate(p, n * sizeof(T), std::max(alignment, alignof(T)));
+        }
+
+        // No value-initialisation, vector::resize(n) leaves floats uninitialised
+        template<class U>
+        void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            ::new(static_cast<void*>(p)) U;
+        }
+
+        template<class U, class... Args>
+        void construct(U* p, Args&&... args) {
+            ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] AlignedAllocator select_on_container_copy_construction() const noexcept {
+            return AlignedAllocator();
+        }
+
+        [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+            return this->resource_;
+        }
+
+        template<class U>
+        bool operator==(const AlignedAllocator<U>& other) const noexcept {
+            return this->resource_ == other.resource_ || this->resource_->is_equal(*other.resource_);
+        }
+    };
+} // Math::Memory
+
+#endif //NEUROINFORMATICS_ALLOCATOR_H
@@ -0,0 +1,40 @@
+//
+// Created by timwe on 11/23/2025.
+//
+
+#ifndef NEUROINFORMATICS_BFLOAT16_H
+#define NEUROINFORMATICS_BFLOAT16_H
+
+#include <cstdint>
+
+/*
+ * 16 bit storage type, the upper half of an IEEE float: 8 exponent bits like float (no overflow float wouldn't have),
+ * 7 mantissa bits (~3 significant digits). It's only for storage, everything converts to float to compute, so half
+ * the memory traffic for weights and activation caches without a second set of kernels (see Precision.h).
+ * Software only: widening is a shift, narrowing rounds to nearest even; no CPU support is needed.
+ */
+
+namespace Math {
+    struct bfloat16 {
+        std::uint16_t bits; // uninitialised by default like float, so Matrix<bfloat16>(..., uninitialized) doesn't memset
+
+        bfloat16() = default;
+        explicit bfloat16(float value) noexcept : bits(fromFloat(value)) {}
+
+        operator float() const noexcept { return toFloat(this->bits); } // exact
+
+        [[nodiscard]] static constexpr float toFloat(std::uint16_t bits) noexcept {
+            return __builtin_bit_cast(float, static_cast<std::uint32_t>(bits) << 16);
+        }
+
+        // Round to nearest even, NaN stays a (quiet) NaN; integer only so -ffast-math can't drop the NaN check
+        [[nodiscard]] static constexpr std::uint16_t fromFloat(float value) noexcept {
+            const auto u = __builtin_bit_cast(std::uint32_t, value);
+            if ((u & 0x7fffffffu) > 0x7f800000u)
+                return static_cast<std::uint16_t>((u >> 16) | 0x40u);
+            return static_cast<std::uint16_t>((u + 0x7fffu + ((u >> 16) & 1u)) >> 16);
+        }
+    };
+} // Math
+
+#endif //NEUROINFORMATICS_BFLOAT16_H
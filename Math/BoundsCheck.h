@@ -0,0 +1,75 @@
+//
+// Created by timwe on 11/28/2025.
+//
+
+#ifndef NEUROINFORMATICS_BOUNDSCHECK_H
+#define NEUROINFORMATICS_BOUNDSCHECK_H
+
+#include <cstddef>
+#include <stdexcept>
+
+/*
+ * Bounds checks of Matrix / MatrixView::operator(), decided at compile time:
+ *
+ *      NEUROINFORMATICS_BOUNDS_CHECKS=1    every access checked, throws std::out_of_range
+ *      NEUROINFORMATICS_BOUNDS_CHECKS=0    unchecked, the index is assumed to be in range so loops over operator()
+ *                                          vectorise like loops over a pointer
+ *      not defined                         checked unless NDEBUG is defined, always checked with ASan / TSan
+ *
+ * CMake sets it for the library and everything linking it (NEUROINFORMATICS_BOUNDS_CHECKS=ON/OFF/AUTO), so all
+ * translation units see the same inline accessors. Kernel code that has already checked its ranges uses
+ * unchecked(r, c), which never checks.
+ */
+
+#if !defined(NEUROINFORMATICS_BOUNDS_CHECKS)
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define NEUROINFORMATICS_BOUNDS_CHECKS 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define NEUROINFORMATICS_BOUNDS_CHECKS 1
+#endif
+#endif
+#endif
+
+#if !defined(NEUROINFORMATICS_BOUNDS_CHECKS)
+#if defined(NDEBUG)
+#define NEUROINFORMATICS_BOUNDS_CHECKS 0
+#else
+#define NEUROINFORMATICS_BOUNDS_CHECKS 1
+#endif
+#endif
+
+// [[assume]] where the compiler has it (C++23, GCC 13 / Clang 19), the builtins before that
+#if defined(__has_cpp_attribute) && __has_cpp_attribute(assume)
+#define NEUROINFORMATICS_ASSUME(condition) [[assume(condition)]]
+#elif defined(__clang__)
+#define NEUROINFORMATICS_ASSUME(condition) __builtin_assume(condition)
+#elif defined(__GNUC__)
+#define NEUROINFORMATICS_ASSUME(condition) do { if (!(condition)) __builtin_unreachable(); } while (false)
+#else
+#define NEUROINFORMATICS_ASSUME(condition) do {} while (false)
+#endif
+
+namespace Math {
+    inline constexpr bool boundsChecked = NEUROINFORMATICS_BOUNDS_CHECKS != 0;
+
+    namespace Detail {
+        // Out of line and cold, so the inlined accessors are a compare and a branch that is never taken
+        [[noreturn, gnu::cold, gnu::noinline]] inline void throwOutOfRange(const char* what) {
+            throw std::out_of_range(what);
+        }
+    } // Detail
+
+    // r < rows && c < cols: thrown on if checks are on, assumed otherwise
+    inline void checkIndex(std::size_t r, std::size_t c, std::size_t rows, std::size_t cols, const char* what) noexcept(!boundsChecked) {
+        if constexpr (boundsChecked) {
+            if (r >= rows || c >= cols) [[unlikely]]
+                Detail::throwOutOfRange(what);
+        } else {
+            NEUROINFORMATICS_ASSUME(r < rows && c < cols);
+            (void)what;
+        }
+    }
+} // Math
+
+#endif //NEUROINFORMATICS_BOUNDSCHECK_H
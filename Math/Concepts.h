@@ -0,0 +1,25 @@
+//
+// Created by timwe on 11/14/2025.
+//
+
+#ifndef NEUROINFORMATICS_CONCEPTS_H
+#define NEUROINFORMATICS_CONCEPTS_H
+
+#include <concepts>
+#include <type_traits>
+
+namespace Math {
+    struct bfloat16; // BFloat16.h
+
+    template<typename T>
+    concept floatTypes = std::is_floating_point_v<T>;
+
+    // Element types a Matrix can store, bfloat16 only as storage (see Precision.h)
+    template<typename T>
+    concept storageTypes = floatTypes<T> || std::same_as<std::remove_cv_t<T>, bfloat16>;
+
+    template<typename T>
+    concept numericTypes = std::is_arithmetic_v<T>;
+}
+
+#endif //NEUROINFORMATICS_CONCEPTS_H
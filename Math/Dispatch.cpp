@@ -0,0 +1,160 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+#include "Dispatch.h"
+#include "IsaKernels.h"
+
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#define NEUROINFORMATICS_X86_DISPATCH 1
+#endif
+
+namespace Math::Dispatch {
+    namespace {
+#if defined(NEUROINFORMATICS_X86_DISPATCH)
+        unsigned long long xgetbv0() noexcept {
+            unsigned int eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<unsigned long long>(edx) << 32) | eax;
+        }
+
+        IsaLevel detect() noexcept {
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return IsaLevel::Generic;
+
+            const bool osxsave = ecx & (1u << 27), avx = ecx & (1u << 28), fma = ecx & (1u << 12);
+            if (!osxsave || !avx || !fma)
+                return IsaLevel::Generic;
+
+            // The OS has to save the ymm (and for AVX-512 the zmm + mask) registers on context switches
+            const unsigned long long xcr0 = xgetbv0();
+            if ((xcr0 & 0x6) != 0x6)
+                return IsaLevel::Generic;
+
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return IsaLevel::Generic;
+
+            const bool avx2 = ebx & (1u << 5), avx512f = ebx & (1u << 16);
+            if (avx512f && (xcr0 & 0xe6) == 0xe6)
+                return IsaLevel::AVX512;
+            return avx2 ? IsaLevel::AVX2 : IsaLevel::Generic;
+        }
+
+        // Only asked once the AVX512 level (and with it the zmm state) is known to work
+        bool detectVnni() noexcept {
+            unsigned int eax, ebx, ecx, edx;
+            if (detectedIsa() != IsaLevel::AVX512 || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return false;
+            const bool avx512bw = ebx & (1u << 30), avx512vnni = ecx & (1u << 11);
+            return avx512bw && avx512vnni;
+        }
+#else
+        IsaLevel detect() noexcept {
+            return IsaLevel::Generic;
+        }
+
+        bool detectVnni() noexcept {
+            return false;
+        }
+#endif
+
+        IsaLevel clampToDetected(IsaLevel level) noexcept {
+            return static_cast<int>(level) > static_cast<int>(detectedIsa()) ? detectedIsa() : level;
+        }
+
+        // Detected level, or NEUROINFORMATICS_ISA if it is set
+        IsaLevel startupIsa() {
+            const char* value = std::getenv("NEUROINFORMATICS_ISA");
+            if (value == nullptr || *value == '\0')
+                return detectedIsa();
+
+            std::string name(value);
+            for (auto& c : name)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+            IsaLevel requested;
+            if (name == "generic")
+                requested = IsaLevel::Generic;
+            else if (name == "avx2")
+                requested = IsaLevel::AVX2;
+            else if (name == "avx512")
+                requested = IsaLevel::AVX512;
+            else {
+                std::cerr << "NEUROINFORMATICS_ISA=" << value << " is unknown (generic, avx2, avx512), using " << isaName(detectedIsa()) << "\n";
+                return detectedIsa();
+            }
+
+            const IsaLevel level = clampToDetected(requested);
+            if (level != requested)
+                std::cerr << "NEUROINFORMATICS_ISA=" << value << " is not supported by this CPU, using " << isaName(level) << "\n";
+            return level;
+        }
+
+        constexpr int notSet = -1;
+        std::atomic<int> forced{notSet};
+    } // namespace
+
+    IsaLevel detectedIsa() noexcept {
+        static const IsaLevel level = detect();
+        return level;
+    }
+
+    IsaLevel activeIsa() noexcept {
+        static const IsaLevel startup = startupIsa();
+        const int level = forced.load(std::memory_order_relaxed);
+        return level == notSet ? startup : static_cast<IsaLevel>(level);
+    }
+
+    IsaLevel setIsa(IsaLevel level) noexcept {
+        const IsaLevel used = clampToDetected(level);
+        forced.store(static_cast<int>(used), std::memory_order_relaxed);
+        return used;
+    }
+
+    const char* isaName(IsaLevel level) noexcept {
+        switch (level) {
+            case IsaLevel::AVX512: return "avx512";
+            case IsaLevel::AVX2: return "avx2";
+            default: return "generic";
+        }
+    }
+
+    template<floatTypes T>
+    const KernelTable<T>& kernels() noexcept {
+#if defined(NEUROINFORMATICS_X86_DISPATCH)
+        switch (activeIsa()) {
+            case IsaLevel::AVX512: return kernelTable<T, Simd::AVX512>();
+            case IsaLevel::AVX2: return kernelTable<T, Simd::AVX2>();
+            default: break;
+        }
+#endif
+        return kernelTable<T, Simd::Generic>();
+    }
+
+    bool detectedVnni() noexcept {
+        static const bool vnni = detectVnni();
+        return vnni;
+    }
+
+    const Int8KernelTable& int8Kernels() noexcept {
+#if defined(NEUROINFORMATICS_X86_DISPATCH)
+        switch (activeIsa()) {
+            case IsaLevel::AVX512: return detectedVnni() ? int8KernelTable<Simd::AVX512VNNI>() : int8KernelTable<Simd::AVX512>();
+            case IsaLevel::AVX2: return int8KernelTable<Simd::AVX2>();
+            default: break;
+        }
+#endif
+        return int8KernelTable<Simd::Generic>();
+    }
+
+    template const KernelTable<float>& kernels<float>() noexcept;
+    template const KernelTable<double>& kernels<double>() noexcept;
+} // Math::Dispatch
@@ -0,0 +1,113 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+#ifndef NEUROINFORMATICS_DISPATCH_H
+#define NEUROINFORMATICS_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "BFloat16.h"
+#include "Concepts.h"
+#include "Gemm.h"
+#include "VectorMath.h"
+
+/*
+ * Runtime ISA dispatch. The hot kernels (gemm and its epilogue, the VectorMath maps, row sums, transposes) are compiled once per ISA level in
+ * Math/Isa/<level>.cpp, each with its own -m flags, the rest of the build only targets baseline x86-64. The best level the
+ * CPU and OS support is read from CPUID once, the first time a kernel is needed.
+ *
+ *      NEUROINFORMATICS_ISA=generic|avx2|avx512    force a level (e.g. for A/B benchmarks), clamped to what the CPU has
+ *      Math::Dispatch::setIsa(level)               same from code, returns the level that is actually used
+ *
+ * The int8 gemm has one more kernel on AVX512: the VNNI dot product, used whenever the CPU has it and the level is AVX512.
+ */
+
+namespace Math::Dispatch {
+    enum class IsaLevel {
+        Generic, AVX2, AVX512
+    };
+
+    [[nodiscard]] IsaLevel detectedIsa() noexcept; // best level supported by CPU + OS
+    [[nodiscard]] IsaLevel activeIsa() noexcept; // level the kernels currently run with
+    IsaLevel setIsa(IsaLevel level) noexcept; // not meant to be called while kernels run on other threads
+    [[nodiscard]] const char* isaName(IsaLevel level) noexcept;
+
+    template<floatTypes T>
+    struct KernelTable {
+        using UnaryMap = void (*)(const T* in, T* out, std::size_t n);
+
+        // epilogue may be nullptr
+        void (*gemm)(Gemm::Transpose, Gemm::Transpose, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                     const T* A, std::size_t lda, const T* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                     const Gemm::Epilogue<T>* epilogue);
+        std::size_t gemmMR, gemmNR; // register tile of the gemm, parallel splits of C are multiples of it
+
+        // The same gemm with bfloat16 operands (gemmBT: A is bfloat16, B is T), widened while packing, accumulated in T
+        template<class SA, class SB>
+        using MixedGemm = void (*)(Gemm::Transpose, Gemm::Transpose, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                                   const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                                   const Gemm::Epilogue<T>* epilogue);
+        MixedGemm<bfloat16, bfloat16> gemmBB;
+        MixedGemm<bfloat16, T> gemmBT;
+        MixedGemm<T, bfloat16> gemmTB;
+        // The epilogue on the rows x cols block of C at (row0, col0) of the product the epilogue was set up for
+        void (*epilogue)(std::size_t rows, std::size_t cols, T* C, std::size_t ldc, const Gemm::Epilogue<T>& epilogue,
+                         std::size_t row0, std::size_t col0);
+
+        UnaryMap exp, expm1, log1p, tanh, sigmoid, softplus, mish, relu, delu, selu;
+        void (*log)(const T* in, T* out, std::size_t n, T invLnBase);
+        void (*elu)(const T* in, T* out, std::size_t n, T alpha);
+        void (*leakyRelu)(const T* in, T* out, std::size_t n, T slope);
+
+        // out[r * outStride] = sum of the cols valid elements of row r
+        void (*rowSums)(const T* A, std::size_t rows, std::size_t cols, std::size_t stride, T* out, std::size_t outStride);
+        T (*sum)(const T* A, std::size_t rows, std::size_t cols, std::size_t stride);
+        // moments = {mean, sum of squared deviations, min, max} of the first cols elements of row, cols > 0
+        void (*rowMoments)(const T* row, std::size_t cols, T* moments);
+
+        // Leaves of the recursive transposes (Matrix.cpp), see TransposeKernels.h
+        void (*transpose)(const T* src, std::size_t rows, std::size_t cols, std::size_t srcStride, T* dst, std::size_t dstStride);
+        void (*transposeSwap)(T* a, T* b, std::size_t rows, std::size_t cols, std::size_t stride);
+    };
+
+    template<floatTypes T>
+    [[nodiscard]] const KernelTable<T>& kernels() noexcept; // table of the active level
+
+    [[nodiscard]] bool detectedVnni() noexcept; // AVX512 VNNI (and BW) on top of the AVX512 level
+
+    struct Int8KernelTable {
+        // C (M x N) = A (M x K) * B^T, B stored N x K; K, lda, ldb multiples of 64, see Gemm::gemmU8S8
+        void (*gemmU8S8)(std::size_t M, std::size_t N, std::size_t K, const std::uint8_t* A, std::size_t lda,
+                         const std::int8_t* B, std::size_t ldb, std::int32_t* C, std::size_t ldc);
+    };
+
+    [[nodiscard]] const Int8KernelTable& int8Kernels() noexcept; // table of the active level
+
+    // Simd::transform for the ops of VectorMath.h, on the active level
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Exp) noexcept { kernels<T>().exp(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Expm1) noexcept { kernels<T>().expm1(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Log1p) noexcept { kernels<T>().log1p(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Tanh) noexcept { kernels<T>().tanh(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Sigmoid) noexcept { kernels<T>().sigmoid(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Softplus) noexcept { kernels<T>().softplus(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Mish) noexcept { kernels<T>().mish(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Relu) noexcept { kernels<T>().relu(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Delu) noexcept { kernels<T>().delu(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, Simd::Selu) noexcept { kernels<T>().selu(in, out, n); }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, const Simd::Log& op) noexcept {
+        kernels<T>().log(in, out, n, static_cast<T>(op.invLnBase));
+    }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, const Simd::Elu& op) noexcept {
+        kernels<T>().elu(in, out, n, static_cast<T>(op.alpha));
+    }
+    template<floatTypes T> void transform(const T* in, T* out, std::size_t n, const Simd::LeakyRelu& op) noexcept {
+        kernels<T>().leakyRelu(in, out, n, static_cast<T>(op.slope));
+    }
+
+    extern template const KernelTable<float>& kernels<float>() noexcept;
+    extern template const KernelTable<double>& kernels<double>() noexcept;
+} // Math::Dispatch
+
+#endif //NEUROINFORMATICS_DISPATCH_H
@@ -0,0 +1,303 @@
+//
+// Created by timwe on 11/16/2025.
+//
+
+#ifndef NEUROINFORMATICS_ELEMENTWISE_H
+#define NEUROINFORMATICS_ELEMENTWISE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Allocator.h"
+#include "Concepts.h"
+#include "Dispatch.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+/*
+ * Element-wise kernels with the functor as template parameter, so the call gets inlined and the loop vectorized
+ * (no std::function in the hot loop). If every operand has the stride of the output they walk one flat range over
+ * the buffers (padding included, so there is no remainder loop per row), otherwise row by row; the padding of the
+ * output is reset to 0 afterwards.
+ *
+ *      mapInto(out, f, a)          out = f(a)          out is only reallocated if its rows/cols do not match
+ *      mapInto(out, f, a, b)       out = f(a, b)
+ *      mapInto(out, f, a, b, c)    out = f(a, b, c)
+ *      mapSumInto(out, sums, over, scale, f, a[, b])
+ *                                  out = f(a[, b]) and sums = scale * its sums over the columns or rows, one sweep
+ *      apply(m, f)                 m = f(m)            in place
+ *      zip(f, a, b)                returns f(a, b)     allocates the result
+ *
+ * The inputs of mapInto are MatrixView<const T>, so a Matrix or any slice of one works (see MatrixView.h).
+ * out may be one of the inputs, every element only depends on the same index of the operands (a view that only
+ * partly overlaps out is not allowed).
+ * If f is one of the register ops from VectorMath.h (Simd::Tanh{}, Simd::Log(base), ...) the unary forms run it a
+ * whole register at a time instead of calling a scalar functor per element, on the ISA level picked at runtime.
+ * Matrices bigger than Parallel::grainSize() elements are cut into chunks that run on the worker pool (ThreadPool.h),
+ * so f gets called from several threads at once and must not have side effects.
+ */
+
+namespace Math {
+    template<storageTypes T>
+    class Matrix;
+
+    // Which way mapSumInto adds up: over the columns gives a (rows x 1) column like Matrix::sumOverColumns, over the
+    // rows a (1 x cols) row like Matrix::sumOverRows
+    enum class SumOver { Columns, Rows };
+
+    namespace Kernels {
+        template<floatTypes T>
+        void requireSameShape(MatrixView<const T> a, MatrixView<const T> b, const char* where) {
+            if (a.rows() != b.rows() || a.cols() != b.cols())
+                throw std::invalid_argument(where);
+        }
+
+        // Makes out the shape of like (keeps the buffer, and its stride, if the rows and cols already match)
+        template<floatTypes T>
+        void prepareOutput(Matrix<T>& out, MatrixView<const T> like) {
+            if (out.rows() != like.rows() || out.cols() != like.cols())
+                out = Matrix<T>(like.rows(), like.cols(), uninitialized, 0, out.resource()); // every element gets written
+        }
+
+        template<storageTypes T>
+        void zeroPadding(T* data, std::size_t rows, std::size_t cols, std::size_t stride) noexcept {
+            if (cols == stride)
+                return;
+            for (std::size_t r = 0; r < rows; ++r)
+                for (std::size_t c = cols; c < stride; ++c)
+                    data[r * stride + c] = T{};
+        }
+
+        struct Block {
+            std::size_t r0, r1, c0, c1; // rows [r0, r1) x cols [c0, c1)
+        };
+
+        // Cuts a rows x cols index space into blocks of about grain elements: several whole rows if the rows are
+        // short, column ranges of a single row if they are long. The blocks only depend on the shape and the grain,
+        // so a reduction that adds up one partial per block in block order gives the same bits on any thread count.
+        struct BlockGrid {
+            std::size_t rows, cols, rowsPerBlock, colsPerBlock, rowBlocks, colBlocks;
+
+            BlockGrid(std::size_t _rows, std::size_t _cols, std::size_t grain = Parallel::grainSize()) noexcept
+                : rows(_rows), cols(_cols),
+                  rowsPerBlock(_cols >= grain ? 1 : grain / (_cols == 0 ? 1 : _cols)),
+                  colsPerBlock(_cols > grain ? grain : (_cols == 0 ? 1 : _cols)),
+                  rowBlocks((_rows + rowsPerBlock - 1) / rowsPerBlock),
+                  colBlocks(_cols == 0 ? 0 : (_cols + colsPerBlock - 1) / colsPerBlock) {}
+
+            [[nodiscard]] std::size_t count() const noexcept { return this->rowBlocks * this->colBlocks; }
+
+            [[nodiscard]] Block operator[](std::size_t i) const noexcept {
+                const std::size_t rb = i / this->colBlocks, cb = i % this->colBlocks;
+                const std::size_t r0 = rb * this->rowsPerBlock, c0 = cb * this->colsPerBlock;
+                return {r0, std::min(this->rows, r0 + this->rowsPerBlock), c0, std::min(this->cols, c0 + this->colsPerBlock)};
+            }
+        };
+
+        // f(block, index) for every block of the grid, in parallel if there is more than one
+        template<class F>
+        void forBlocks(const BlockGrid& grid, F&& f) {
+            const std::size_t count = grid.count();
+            if (count <= 1) {
+                if (count == 1)
+                    f(grid[0], std::size_t{0});
+                return;
+            }
+            Parallel::parallelFor(count, [&](std::size_t i) { f(grid[i], i); });
+        }
+
+        // One slot per block of grid for the reductions. The buffer belongs to the calling thread and only grows, so a
+        // reduction over a shape it has seen before doesn't allocate; the span is valid until the next call on that thread
+        template<floatTypes T>
+        std::span<T> blockPartials(const BlockGrid& grid) {
+            thread_local std::vector<T> buffer;
+            if (buffer.size() < grid.count())
+                buffer.resize(grid.count());
+            return {buffer.data(), grid.count()};
+        }
+
+        // Calls run(in..., out, n) on contiguous runs: chunks of the range from the first to the last valid element
+        // if every input has the stride of out (the gaps are padding of out, only ever written), otherwise the row
+        // pieces of each block. Big matrices run in parallel
+        template<floatTypes T, class Run, class... Views>
+        void forRuns(Matrix<T>& out, Run&& run, const Views&... in) {
+            const std::size_t rows = out.rows(), cols = out.cols(), stride = out.stride();
+            T* po = out.data().data();
+            if (rows == 0 || cols == 0)
+                return;
+
+            if (((in.stride() == stride) && ...)) {
+                Parallel::forChunks((rows - 1) * stride + cols, Parallel::grainSize(), [&](std::size_t begin, std::size_t end) {
+                    run((in.data() + begin)..., po + begin, end - begin);
+                });
+                return;
+            }
+
+            forBlocks(BlockGrid(rows, cols), [&](const Block& b, std::size_t) {
+                for (std::size_t r = b.r0; r < b.r1; ++r)
+                    run((in.data() + r * in.stride() + b.c0)..., po + r * stride + b.c0, b.c1 - b.c0);
+            });
+        }
+
+        // run(in..., out, n) on the row pieces of out like forRuns, and sums = scale * the sums of out over the columns
+        // or rows, every piece added up right after it was written while it is still in L1. The pieces follow the
+        // BlockGrid (over the columns) or column ranges that walk all rows in order (over the rows), so the sums come
+        // out the same on any thread count, like Matrix::sumOverColumnsInto / sumOverRowsInto
+        template<floatTypes T, class Run, class... Views>
+        void forRunsSummed(Matrix<T>& out, Matrix<T>& sums, SumOver over, T scale, Run&& run, const Views&... in) {
+            const std::size_t rows = out.rows(), cols = out.cols(), stride = out.stride();
+            if (&sums == &out)
+                throw std::invalid_argument("In Math::mapSumInto() sums can't be the output itself");
+            if (over == SumOver::Columns ? sums.rows() != rows || sums.cols() != 1 : sums.rows() != 1 || sums.cols() != cols)
+                sums = over == SumOver::Columns ? Matrix<T>(rows, 1, uninitialized, 0, sums.resource())
+                                                : Matrix<T>(1, cols, uninitialized, 0, sums.resource());
+
+            T* po = out.data().data();
+            T* ps = sums.data().data();
+            const auto& kernels = Dispatch::kernels<T>();
+            if (over == SumOver::Rows) {
+                const std::size_t width = std::max<std::size_t>(64, Parallel::grainSize() / std::max<std::size_t>(rows, 1) / 64 * 64);
+                Parallel::forChunks(cols, width, [&](std::size_t c0, std::size_t c1) {
+                    std::fill(ps + c0, ps + c1, T{0});
+                    for (std::size_t r = 0; r < rows; ++r) {
+                        T* o = po + r * stride + c0;
+                        run((in.data() + r * in.stride() + c0)..., o, c1 - c0);
+                        for (std::size_t c = 0; c < c1 - c0; ++c)
+                            ps[c0 + c] += o[c];
+                    }
+                    for (std::size_t c = c0; c < c1; ++c)
+                        ps[c] *= scale;
+                });
+                return;
+            }
+
+            const std::size_t sumStride = sums.stride();
+            const BlockGrid grid(rows, cols);
+            if (grid.colBlocks == 1) { // blocks of whole rows
+                forBlocks(grid, [&](const Block& b, std::size_t) {
+                    for (std::size_t r = b.r0; r < b.r1; ++r) {
+                        T* o = po + r * stride;
+                        run((in.data() + r * in.stride())..., o, cols);
+                        ps[r * sumStride] = kernels.sum(o, 1, cols, stride) * scale;
+                    }
+                });
+                return;
+            }
+
+            // Rows longer than the grain: one partial per block (block i is row i / colBlocks), added in order
+            const std::span<T> partials = blockPartials<T>(grid);
+            forBlocks(grid, [&](const Block& b, std::size_t i) {
+                T* o = po + b.r0 * stride + b.c0;
+                run((in.data() + b.r0 * in.stride() + b.c0)..., o, b.c1 - b.c0);
+                partials[i] = kernels.sum(o, 1, b.c1 - b.c0, stride);
+            });
+            for (std::size_t r = 0; r < rows; ++r) {
+                T sum = T{0};
+                for (std::size_t j = 0; j < grid.colBlocks; ++j)
+                    sum += partials[r * grid.colBlocks + j];
+                ps[r * sumStride] = sum * scale;
+            }
+        }
+    } // Kernels
+
+    template<floatTypes T, class F>
+    void mapInto(Matrix<T>& out, F f, std::type_identity_t<MatrixView<const T>> a) {
+        Kernels::prepareOutput(out, a);
+
+        Kernels::forRuns(out, [&f](const T* pa, T* po, std::size_t n) {
+            if constexpr (Simd::vectorOp<F, T>) {
+                Dispatch::transform(pa, po, n, f);
+            } else {
+                for (std::size_t i = 0; i < n; ++i)
+                    po[i] = f(pa[i]);
+            }
+        }, a);
+
+        Kernels::zeroPadding(out.data().data(), out.rows(), out.cols(), out.stride());
+    }
+
+    template<floatTypes T, class F>
+    void mapInto(Matrix<T>& out, F f, std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<MatrixView<const T>> b) {
+        Kernels::requireSameShape(a, b, "In Math::mapInto() operands are not the same size (rows/cols)");
+        Kernels::prepareOutput(out, a);
+
+        Kernels::forRuns(out, [&f](const T* pa, const T* pb, T* po, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                po[i] = f(pa[i], pb[i]);
+        }, a, b);
+
+        Kernels::zeroPadding(out.data().data(), out.rows(), out.cols(), out.stride());
+    }
+
+    template<floatTypes T, class F>
+    void mapInto(Matrix<T>& out, F f, std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<MatrixView<const T>> b,
+                 std::type_identity_t<MatrixView<const T>> c) {
+        Kernels::requireSameShape(a, b, "In Math::mapInto() operands are not the same size (rows/cols)");
+        Kernels::requireSameShape(a, c, "In Math::mapInto() operands are not the same size (rows/cols)");
+        Kernels::prepareOutput(out, a);
+
+        Kernels::forRuns(out, [&f](const T* pa, const T* pb, const T* pc, T* po, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                po[i] = f(pa[i], pb[i], pc[i]);
+        }, a, b, c);
+
+        Kernels::zeroPadding(out.data().data(), out.rows(), out.cols(), out.stride());
+    }
+
+    // sums must not be out or one of the inputs
+    template<floatTypes T, class F>
+    void mapSumInto(Matrix<T>& out, Matrix<T>& sums, SumOver over, std::type_identity_t<T> scale, F f,
+                    std::type_identity_t<MatrixView<const T>> a) {
+        Kernels::prepareOutput(out, a);
+
+        Kernels::forRunsSummed(out, sums, over, scale, [&f](const T* pa, T* po, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                po[i] = f(pa[i]);
+        }, a);
+
+        Kernels::zeroPadding(out.data().data(), out.rows(), out.cols(), out.stride());
+    }
+
+    template<floatTypes T, class F>
+    void mapSumInto(Matrix<T>& out, Matrix<T>& sums, SumOver over, std::type_identity_t<T> scale, F f,
+                    std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<MatrixView<const T>> b) {
+        Kernels::requireSameShape(a, b, "In Math::mapSumInto() operands are not the same size (rows/cols)");
+        Kernels::prepareOutput(out, a);
+
+        Kernels::forRunsSummed(out, sums, over, scale, [&f](const T* pa, const T* pb, T* po, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                po[i] = f(pa[i], pb[i]);
+        }, a, b);
+
+        Kernels::zeroPadding(out.data().data(), out.rows(), out.cols(), out.stride());
+    }
+
+    template<floatTypes T, class F>
+    void apply(Matrix<T>& m, F f) {
+        T* p = m.data().data();
+        Parallel::forChunks(m.bufferSize(), Parallel::grainSize(), [&](std::size_t begin, std::size_t end) {
+            if constexpr (Simd::vectorOp<F, T>) {
+                Dispatch::transform(p + begin, p + begin, end - begin, f);
+            } else {
+                for (std::size_t i = begin; i < end; ++i)
+                    p[i] = f(p[i]);
+            }
+        });
+
+        Kernels::zeroPadding(p, m.rows(), m.cols(), m.stride());
+    }
+
+    template<floatTypes T, class F>
+    [[nodiscard]] Matrix<T> zip(F f, const Matrix<T>& a, const Matrix<T>& b) {
+        Matrix<T> result;
+        mapInto(result, std::move(f), a, b);
+        return result;
+    }
+} // Math
+
+#endif //NEUROINFORMATICS_ELEMENTWISE_H
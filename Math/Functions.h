@@ -7,6 +7,9 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
+
+// Scalar reference versions. The Matrix activations use the vectorized ones from VectorMath.h instead.
 
 namespace Math::Functions {
     template <class T, class F>
@@ -16,7 +19,7 @@ namespace Math::Functions {
 
     template <class T>
     T tanh(T num) {
-        return (std::exp(num) - std::exp(-num)) / (std::exp(num) + std::exp(-num)); //Okay to use std::tanh?
+        return std::tanh(num); // the exp formula overflowed for |num| > 88 (float)
     }
 
     template <class T>
@@ -24,7 +27,7 @@ namespace Math::Functions {
         if(num <= -1)
             throw std::invalid_argument("log1p is undefined for num <= -1");
 
-        return log(std::exp(1.0), T{1} + num);
+        return std::log1p(num);
     }
 
     // TODO: Check if its numerically stable for large |Z|
@@ -40,7 +43,7 @@ namespace Math::Functions {
 
     template <class T>
     T softplus(T num) {
-        return log(std::exp(1.0), 1+std::exp(num)); // exp(1.0) to get e as the pre-defined base
+        return std::max(num, T{0}) + std::log1p(std::exp(-std::abs(num))); // log(1 + e^x) without overflowing e^x
     }
 
     template <class T>
@@ -55,7 +58,7 @@ namespace Math::Functions {
 
     template <class T>
     T delu(T num, int a = 1, int b = 2, double xc = 1.25643) { // https://en.wikipedia.org/wiki/Rectified_linear_unit#DELU
-        if(b != 0)
+        if(b == 0)
             throw std::invalid_argument("Invalid hyperparameter b for delu, has to be unequal to 0");
 
         return (num > xc) ? num : (std::exp(a*num)-1)/b;
@@ -71,7 +74,8 @@ namespace Math::Functions {
 
     template <class T>
     T clip(const T num, const double epsilon = 1e-7) { // https://stackoverflow.com/a/9324086
-        return std::max(epsilon, std::min(num, T{1}-epsilon));
+        const T eps = static_cast<T>(epsilon);
+        return std::max(eps, std::min(num, T{1}-eps));
     }
 
     template <class T>
@@ -0,0 +1,219 @@
+//
+// Created by timwe on 11/14/2025.
+//
+
+#include "Gemm.h"
+#include "GemmKernels.h"
+#include "Dispatch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace Math::Gemm {
+    namespace Detail {
+        template<floatTypes T>
+        T* packBuffer(std::size_t slot, std::size_t count) {
+            constexpr std::size_t alignment = 64; // cache line
+            static thread_local std::vector<T> storage[2]; // 0: packed A, 1: packed B
+
+            std::vector<T>& buffer = storage[slot];
+            const std::size_t pad = alignment / sizeof(T);
+            if (buffer.size() < count + pad)
+                buffer.resize(count + pad);
+
+            const auto address = reinterpret_cast<std::uintptr_t>(buffer.data());
+            return buffer.data() + ((alignment - address % alignment) % alignment) / sizeof(T);
+        }
+
+        template float* packBuffer<float>(std::size_t, std::size_t);
+        template double* packBuffer<double>(std::size_t, std::size_t);
+    } // Detail
+
+    namespace {
+        // Below this many flops per thread waking the pool costs more than it saves, the XOR / logic networks never
+        // get there
+        constexpr double minFlopsPerTask = 1 << 22;
+
+        struct Split {
+            std::size_t rows, cols; // C is cut into rows x cols macro tiles, one task each
+        };
+
+        // The grid with the most tiles (at most tasks) that still gives every tile at least one register tile. Among
+        // those the one that packs the least: every tile packs its rows of A and its columns of B, cols * M + rows * N
+        Split splitGrid(std::size_t M, std::size_t N, std::size_t tasks, std::size_t MR, std::size_t NR) {
+            const std::size_t rowTiles = (M + MR - 1) / MR, colTiles = (N + NR - 1) / NR;
+            Split best{1, 1};
+            for (std::size_t rows = 1; rows <= std::min(tasks, rowTiles); ++rows) {
+                const std::size_t cols = std::min(tasks / rows, colTiles);
+                const std::size_t used = rows * cols, bestUsed = best.rows * best.cols;
+                if (used > bestUsed || (used == bestUsed && cols * M + rows * N < best.cols * M + best.rows * N))
+                    best = {rows, cols};
+            }
+            return best;
+        }
+
+        // First row / column of part i of n, the register tiles are spread evenly so only the last part has an edge tile
+        std::size_t splitPoint(std::size_t i, std::size_t n, std::size_t tile, std::size_t total) {
+            const std::size_t tiles = (total + tile - 1) / tile;
+            return std::min(tiles * i / n * tile, total);
+        }
+
+        // The kernel of the active level for these operand types
+        template<floatTypes T, class SA, class SB>
+        auto kernelFor(const Dispatch::KernelTable<T>& kernels) noexcept {
+            if constexpr (std::same_as<SA, T> && std::same_as<SB, T>)
+                return kernels.gemm;
+            else if constexpr (std::same_as<SB, T>)
+                return kernels.gemmBT;
+            else if constexpr (std::same_as<SA, T>)
+                return kernels.gemmTB;
+            else
+                return kernels.gemmBB;
+        }
+
+        // The epilogue of the macro tile at (r0, c0): the same biases and output, starting at that row / column
+        template<floatTypes T>
+        Epilogue<T> shifted(const Epilogue<T>& e, std::size_t r0, std::size_t c0) noexcept {
+            Epilogue<T> tile = e;
+            if (tile.rowBias != nullptr)
+                tile.rowBias += r0 * tile.rowBiasStride;
+            if (tile.colBias != nullptr)
+                tile.colBias += c0;
+            if (tile.out != nullptr)
+                tile.out += r0 * tile.ldo + c0;
+            return tile;
+        }
+
+        template<floatTypes T, class SA, class SB>
+        void run(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                 const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                 const Epilogue<T>* epilogue = nullptr) {
+            if (M == 0 || N == 0)
+                return;
+
+            if (K == 0 || alpha == T{0}) {
+                for (std::size_t r = 0; r < M; ++r) {
+                    T* c = C + r * ldc;
+                    if (beta == T{0})
+                        std::fill_n(c, N, T{0});
+                    else
+                        for (std::size_t j = 0; j < N; ++j)
+                            c[j] *= beta;
+                }
+                if (epilogue != nullptr)
+                    applyEpilogue(M, N, C, ldc, *epilogue);
+                return;
+            }
+
+            const auto& kernels = Dispatch::kernels<T>();
+            const auto kernel = kernelFor<T, SA, SB>(kernels);
+            const auto tasks = std::min(Parallel::threadCount(), static_cast<std::size_t>(2.0 * M * N * K / minFlopsPerTask));
+            if (tasks <= 1 || Parallel::inParallelRegion()) {
+                kernel(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+                return;
+            }
+
+            // Every task runs the serial kernel on one macro tile of C, with its own (thread local) packing buffers
+            const Split split = splitGrid(M, N, tasks, kernels.gemmMR, kernels.gemmNR);
+            const std::size_t rsA = transA == Transpose::No ? lda : 1, csB = transB == Transpose::No ? 1 : ldb;
+            Parallel::parallelFor(split.rows * split.cols, [&](std::size_t task) {
+                const std::size_t i = task / split.cols, j = task % split.cols;
+                const std::size_t r0 = splitPoint(i, split.rows, kernels.gemmMR, M), r1 = splitPoint(i + 1, split.rows, kernels.gemmMR, M);
+                const std::size_t c0 = splitPoint(j, split.cols, kernels.gemmNR, N), c1 = splitPoint(j + 1, split.cols, kernels.gemmNR, N);
+                const Epilogue<T> tileEpilogue = epilogue != nullptr ? shifted(*epilogue, r0, c0) : Epilogue<T>{};
+                kernel(transA, transB, r1 - r0, c1 - c0, K, alpha, A + r0 * rsA, lda, B + c0 * csB, ldb, beta, C + r0 * ldc + c0, ldc,
+                       epilogue != nullptr ? &tileEpilogue : nullptr);
+            });
+        }
+    } // namespace
+
+    template<floatTypes T>
+    void gemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+              const T* A, std::size_t lda, const T* B, std::size_t ldb, T beta, T* C, std::size_t ldc) {
+        run<T, T, T>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+    template<floatTypes T, operandOf<T> SA, operandOf<T> SB>
+    requires (!std::same_as<SA, T> || !std::same_as<SB, T>)
+    void gemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+              const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc) {
+        run<T, SA, SB>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+    template<floatTypes T, operandOf<T> SA, operandOf<T> SB>
+    void gemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+              const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc, const Epilogue<T>& epilogue) {
+        run<T, SA, SB>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, &epilogue);
+    }
+
+    template<floatTypes T>
+    void applyEpilogue(std::size_t M, std::size_t N, T* C, std::size_t ldc, const Epilogue<T>& epilogue) {
+        const auto kernel = Dispatch::kernels<T>().epilogue;
+        const std::size_t rowsPerChunk = std::max<std::size_t>(1, Parallel::grainSize() / std::max<std::size_t>(N, 1));
+        Parallel::forChunks(M, rowsPerChunk, [&](std::size_t r0, std::size_t r1) {
+            kernel(r1 - r0, N, C + r0 * ldc, ldc, epilogue, r0, 0);
+        });
+    }
+
+    void gemmU8S8(std::size_t M, std::size_t N, std::size_t K, const std::uint8_t* A, std::size_t lda,
+                  const std::int8_t* B, std::size_t ldb, std::int32_t* C, std::size_t ldc) {
+        if (K % 64 != 0 || lda % 64 != 0 || ldb % 64 != 0)
+            throw std::invalid_argument("In Gemm::gemmU8S8() K, lda and ldb have to be multiples of 64");
+        if (M == 0 || N == 0)
+            return;
+
+        // Rows of C in parallel, in pairs (the VNNI kernel works on two rows at a time)
+        const auto kernel = Dispatch::int8Kernels().gemmU8S8;
+        const auto tasks = std::min({Parallel::threadCount(), (M + 1) / 2, static_cast<std::size_t>(2.0 * M * N * K / minFlopsPerTask)});
+        if (tasks <= 1 || Parallel::inParallelRegion()) {
+            kernel(M, N, K, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        Parallel::parallelFor(tasks, [&](std::size_t task) {
+            const std::size_t r0 = splitPoint(task, tasks, 2, M), r1 = splitPoint(task + 1, tasks, 2, M);
+            kernel(r1 - r0, N, K, A + r0 * lda, lda, B, ldb, C + r0 * ldc, ldc);
+        });
+    }
+
+    template<floatTypes T>
+    void referenceGemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                       const T* A, std::size_t lda, const T* B, std::size_t ldb, T beta, T* C, std::size_t ldc) {
+        for (std::size_t r = 0; r < M; ++r) {
+            for (std::size_t c = 0; c < N; ++c) {
+                T sum = T{0};
+                for (std::size_t k = 0; k < K; ++k) {
+                    const T a = transA == Transpose::No ? A[r * lda + k] : A[k * lda + r];
+                    const T b = transB == Transpose::No ? B[k * ldb + c] : B[c * ldb + k];
+                    sum += a * b;
+                }
+                C[r * ldc + c] = beta == T{0} ? alpha * sum : alpha * sum + beta * C[r * ldc + c];
+            }
+        }
+    }
+
+    template void gemm<float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    template void gemm<double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+    template void gemm<float, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t);
+    template void gemm<float, bfloat16, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    template void gemm<float, float, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t);
+    template void gemm<double, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t);
+    template void gemm<double, bfloat16, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+    template void gemm<double, double, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t);
+    template void gemm<float, float, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    template void gemm<float, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    template void gemm<float, bfloat16, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const float*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    template void gemm<float, float, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    template void applyEpilogue<float>(std::size_t, std::size_t, float*, std::size_t, const Epilogue<float>&);
+    template void gemm<double, double, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    template void gemm<double, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    template void gemm<double, bfloat16, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const double*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    template void gemm<double, double, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    template void applyEpilogue<double>(std::size_t, std::size_t, double*, std::size_t, const Epilogue<double>&);
+    template void referenceGemm<float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    template void referenceGemm<double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+} // Math::Gemm
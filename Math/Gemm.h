@@ -0,0 +1,151 @@
+//
+// Created by timwe on 11/14/2025.
+//
+
+#ifndef NEUROINFORMATICS_GEMM_H
+#define NEUROINFORMATICS_GEMM_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "BFloat16.h"
+#include "Concepts.h"
+
+/*
+ * General matrix multiply C = alpha * op(A) * op(B) + beta * C on row-major buffers (the same layout Matrix uses,
+ * ld* is the stride of a row). op(X) is X or X^T, the transpose is never materialised, it only changes how the
+ * operand is read while packing.
+ * Goto/BLIS style: B gets packed into kc x nc panels (L3), A into mc x kc panels (L2) and a MR x NR micro kernel
+ * keeps the C tile in registers while streaming one packed column of A and one packed row of B per k step (L1).
+ * The kernels live in GemmKernels.h and are built once per ISA level, gemm() runs the one Dispatch picked.
+ * Big enough products are cut into macro tiles of C that run on the worker pool (ThreadPool.h), each with the serial
+ * kernel and its own packing buffers. K is never split, so the result doesn't depend on the thread count.
+ * A and B may also be bfloat16 (one or both): they are widened to T while packing, which is the only place the kernel
+ * reads them, so the micro kernel, the accumulation and C stay in T.
+ * An Epilogue fuses what a dense layer does after the product: every register tile gets its bias added and the
+ * activation applied right after its last k block is stored, while it is still in L1, instead of two more passes over C.
+ */
+
+namespace Math::Gemm {
+    enum class Transpose {
+        No, Yes
+    };
+
+    // C (M x N) = alpha * op(A) (M x K) * op(B) (K x N) + beta * C
+    // A is stored M x K (or K x M if transposed), B is stored K x N (or N x K). C is not read if beta == 0.
+    template<floatTypes T>
+    void gemm(Transpose transA, Transpose transB,
+              std::size_t M, std::size_t N, std::size_t K,
+              T alpha,
+              const T* A, std::size_t lda,
+              const T* B, std::size_t ldb,
+              T beta,
+              T* C, std::size_t ldc);
+
+    // Element type of an operand of a T gemm: T, or bfloat16 as mixed precision storage
+    template<class S, class T>
+    concept operandOf = std::same_as<S, T> || std::same_as<S, bfloat16>;
+
+    // Activations the epilogue can apply, the register ops of VectorMath.h (Identity: none)
+    enum class Activation {
+        Identity, ReLU, Sigmoid, Tanh, Softplus, Elu, Delu, Mish, Selu, LeakyReLU
+    };
+
+    // Applied to every element of the finished C: C += rowBias[i * rowBiasStride] + colBias[j], then f(C) goes to
+    // out (C keeps the value before f) or, if out is nullptr, over C. Both biases are optional
+    template<floatTypes T>
+    struct Epilogue {
+        const T* rowBias = nullptr; // M values, e.g. the (n x 1) bias of a feature-major layer
+        std::size_t rowBiasStride = 1;
+        const T* colBias = nullptr; // N contiguous values, e.g. the (1 x n) bias of a sample-major layer
+        Activation activation = Activation::Identity;
+        T alpha = T{1}; // parameter of Elu, the slope of LeakyReLU
+        T* out = nullptr; // M x N with row stride ldo, must not overlap C
+        std::size_t ldo = 0;
+    };
+
+    // Same with at least one bfloat16 operand, T is deduced from alpha, beta and C
+    template<floatTypes T, operandOf<T> SA, operandOf<T> SB>
+    requires (!std::same_as<SA, T> || !std::same_as<SB, T>)
+    void gemm(Transpose transA, Transpose transB,
+              std::size_t M, std::size_t N, std::size_t K,
+              T alpha,
+              const SA* A, std::size_t lda,
+              const SB* B, std::size_t ldb,
+              T beta,
+              T* C, std::size_t ldc);
+
+    // Same followed by the epilogue, T, SA, SB as above
+    template<floatTypes T, operandOf<T> SA, operandOf<T> SB>
+    void gemm(Transpose transA, Transpose transB,
+              std::size_t M, std::size_t N, std::size_t K,
+              T alpha,
+              const SA* A, std::size_t lda,
+              const SB* B, std::size_t ldb,
+              T beta,
+              T* C, std::size_t ldc,
+              const Epilogue<T>& epilogue);
+
+    // The epilogue as a pass of its own over C (M x N), for products that don't come from gemm (e.g. sparse ones)
+    template<floatTypes T>
+    void applyEpilogue(std::size_t M, std::size_t N, T* C, std::size_t ldc, const Epilogue<T>& epilogue);
+
+    // C (M x N) = A (M x K) * B (K x N)
+    template<floatTypes T>
+    void gemm(std::size_t M, std::size_t N, std::size_t K,
+              const T* A, std::size_t lda,
+              const T* B, std::size_t ldb,
+              T* C, std::size_t ldc) {
+        gemm(Transpose::No, Transpose::No, M, N, K, T{1}, A, lda, B, ldb, T{0}, C, ldc);
+    }
+
+    // Quantized product for int8 inference: C (M x N, int32) = A (M x K, uint8) * B^T with B stored N x K (int8), i.e.
+    // every C element is the dot product of a row of A and a row of B. K, lda and ldb have to be multiples of 64 (pad
+    // with zeros). Exact, so the result is the same on every ISA level; VNNI where the CPU has it (see Dispatch.h)
+    void gemmU8S8(std::size_t M, std::size_t N, std::size_t K,
+                  const std::uint8_t* A, std::size_t lda,
+                  const std::int8_t* B, std::size_t ldb,
+                  std::int32_t* C, std::size_t ldc);
+
+    // Textbook i-j-k loop, only kept as reference for tests and benchmarks
+    template<floatTypes T>
+    void referenceGemm(Transpose transA, Transpose transB,
+                       std::size_t M, std::size_t N, std::size_t K,
+                       T alpha,
+                       const T* A, std::size_t lda,
+                       const T* B, std::size_t ldb,
+                       T beta,
+                       T* C, std::size_t ldc);
+
+    template<floatTypes T>
+    void referenceGemm(std::size_t M, std::size_t N, std::size_t K,
+                       const T* A, std::size_t lda,
+                       const T* B, std::size_t ldb,
+                       T* C, std::size_t ldc) {
+        referenceGemm(Transpose::No, Transpose::No, M, N, K, T{1}, A, lda, B, ldb, T{0}, C, ldc);
+    }
+
+    extern template void gemm<float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    extern template void gemm<double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+    extern template void gemm<float, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t);
+    extern template void gemm<float, bfloat16, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    extern template void gemm<float, float, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t);
+    extern template void gemm<double, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t);
+    extern template void gemm<double, bfloat16, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+    extern template void gemm<double, double, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t);
+    extern template void gemm<float, float, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    extern template void gemm<float, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    extern template void gemm<float, bfloat16, float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const bfloat16*, std::size_t, const float*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    extern template void gemm<float, float, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const bfloat16*, std::size_t, float, float*, std::size_t, const Epilogue<float>&);
+    extern template void applyEpilogue<float>(std::size_t, std::size_t, float*, std::size_t, const Epilogue<float>&);
+    extern template void gemm<double, double, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    extern template void gemm<double, bfloat16, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    extern template void gemm<double, bfloat16, double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const bfloat16*, std::size_t, const double*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    extern template void gemm<double, double, bfloat16>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const bfloat16*, std::size_t, double, double*, std::size_t, const Epilogue<double>&);
+    extern template void applyEpilogue<double>(std::size_t, std::size_t, double*, std::size_t, const Epilogue<double>&);
+    extern template void referenceGemm<float>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, float, const float*, std::size_t, const float*, std::size_t, float, float*, std::size_t);
+    extern template void referenceGemm<double>(Transpose, Transpose, std::size_t, std::size_t, std::size_t, double, const double*, std::size_t, const double*, std::size_t, double, double*, std::size_t);
+} // Math::Gemm
+
+#endif //NEUROINFORMATICS_GEMM_H
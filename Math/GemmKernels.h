@@ -0,0 +1,400 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+#ifndef NEUROINFORMATICS_GEMMKERNELS_H
+#define NEUROINFORMATICS_GEMMKERNELS_H
+
+#include <cstddef>
+
+#include "BFloat16.h"
+#include "Concepts.h"
+#include "Gemm.h"
+#include "Simd.h"
+#include "VectorMath.h"
+
+/*
+ * The ISA specific part of the gemm (see Gemm.h for the algorithm). Only included by the translation units in Math/Isa,
+ * each one compiled with the flags of its ISA and instantiating everything here for its own Simd tag. That's why all
+ * templates take the Isa (even where the code doesn't need it) and nothing in here calls into the standard library:
+ * an inline function instantiated in an AVX-512 unit and in a baseline one would be the same symbol and the linker
+ * could keep the AVX-512 copy for everybody.
+ */
+
+namespace Math::Gemm {
+    namespace Detail {
+        // Packing buffers are reused between calls (per thread and slot), so steady state gemm does not touch the
+        // allocator. Defined in Gemm.cpp, i.e. compiled for the baseline ISA.
+        template<floatTypes T>
+        T* packBuffer(std::size_t slot, std::size_t count);
+
+        extern template float* packBuffer<float>(std::size_t, std::size_t);
+        extern template double* packBuffer<double>(std::size_t, std::size_t);
+    } // Detail
+
+    /*
+     * Register tile (MR x NR) and cache blocks per element type and ISA.
+     * NR is a multiple of the vector width, MR * NR/width accumulators + the B row + one broadcast have to fit into
+     * the register file (16 ymm on AVX2, 32 zmm on AVX-512).
+     * KC * NR (one packed B micro panel) stays in L1, MC * KC (packed A) in L2 and KC * NC (packed B) in L3.
+     */
+    template<floatTypes T, class Isa>
+    struct Blocking;
+
+    template<> struct Blocking<float, Simd::Generic>  { static constexpr std::size_t MR = 4, NR = 8,  KC = 256, MC = 128, NC = 2048; };
+    template<> struct Blocking<double, Simd::Generic> { static constexpr std::size_t MR = 4, NR = 4,  KC = 256, MC = 64,  NC = 1024; };
+    template<> struct Blocking<float, Simd::AVX2>     { static constexpr std::size_t MR = 6, NR = 16, KC = 256, MC = 192, NC = 4096; };
+    template<> struct Blocking<double, Simd::AVX2>    { static constexpr std::size_t MR = 6, NR = 8,  KC = 256, MC = 96,  NC = 2048; };
+    template<> struct Blocking<float, Simd::AVX512>   { static constexpr std::size_t MR = 8, NR = 32, KC = 192, MC = 192, NC = 4096; };
+    template<> struct Blocking<double, Simd::AVX512>  { static constexpr std::size_t MR = 8, NR = 16, KC = 192, MC = 96,  NC = 2048; };
+
+    namespace Kernels {
+        constexpr std::size_t minSize(std::size_t a, std::size_t b) noexcept { return a < b ? a : b; }
+
+        // Operands are read through widen(), so a bfloat16 operand becomes T while it is packed and the micro kernel
+        // always runs (and accumulates) in T. Bit level instead of bfloat16's operator float, see the note at the top
+        template<floatTypes T, class Isa>
+        inline T widen(T value) noexcept { return value; }
+
+        template<floatTypes T, class Isa>
+        inline T widen(bfloat16 value) noexcept {
+            return static_cast<T>(__builtin_bit_cast(float, static_cast<unsigned int>(value.bits) << 16));
+        }
+
+        // Ap holds ceil(mc/MR) panels, each kc x MR (column of the panel is contiguous), rows past mc are zero.
+        // Element (i, p) of op(A) sits at A[i * rs + p * cs], so a transposed A only swaps the two strides.
+        template<floatTypes T, class Isa, class S = T>
+        void packA(std::size_t mc, std::size_t kc, const S* A, std::size_t rs, std::size_t cs, T* Ap) {
+            constexpr std::size_t MR = Blocking<T, Isa>::MR;
+            for (std::size_t i = 0; i < mc; i += MR) {
+                const std::size_t mr = minSize(MR, mc - i);
+                if (cs == 1) { // rows of A are contiguous
+                    for (std::size_t r = 0; r < mr; ++r) {
+                        const S* row = A + (i + r) * rs;
+                        for (std::size_t p = 0; p < kc; ++p)
+                            Ap[p * MR + r] = widen<T, Isa>(row[p]);
+                    }
+                } else { // A^T: the MR values of one k step are contiguous
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        const S* col = A + p * cs + i;
+                        for (std::size_t r = 0; r < mr; ++r)
+                            Ap[p * MR + r] = widen<T, Isa>(col[r]);
+                    }
+                }
+                for (std::size_t r = mr; r < MR; ++r)
+                    for (std::size_t p = 0; p < kc; ++p)
+                        Ap[p * MR + r] = T{0};
+                Ap += kc * MR;
+            }
+        }
+
+        // Bp holds ceil(nc/NR) panels, each kc x NR (row of the panel is contiguous), columns past nc are zero.
+        // Element (p, j) of op(B) sits at B[p * rs + j * cs].
+        template<floatTypes T, class Isa, class S = T>
+        void packB(std::size_t kc, std::size_t nc, const S* B, std::size_t rs, std::size_t cs, T* Bp) {
+            constexpr std::size_t NR = Blocking<T, Isa>::NR;
+            for (std::size_t j = 0; j < nc; j += NR) {
+                const std::size_t nr = minSize(NR, nc - j);
+                if (cs == 1) {
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        const S* row = B + p * rs + j;
+                        T* dst = Bp + p * NR;
+                        for (std::size_t c = 0; c < nr; ++c)
+                            dst[c] = widen<T, Isa>(row[c]);
+                        for (std::size_t c = nr; c < NR; ++c)
+                            dst[c] = T{0};
+                    }
+                } else { // B^T: walk the stored rows of B (contiguous in k), scatter into the panel
+                    for (std::size_t c = 0; c < nr; ++c) {
+                        const S* row = B + (j + c) * cs;
+                        for (std::size_t p = 0; p < kc; ++p)
+                            Bp[p * NR + c] = widen<T, Isa>(row[p]);
+                    }
+                    for (std::size_t p = 0; p < kc; ++p)
+                        for (std::size_t c = nr; c < NR; ++c)
+                            Bp[p * NR + c] = T{0};
+                }
+                Bp += kc * NR;
+            }
+        }
+
+        // C (MR x NR) = alpha * Ap * Bp + beta * C, the whole tile lives in registers for the k loop
+        template<floatTypes T, class Isa, std::size_t MR, std::size_t NR>
+        inline void microKernel(std::size_t kc, const T* __restrict Ap, const T* __restrict Bp,
+                                T* __restrict C, std::size_t ldc, T alpha, T beta) {
+            using V = Simd::Vec<T, Isa>;
+            constexpr std::size_t NV = NR / V::width;
+            typename V::type acc[MR][NV];
+
+#pragma GCC unroll 32
+            for (std::size_t r = 0; r < MR; ++r)
+#pragma GCC unroll 4
+                for (std::size_t v = 0; v < NV; ++v)
+                    acc[r][v] = V::zero();
+
+            for (std::size_t p = 0; p < kc; ++p) {
+                typename V::type b[NV];
+#pragma GCC unroll 4
+                for (std::size_t v = 0; v < NV; ++v)
+                    b[v] = V::loadu(Bp + p * NR + v * V::width);
+
+#pragma GCC unroll 32
+                for (std::size_t r = 0; r < MR; ++r) {
+                    const auto a = V::broadcast(Ap[p * MR + r]);
+#pragma GCC unroll 4
+                    for (std::size_t v = 0; v < NV; ++v)
+                        acc[r][v] = V::fmadd(a, b[v], acc[r][v]);
+                }
+            }
+
+            const auto alphaV = V::broadcast(alpha);
+            const auto betaV = V::broadcast(beta);
+#pragma GCC unroll 32
+            for (std::size_t r = 0; r < MR; ++r) {
+#pragma GCC unroll 4
+                for (std::size_t v = 0; v < NV; ++v) {
+                    T* c = C + r * ldc + v * V::width;
+                    if (beta == T{0}) // don't read C, it may be uninitialised
+                        V::storeu(c, V::mul(alphaV, acc[r][v]));
+                    else
+                        V::storeu(c, V::fmadd(betaV, V::loadu(c), V::mul(alphaV, acc[r][v])));
+                }
+            }
+        }
+
+        struct Identity {
+            template<floatTypes T, class Isa>
+            typename Simd::Vec<T, Isa>::type apply(typename Simd::Vec<T, Isa>::type x) const noexcept { return x; }
+        };
+
+        // Block of C (rows x cols): x = C + row bias + column bias, f(x) into out, x back into C if out is separate.
+        // rowBias, colBias and out already point at the first row / column of the block (nullptr: not there)
+        template<floatTypes T, class Isa, class F>
+        void epilogueBlock(std::size_t rows, std::size_t cols, T* C, std::size_t ldc, const T* rowBias, std::size_t rowBiasStride,
+                           const T* colBias, T* out, std::size_t ldo, const F& f) {
+            using V = Simd::Vec<T, Isa>;
+            constexpr std::size_t W = V::width;
+            const bool keepC = out != nullptr && (rowBias != nullptr || colBias != nullptr);
+
+            for (std::size_t r = 0; r < rows; ++r) {
+                T* c = C + r * ldc;
+                T* o = out != nullptr ? out + r * ldo : c;
+                const T rb = rowBias != nullptr ? rowBias[r * rowBiasStride] : T{0};
+                const auto rbV = V::broadcast(rb);
+
+                std::size_t j = 0;
+                for (; j + W <= cols; j += W) {
+                    auto x = V::add(V::loadu(c + j), rbV);
+                    if (colBias != nullptr)
+                        x = V::add(x, V::loadu(colBias + j));
+                    if (keepC)
+                        V::storeu(c + j, x);
+                    V::storeu(o + j, f.template apply<T, Isa>(x));
+                }
+
+                if (j < cols) { // the tail goes through a zeroed register
+                    alignas(64) T tail[W];
+                    for (std::size_t l = 0; l < W; ++l)
+                        tail[l] = j + l < cols ? c[j + l] + rb + (colBias != nullptr ? colBias[j + l] : T{0}) : T{0};
+                    if (keepC)
+                        for (std::size_t l = 0; j + l < cols; ++l)
+                            c[j + l] = tail[l];
+                    V::storeu(tail, f.template apply<T, Isa>(V::loadu(tail)));
+                    for (std::size_t l = 0; j + l < cols; ++l)
+                        o[j + l] = tail[l];
+                }
+            }
+        }
+
+        // Entry of the kernel table: the epilogue on the block of C at (row0, col0) of the whole product
+        template<floatTypes T, class Isa>
+        void epilogue(std::size_t rows, std::size_t cols, T* C, std::size_t ldc, const Epilogue<T>& e, std::size_t row0, std::size_t col0) {
+            const T* rowBias = e.rowBias != nullptr ? e.rowBias + row0 * e.rowBiasStride : nullptr;
+            const T* colBias = e.colBias != nullptr ? e.colBias + col0 : nullptr;
+            T* out = e.out != nullptr ? e.out + row0 * e.ldo + col0 : nullptr;
+            if (e.activation == Activation::Identity && rowBias == nullptr && colBias == nullptr && out == nullptr)
+                return;
+
+            const auto block = [&](const auto& f) {
+                epilogueBlock<T, Isa>(rows, cols, C, ldc, rowBias, e.rowBiasStride, colBias, out, e.ldo, f);
+            };
+            switch (e.activation) {
+                case Activation::Identity: block(Identity{}); break;
+                case Activation::ReLU: block(Simd::Relu{}); break;
+                case Activation::Sigmoid: block(Simd::Sigmoid{}); break;
+                case Activation::Tanh: block(Simd::Tanh{}); break;
+                case Activation::Softplus: block(Simd::Softplus{}); break;
+                case Activation::Elu: block(Simd::Elu(static_cast<double>(e.alpha))); break;
+                case Activation::Delu: block(Simd::Delu{}); break;
+                case Activation::Mish: block(Simd::Mish{}); break;
+                case Activation::Selu: block(Simd::Selu{}); break;
+                case Activation::LeakyReLU: block(Simd::LeakyRelu(static_cast<double>(e.alpha))); break;
+            }
+        }
+
+        // SA, SB: element types of A and B (T or bfloat16). A non-null epilogue runs on every register tile once its
+        // last k block is stored
+        template<floatTypes T, class Isa, class SA = T, class SB = T>
+        void blockedGemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                         const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                         const Epilogue<T>* ep = nullptr) {
+            using Blk = Blocking<T, Isa>;
+            constexpr std::size_t MR = Blk::MR, NR = Blk::NR;
+
+            // (row, col) strides of op(A) and op(B)
+            const std::size_t rsA = transA == Transpose::No ? lda : 1, csA = transA == Transpose::No ? 1 : lda;
+            const std::size_t rsB = transB == Transpose::No ? ldb : 1, csB = transB == Transpose::No ? 1 : ldb;
+
+            T* Ap = Detail::packBuffer<T>(0, Blk::MC * Blk::KC);
+            T* Bp = Detail::packBuffer<T>(1, Blk::KC * ((Blk::NC + NR - 1) / NR) * NR);
+
+            for (std::size_t jc = 0; jc < N; jc += Blk::NC) {
+                const std::size_t nc = minSize(Blk::NC, N - jc);
+
+                for (std::size_t pc = 0; pc < K; pc += Blk::KC) {
+                    const std::size_t kc = minSize(Blk::KC, K - pc);
+                    const T betaBlock = pc == 0 ? beta : T{1}; // later k blocks accumulate onto the first one
+                    const bool lastBlock = pc + kc == K;
+                    packB<T, Isa, SB>(kc, nc, B + pc * rsB + jc * csB, rsB, csB, Bp);
+
+                    for (std::size_t ic = 0; ic < M; ic += Blk::MC) {
+                        const std::size_t mc = minSize(Blk::MC, M - ic);
+                        packA<T, Isa, SA>(mc, kc, A + ic * rsA + pc * csA, rsA, csA, Ap);
+
+                        for (std::size_t jr = 0; jr < nc; jr += NR) {
+                            const std::size_t nr = minSize(NR, nc - jr);
+
+                            for (std::size_t ir = 0; ir < mc; ir += MR) {
+                                const std::size_t mr = minSize(MR, mc - ir);
+                                T* c = C + (ic + ir) * ldc + jc + jr;
+
+                                if (mr == MR && nr == NR) {
+                                    microKernel<T, Isa, MR, NR>(kc, Ap + ir * kc, Bp + jr * kc, c, ldc, alpha, betaBlock);
+                                } else { // Edge tile: compute the full tile on the stack, only write back what is inside C
+                                    alignas(64) T tile[MR * NR];
+                                    microKernel<T, Isa, MR, NR>(kc, Ap + ir * kc, Bp + jr * kc, tile, NR, alpha, T{0});
+                                    for (std::size_t r = 0; r < mr; ++r)
+                                        for (std::size_t cc = 0; cc < nr; ++cc)
+                                            c[r * ldc + cc] = betaBlock == T{0} ? tile[r * NR + cc] : betaBlock * c[r * ldc + cc] + tile[r * NR + cc];
+                                }
+
+                                if (ep != nullptr && lastBlock)
+                                    epilogue<T, Isa>(mr, nr, c, ldc, *ep, ic + ir, jc + jr);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // C row r = beta * C row r + alpha * sum_k A(r,k) * B row k, inner loop is contiguous and gets vectorized by the compiler
+        template<floatTypes T, class Isa>
+        void rowAxpyGemm(std::size_t M, std::size_t N, std::size_t K, T alpha,
+                         const T* A, std::size_t rsA, std::size_t csA, const T* B, std::size_t ldb, T beta, T* C, std::size_t ldc) {
+            for (std::size_t r = 0; r < M; ++r) {
+                T* __restrict c = C + r * ldc;
+                const T a0 = alpha * A[r * rsA];
+                const T* __restrict b0 = B;
+                if (beta == T{0}) {
+                    for (std::size_t j = 0; j < N; ++j)
+                        c[j] = a0 * b0[j];
+                } else {
+                    for (std::size_t j = 0; j < N; ++j)
+                        c[j] = beta * c[j] + a0 * b0[j];
+                }
+
+                for (std::size_t k = 1; k < K; ++k) {
+                    const T a = alpha * A[r * rsA + k * csA];
+                    const T* __restrict b = B + k * ldb;
+                    for (std::size_t j = 0; j < N; ++j)
+                        c[j] += a * b[j];
+                }
+            }
+        }
+
+        // C(r, j) = beta * C(r, j) + alpha * dot(row r of A, row j of Bt), both contiguous in k, i.e. op(B) = Bt^T.
+        // Four independent accumulators per dot product, the k tail is added scalar.
+        template<floatTypes T, class Isa>
+        void dotGemm(std::size_t M, std::size_t N, std::size_t K, T alpha,
+                     const T* A, std::size_t lda, const T* Bt, std::size_t ldbt, T beta, T* C, std::size_t ldc) {
+            using V = Simd::Vec<T, Isa>;
+            constexpr std::size_t W = V::width;
+
+            for (std::size_t r = 0; r < M; ++r) {
+                const T* a = A + r * lda;
+                for (std::size_t j = 0; j < N; ++j) {
+                    const T* b = Bt + j * ldbt;
+                    auto acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+
+                    std::size_t k = 0;
+                    for (; k + 4 * W <= K; k += 4 * W) {
+                        acc0 = V::fmadd(V::loadu(a + k), V::loadu(b + k), acc0);
+                        acc1 = V::fmadd(V::loadu(a + k + W), V::loadu(b + k + W), acc1);
+                        acc2 = V::fmadd(V::loadu(a + k + 2 * W), V::loadu(b + k + 2 * W), acc2);
+                        acc3 = V::fmadd(V::loadu(a + k + 3 * W), V::loadu(b + k + 3 * W), acc3);
+                    }
+                    for (; k + W <= K; k += W)
+                        acc0 = V::fmadd(V::loadu(a + k), V::loadu(b + k), acc0);
+
+                    alignas(64) T lanes[W];
+                    V::storeu(lanes, V::add(V::add(acc0, acc1), V::add(acc2, acc3)));
+                    T sum = T{0};
+                    for (std::size_t l = 0; l < W; ++l)
+                        sum += lanes[l];
+                    for (; k < K; ++k)
+                        sum += a[k] * b[k];
+
+                    T* c = C + r * ldc + j;
+                    *c = beta == T{0} ? alpha * sum : alpha * sum + beta * *c;
+                }
+            }
+        }
+
+        // Entry of the kernel table, M, N, K > 0 and alpha != 0 (Gemm::gemm handles the rest)
+        template<floatTypes T, class Isa>
+        void gemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                  const T* A, std::size_t lda, const T* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                  const Epilogue<T>* ep) {
+            // Fewer rows than one register tile (e.g. the 1 x n output layer): packing would only multiply zeros,
+            // streaming the rows of B into C is as fast as it gets for this memory bound case
+            if (M < Blocking<T, Isa>::MR && transB == Transpose::No) {
+                const std::size_t rsA = transA == Transpose::No ? lda : 1, csA = transA == Transpose::No ? 1 : lda;
+                rowAxpyGemm<T, Isa>(M, N, K, alpha, A, rsA, csA, B, ldb, beta, C, ldc);
+                if (ep != nullptr) // a few rows, the whole of C is still in L1
+                    epilogue<T, Isa>(M, N, C, ldc, *ep, 0, 0);
+                return;
+            }
+
+            // Batch-1 inference: x * W^T (sample-major) is a dot product per output, W * x (feature-major) too once the
+            // strided column x is copied into a contiguous one
+            if (transA == Transpose::No && M < Blocking<T, Isa>::MR && transB == Transpose::Yes) {
+                dotGemm<T, Isa>(M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+                if (ep != nullptr)
+                    epilogue<T, Isa>(M, N, C, ldc, *ep, 0, 0);
+                return;
+            }
+            if (transA == Transpose::No && N == 1) {
+                T* x = Detail::packBuffer<T>(1, K);
+                const std::size_t rs = transB == Transpose::No ? ldb : 1;
+                for (std::size_t k = 0; k < K; ++k)
+                    x[k] = B[k * rs];
+                dotGemm<T, Isa>(M, 1, K, alpha, A, lda, x, K, beta, C, ldc);
+                if (ep != nullptr)
+                    epilogue<T, Isa>(M, 1, C, ldc, *ep, 0, 0);
+                return;
+            }
+
+            blockedGemm<T, Isa>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, ep);
+        }
+
+        // Entry for bfloat16 operands (one or both), always blocked: the packing is where they get widened
+        template<floatTypes T, class Isa, class SA, class SB>
+        void mixedGemm(Transpose transA, Transpose transB, std::size_t M, std::size_t N, std::size_t K, T alpha,
+                       const SA* A, std::size_t lda, const SB* B, std::size_t ldb, T beta, T* C, std::size_t ldc,
+                       const Epilogue<T>* ep) {
+            blockedGemm<T, Isa, SA, SB>(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, ep);
+        }
+    } // Kernels
+} // Math::Gemm
+
+#endif //NEUROINFORMATICS_GEMMKERNELS_H
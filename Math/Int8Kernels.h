@@ -0,0 +1,123 @@
+//
+// Created by timwe on 11/24/2025.
+//
+
+#ifndef NEUROINFORMATICS_INT8KERNELS_H
+#define NEUROINFORMATICS_INT8KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Simd.h"
+
+/*
+ * The ISA specific part of Gemm::gemmU8S8 (see Gemm.h), same rules as GemmKernels.h: only included by Math/Isa, every
+ * template takes the Isa, no standard library calls.
+ * Both operands are K-contiguous (A row-major M x K, B row-major N x K, the weights as the layer stores them), so
+ * every C element is one dot product over K. K, lda and ldb are multiples of 64, that's one zmm of bytes.
+ */
+
+namespace Math::Gemm::Kernels {
+    // Portable: the compiler vectorises the inner loop with the flags of the unit (pmaddubsw / pmaddwd on AVX2).
+    // Four columns per pass so a row of A is read once for four rows of B
+    template<class Isa>
+    void gemmU8S8(std::size_t M, std::size_t N, std::size_t K, const std::uint8_t* A, std::size_t lda,
+                  const std::int8_t* B, std::size_t ldb, std::int32_t* C, std::size_t ldc) {
+        for (std::size_t i = 0; i < M; ++i) {
+            const std::uint8_t* a = A + i * lda;
+            std::size_t j = 0;
+            for (; j + 4 <= N; j += 4) {
+                const std::int8_t* b0 = B + j * ldb;
+                const std::int8_t* b1 = b0 + ldb;
+                const std::int8_t* b2 = b1 + ldb;
+                const std::int8_t* b3 = b2 + ldb;
+                std::int32_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+                for (std::size_t k = 0; k < K; ++k) {
+                    const std::int32_t x = a[k];
+                    c0 += x * b0[k];
+                    c1 += x * b1[k];
+                    c2 += x * b2[k];
+                    c3 += x * b3[k];
+                }
+                C[i * ldc + j] = c0;
+                C[i * ldc + j + 1] = c1;
+                C[i * ldc + j + 2] = c2;
+                C[i * ldc + j + 3] = c3;
+            }
+            for (; j < N; ++j) {
+                const std::int8_t* b = B + j * ldb;
+                std::int32_t c = 0;
+                for (std::size_t k = 0; k < K; ++k)
+                    c += static_cast<std::int32_t>(a[k]) * b[k];
+                C[i * ldc + j] = c;
+            }
+        }
+    }
+
+#if defined(__AVX512VNNI__)
+    namespace Detail {
+        // Sum of the 16 int32 lanes, by hand (the reduce intrinsic is a sequence of inline functions)
+        template<class Isa>
+        inline std::int32_t horizontalSum(__m512i v) noexcept {
+            const __m256i half = _mm256_add_epi32(_mm512_castsi512_si256(v), _mm512_extracti64x4_epi64(v, 1));
+            const __m128i quarter = _mm_add_epi32(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+            const __m128i pairs = _mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0x4e));
+            return _mm_cvtsi128_si32(_mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, 0xb1)));
+        }
+    } // Detail
+
+    // vpdpbusd: 64 u8 x s8 products summed into 16 int32 lanes per instruction. A 2 x 4 tile of C keeps 8
+    // accumulators, every A and B load is used 4 and 2 times
+    template<>
+    inline void gemmU8S8<Simd::AVX512VNNI>(std::size_t M, std::size_t N, std::size_t K, const std::uint8_t* A, std::size_t lda,
+                                           const std::int8_t* B, std::size_t ldb, std::int32_t* C, std::size_t ldc) {
+        using Isa = Simd::AVX512VNNI;
+        std::size_t i = 0;
+        for (; i + 2 <= M; i += 2) {
+            const std::uint8_t* a0 = A + i * lda;
+            const std::uint8_t* a1 = a0 + lda;
+            std::size_t j = 0;
+            for (; j + 4 <= N; j += 4) {
+                __m512i acc[2][4];
+                for (auto& row : acc)
+                    for (auto& v : row)
+                        v = _mm512_setzero_si512();
+
+                for (std::size_t k = 0; k < K; k += 64) {
+                    const __m512i x0 = _mm512_loadu_si512(a0 + k), x1 = _mm512_loadu_si512(a1 + k);
+                    for (std::size_t c = 0; c < 4; ++c) {
+                        const __m512i w = _mm512_loadu_si512(B + (j + c) * ldb + k);
+                        acc[0][c] = _mm512_dpbusd_epi32(acc[0][c], x0, w);
+                        acc[1][c] = _mm512_dpbusd_epi32(acc[1][c], x1, w);
+                    }
+                }
+                for (std::size_t c = 0; c < 4; ++c) {
+                    C[i * ldc + j + c] = Detail::horizontalSum<Isa>(acc[0][c]);
+                    C[(i + 1) * ldc + j + c] = Detail::horizontalSum<Isa>(acc[1][c]);
+                }
+            }
+            for (; j < N; ++j) {
+                __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+                for (std::size_t k = 0; k < K; k += 64) {
+                    const __m512i w = _mm512_loadu_si512(B + j * ldb + k);
+                    acc0 = _mm512_dpbusd_epi32(acc0, _mm512_loadu_si512(a0 + k), w);
+                    acc1 = _mm512_dpbusd_epi32(acc1, _mm512_loadu_si512(a1 + k), w);
+                }
+                C[i * ldc + j] = Detail::horizontalSum<Isa>(acc0);
+                C[(i + 1) * ldc + j] = Detail::horizontalSum<Isa>(acc1);
+            }
+        }
+        for (; i < M; ++i) {
+            const std::uint8_t* a = A + i * lda;
+            for (std::size_t j = 0; j < N; ++j) {
+                __m512i acc = _mm512_setzero_si512();
+                for (std::size_t k = 0; k < K; k += 64)
+                    acc = _mm512_dpbusd_epi32(acc, _mm512_loadu_si512(a + k), _mm512_loadu_si512(B + j * ldb + k));
+                C[i * ldc + j] = Detail::horizontalSum<Isa>(acc);
+            }
+        }
+    }
+#endif
+} // Math::Gemm::Kernels
+
+#endif //NEUROINFORMATICS_INT8KERNELS_H
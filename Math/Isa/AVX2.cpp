@@ -0,0 +1,16 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+// Kernel table for the AVX2 level
+#if !defined(__AVX2__) || !defined(__FMA__)
+#error "Math/Isa/AVX2.cpp has to be compiled with -mavx2 -mfma (see CMakeLists.txt)"
+#endif
+
+#include "../IsaKernels.h"
+
+namespace Math::Dispatch {
+    template const KernelTable<float>& kernelTable<float, Simd::AVX2>() noexcept;
+    template const KernelTable<double>& kernelTable<double, Simd::AVX2>() noexcept;
+    template const Int8KernelTable& int8KernelTable<Simd::AVX2>() noexcept;
+} // Math::Dispatch
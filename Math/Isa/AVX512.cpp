@@ -0,0 +1,16 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+// Kernel table for the AVX512 level
+#if !defined(__AVX512F__) || !defined(__FMA__)
+#error "Math/Isa/AVX512.cpp has to be compiled with -mavx512f -mfma (see CMakeLists.txt)"
+#endif
+
+#include "../IsaKernels.h"
+
+namespace Math::Dispatch {
+    template const KernelTable<float>& kernelTable<float, Simd::AVX512>() noexcept;
+    template const KernelTable<double>& kernelTable<double, Simd::AVX512>() noexcept;
+    template const Int8KernelTable& int8KernelTable<Simd::AVX512>() noexcept;
+} // Math::Dispatch
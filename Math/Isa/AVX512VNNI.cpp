@@ -0,0 +1,14 @@
+//
+// Created by timwe on 11/24/2025.
+//
+
+// Int8 kernel table for AVX512 + VNNI, the float kernels of this level are the ones in AVX512.cpp
+#if !defined(__AVX512F__) || !defined(__AVX512BW__) || !defined(__AVX512VNNI__)
+#error "Math/Isa/AVX512VNNI.cpp has to be compiled with -mavx512f -mavx512bw -mavx512vnni (see CMakeLists.txt)"
+#endif
+
+#include "../IsaKernels.h"
+
+namespace Math::Dispatch {
+    template const Int8KernelTable& int8KernelTable<Simd::AVX512VNNI>() noexcept;
+} // Math::Dispatch
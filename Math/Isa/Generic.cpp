@@ -0,0 +1,12 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+// Kernel table for the Generic level, baseline flags (also the only one on non x86 builds)
+#include "../IsaKernels.h"
+
+namespace Math::Dispatch {
+    template const KernelTable<float>& kernelTable<float, Simd::Generic>() noexcept;
+    template const KernelTable<double>& kernelTable<double, Simd::Generic>() noexcept;
+    template const Int8KernelTable& int8KernelTable<Simd::Generic>() noexcept;
+} // Math::Dispatch
@@ -0,0 +1,241 @@
+//
+// Created by timwe on 11/18/2025.
+//
+
+#ifndef NEUROINFORMATICS_ISAKERNELS_H
+#define NEUROINFORMATICS_ISAKERNELS_H
+
+#include <cstddef>
+
+#include "Concepts.h"
+#include "Dispatch.h"
+#include "GemmKernels.h"
+#include "Int8Kernels.h"
+#include "Simd.h"
+#include "TransposeKernels.h"
+#include "VectorMath.h"
+
+/*
+ * Builds the kernel table of one ISA level. Only included by Math/Isa/<level>.cpp, the same rules as in GemmKernels.h apply
+ * (everything templated on the Isa tag, no standard library calls).
+ */
+
+namespace Math::Dispatch {
+    namespace Kernels {
+        template<floatTypes T, class Op, class Isa>
+        void map(const T* in, T* out, std::size_t n) {
+            Simd::transform<T, Op, Isa>(in, out, n, Op{});
+        }
+
+        template<floatTypes T, class Isa>
+        void logMap(const T* in, T* out, std::size_t n, T invLnBase) {
+            using V = Simd::Vec<T, Isa>;
+            const auto scale = V::broadcast(invLnBase);
+
+            std::size_t i = 0;
+            for (; i + V::width <= n; i += V::width)
+                V::storeu(out + i, V::mul(Simd::VecMath<T, Isa>::log(V::loadu(in + i)), scale));
+
+            if (i < n) {
+                alignas(64) T tail[V::width];
+                for (std::size_t j = 0; j < V::width; ++j)
+                    tail[j] = i + j < n ? in[i + j] : T{1};
+                V::storeu(tail, V::mul(Simd::VecMath<T, Isa>::log(V::loadu(tail)), scale));
+                for (std::size_t j = 0; i + j < n; ++j)
+                    out[i + j] = tail[j];
+            }
+        }
+
+        template<floatTypes T, class Isa>
+        void eluMap(const T* in, T* out, std::size_t n, T alpha) {
+            Simd::transform<T, Simd::Elu, Isa>(in, out, n, Simd::Elu(static_cast<double>(alpha)));
+        }
+
+        template<floatTypes T, class Isa>
+        void leakyReluMap(const T* in, T* out, std::size_t n, T slope) {
+            Simd::transform<T, Simd::LeakyRelu, Isa>(in, out, n, Simd::LeakyRelu(static_cast<double>(slope)));
+        }
+
+        // Four independent accumulators hide the add latency; the tail of a row is added scalar
+        template<floatTypes T, class Isa>
+        T rowSum(const T* row, std::size_t cols) {
+            using V = Simd::Vec<T, Isa>;
+            auto acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+
+            std::size_t c = 0;
+            for (; c + 4 * V::width <= cols; c += 4 * V::width) {
+                acc0 = V::add(acc0, V::loadu(row + c));
+                acc1 = V::add(acc1, V::loadu(row + c + V::width));
+                acc2 = V::add(acc2, V::loadu(row + c + 2 * V::width));
+                acc3 = V::add(acc3, V::loadu(row + c + 3 * V::width));
+            }
+            for (; c + V::width <= cols; c += V::width)
+                acc0 = V::add(acc0, V::loadu(row + c));
+
+            alignas(64) T lanes[V::width];
+            V::storeu(lanes, V::add(V::add(acc0, acc1), V::add(acc2, acc3)));
+            T result = T{0};
+            for (std::size_t l = 0; l < V::width; ++l)
+                result += lanes[l];
+            for (; c < cols; ++c)
+                result += row[c];
+            return result;
+        }
+
+        template<floatTypes T, class Isa>
+        void rowSums(const T* A, std::size_t rows, std::size_t cols, std::size_t stride, T* out, std::size_t outStride) {
+            for (std::size_t r = 0; r < rows; ++r)
+                out[r * outStride] = rowSum<T, Isa>(A + r * stride, cols);
+        }
+
+        template<floatTypes T, class Isa>
+        T sum(const T* A, std::size_t rows, std::size_t cols, std::size_t stride) {
+            T result = T{0};
+            for (std::size_t r = 0; r < rows; ++r)
+                result += rowSum<T, Isa>(A + r * stride, cols);
+            return result;
+        }
+
+        // One chunk of a row (cols > 0): mean and sum of squared deviations, min, max. Sum / min / max in one sweep,
+        // then the deviations from the chunk mean while the chunk is still in L1, so memory is read once but the
+        // variance has two-pass accuracy
+        template<floatTypes T, class Isa>
+        void chunkMoments(const T* p, std::size_t n, T& mean, T& m2, T& min, T& max) {
+            using V = Simd::Vec<T, Isa>;
+            alignas(64) T lanes[V::width];
+
+            std::size_t c = 0;
+            T lo = p[0], hi = p[0];
+            if (n >= V::width) {
+                auto acc0 = V::zero(), acc1 = V::zero(), vmin = V::loadu(p), vmax = vmin;
+                for (; c + 2 * V::width <= n; c += 2 * V::width) {
+                    const auto x0 = V::loadu(p + c), x1 = V::loadu(p + c + V::width);
+                    acc0 = V::add(acc0, x0);
+                    acc1 = V::add(acc1, x1);
+                    vmin = V::min(vmin, V::min(x0, x1));
+                    vmax = V::max(vmax, V::max(x0, x1));
+                }
+                for (; c + V::width <= n; c += V::width) {
+                    const auto x = V::loadu(p + c);
+                    acc0 = V::add(acc0, x);
+                    vmin = V::min(vmin, x);
+                    vmax = V::max(vmax, x);
+                }
+                V::storeu(lanes, V::add(acc0, acc1));
+                mean = T{0};
+                for (std::size_t l = 0; l < V::width; ++l)
+                    mean += lanes[l];
+                V::storeu(lanes, vmin);
+                for (std::size_t l = 0; l < V::width; ++l)
+                    lo = lanes[l] < lo ? lanes[l] : lo;
+                V::storeu(lanes, vmax);
+                for (std::size_t l = 0; l < V::width; ++l)
+                    hi = lanes[l] > hi ? lanes[l] : hi;
+            } else {
+                mean = T{0};
+            }
+            for (; c < n; ++c) {
+                mean += p[c];
+                lo = p[c] < lo ? p[c] : lo;
+                hi = p[c] > hi ? p[c] : hi;
+            }
+            mean /= static_cast<T>(n);
+
+            const auto vmean = V::broadcast(mean);
+            auto acc = V::zero();
+            c = 0;
+            for (; c + V::width <= n; c += V::width) {
+                const auto d = V::sub(V::loadu(p + c), vmean);
+                acc = V::fmadd(d, d, acc);
+            }
+            V::storeu(lanes, acc);
+            m2 = T{0};
+            for (std::size_t l = 0; l < V::width; ++l)
+                m2 += lanes[l];
+            for (; c < n; ++c)
+                m2 += (p[c] - mean) * (p[c] - mean);
+            min = lo;
+            max = hi;
+        }
+
+        // moments = {mean, sum of squared deviations, min, max} of a row (cols > 0), chunks merged with Chan's formula
+        template<floatTypes T, class Isa>
+        void rowMoments(const T* row, std::size_t cols, T* moments) {
+            constexpr std::size_t chunk = 1024; // 4 KiB of floats, a multiple of every vector width
+            T count = T{0}, mean = T{0}, m2 = T{0}, min = row[0], max = row[0];
+            for (std::size_t start = 0; start < cols; start += chunk) {
+                const std::size_t n = cols - start < chunk ? cols - start : chunk;
+                T chunkMean, chunkM2, chunkMin, chunkMax;
+                chunkMoments<T, Isa>(row + start, n, chunkMean, chunkM2, chunkMin, chunkMax);
+
+                const T total = count + static_cast<T>(n), delta = chunkMean - mean;
+                mean += delta * static_cast<T>(n) / total;
+                m2 += chunkM2 + delta * delta * count * static_cast<T>(n) / total;
+                count = total;
+                min = chunkMin < min ? chunkMin : min;
+                max = chunkMax > max ? chunkMax : max;
+            }
+            moments[0] = mean;
+            moments[1] = m2;
+            moments[2] = min;
+            moments[3] = max;
+        }
+    } // Kernels
+
+    template<floatTypes T, class Isa>
+    const KernelTable<T>& kernelTable() noexcept {
+        static constexpr KernelTable<T> table{
+            &Gemm::Kernels::gemm<T, Isa>,
+            Gemm::Blocking<T, Isa>::MR,
+            Gemm::Blocking<T, Isa>::NR,
+            &Gemm::Kernels::mixedGemm<T, Isa, bfloat16, bfloat16>,
+            &Gemm::Kernels::mixedGemm<T, Isa, bfloat16, T>,
+            &Gemm::Kernels::mixedGemm<T, Isa, T, bfloat16>,
+            &Gemm::Kernels::epilogue<T, Isa>,
+            &Kernels::map<T, Simd::Exp, Isa>,
+            &Kernels::map<T, Simd::Expm1, Isa>,
+            &Kernels::map<T, Simd::Log1p, Isa>,
+            &Kernels::map<T, Simd::Tanh, Isa>,
+            &Kernels::map<T, Simd::Sigmoid, Isa>,
+            &Kernels::map<T, Simd::Softplus, Isa>,
+            &Kernels::map<T, Simd::Mish, Isa>,
+            &Kernels::map<T, Simd::Relu, Isa>,
+            &Kernels::map<T, Simd::Delu, Isa>,
+            &Kernels::map<T, Simd::Selu, Isa>,
+            &Kernels::logMap<T, Isa>,
+            &Kernels::eluMap<T, Isa>,
+            &Kernels::leakyReluMap<T, Isa>,
+            &Kernels::rowSums<T, Isa>,
+            &Kernels::sum<T, Isa>,
+            &Kernels::rowMoments<T, Isa>,
+            &Kernels::transpose<T, Isa>,
+            &Kernels::transposeSwap<T, Isa>,
+        };
+        return table;
+    }
+
+    template<class Isa>
+    const Int8KernelTable& int8KernelTable() noexcept {
+        static constexpr Int8KernelTable table{
+            &Gemm::Kernels::gemmU8S8<Isa>,
+        };
+        return table;
+    }
+
+    extern template const KernelTable<float>& kernelTable<float, Simd::Generic>() noexcept;
+    extern template const KernelTable<double>& kernelTable<double, Simd::Generic>() noexcept;
+#if defined(__x86_64__) || defined(_M_X64)
+    extern template const KernelTable<float>& kernelTable<float, Simd::AVX2>() noexcept;
+    extern template const KernelTable<double>& kernelTable<double, Simd::AVX2>() noexcept;
+    extern template const KernelTable<float>& kernelTable<float, Simd::AVX512>() noexcept;
+    extern template const KernelTable<double>& kernelTable<double, Simd::AVX512>() noexcept;
+#endif
+    extern template const Int8KernelTable& int8KernelTable<Simd::Generic>() noexcept;
+#if defined(__x86_64__) || defined(_M_X64)
+    extern template const Int8KernelTable& int8KernelTable<Simd::AVX2>() noexcept;
+    extern template const Int8KernelTable& int8KernelTable<Simd::AVX512>() noexcept;
+    extern template const Int8KernelTable& int8KernelTable<Simd::AVX512VNNI>() noexcept;
+#endif
+} // Math::Dispatch
+
+#endif //NEUROINFORMATICS_ISAKERNELS_H
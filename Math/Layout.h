@@ -0,0 +1,46 @@
+//
+// Created by timwe on 11/21/2025.
+//
+
+#ifndef NEUROINFORMATICS_LAYOUT_H
+#define NEUROINFORMATICS_LAYOUT_H
+
+#include <cstddef>
+
+#include "Concepts.h"
+#include "MatrixView.h"
+
+/*
+ * How a dataset / activation matrix is laid out, both row-major:
+ *
+ *      FeatureMajor    features x samples, one sample is a (strided) column. Wide rows, good for big batches
+ *      SampleMajor     samples x features, one sample is a contiguous row. Good for batch-1 inference, shuffling
+ *                      and gathering samples
+ *
+ * Weights are (out x in) either way, so a trained network can switch layouts. Matrix::transposeSelf() converts
+ * between the two.
+ */
+
+namespace Math {
+    enum class Layout {
+        FeatureMajor, SampleMajor
+    };
+
+    template<class M>
+    [[nodiscard]] std::size_t sampleCount(const M& X, Layout layout) noexcept {
+        return layout == Layout::FeatureMajor ? X.cols() : X.rows();
+    }
+
+    template<class M>
+    [[nodiscard]] std::size_t featureCount(const M& X, Layout layout) noexcept {
+        return layout == Layout::FeatureMajor ? X.rows() : X.cols();
+    }
+
+    // Samples [first, first + count) of X, no copy
+    template<floatTypes T>
+    [[nodiscard]] MatrixView<T> sampleRange(MatrixView<T> X, Layout layout, std::size_t first, std::size_t count) {
+        return layout == Layout::FeatureMajor ? X.colRange(first, count) : X.rowRange(first, count);
+    }
+} // Math
+
+#endif //NEUROINFORMATICS_LAYOUT_H
@@ -4,374 +4,735 @@
 
 #include "Matrix.h"
 #include "Functions.h"
+#include "Gemm.h"
+#include "Dispatch.h"
+#include "ThreadPool.h"
 #include <algorithm>
 //#include <arm_neon.h>
 #include <iostream>
+#include <span>
+#include <utility>
 
 namespace Math {
+    namespace {
+        // Cache oblivious transposes: the longer side is halved until a block fits in L1 on both sides, whatever the
+        // cache sizes are. Splits are multiples of 8 so the leaves keep whole SIMD tiles (TransposeKernels.h); bfloat16
+        // has no kernels and copies element by element
+        constexpr std::size_t transposeLeaf = 32;
+
+        std::size_t transposeSplit(std::size_t n) noexcept {
+            return (n / 2 + 7) / 8 * 8; // n > transposeLeaf, so 0 < split < n
+        }
 
-    template<floatTypes T>
+        // dst (cols x rows, stride dstStride) = src^T
+        template<storageTypes T>
+        void transposeRecursive(const T* src, std::size_t rows, std::size_t cols, std::size_t srcStride, T* dst, std::size_t dstStride) {
+            if (rows <= transposeLeaf && cols <= transposeLeaf) {
+                if constexpr (floatTypes<T>) {
+                    Dispatch::kernels<T>().transpose(src, rows, cols, srcStride, dst, dstStride);
+                } else {
+                    for (std::size_t r = 0; r < rows; ++r)
+                        for (std::size_t c = 0; c < cols; ++c)
+                            dst[c * dstStride + r] = src[r * srcStride + c];
+                }
+            } else if (rows >= cols) {
+                const std::size_t h = transposeSplit(rows);
+                transposeRecursive(src, h, cols, srcStride, dst, dstStride);
+                transposeRecursive(src + h * srcStride, rows - h, cols, srcStride, dst + h, dstStride);
+            } else {
+                const std::size_t h = transposeSplit(cols);
+                transposeRecursive(src, rows, h, srcStride, dst, dstStride);
+                transposeRecursive(src + h, rows, cols - h, srcStride, dst + h * dstStride, dstStride);
+            }
+        }
+
+        // Exchanges a (rows x cols) with b (cols x rows) transposed, a == b transposes a square block in place
+        template<storageTypes T>
+        void transposeSwapRecursive(T* a, T* b, std::size_t rows, std::size_t cols, std::size_t stride) {
+            if (rows <= transposeLeaf && cols <= transposeLeaf) {
+                if constexpr (floatTypes<T>) {
+                    Dispatch::kernels<T>().transposeSwap(a, b, rows, cols, stride);
+                } else {
+                    for (std::size_t r = 0; r < rows; ++r)
+                        for (std::size_t c = a == b ? r + 1 : 0; c < cols; ++c)
+                            std::swap(a[r * stride + c], b[c * stride + r]);
+                }
+            } else if (a == b) { // the diagonal blocks in place, the two off-diagonal ones with each other
+                const std::size_t h = transposeSplit(rows);
+                transposeSwapRecursive(a, a, h, h, stride);
+                transposeSwapRecursive(a + h * stride + h, a + h * stride + h, rows - h, rows - h, stride);
+                transposeSwapRecursive(a + h, a + h * stride, h, rows - h, stride);
+            } else if (rows >= cols) {
+                const std::size_t h = transposeSplit(rows);
+                transposeSwapRecursive(a, b, h, cols, stride);
+                transposeSwapRecursive(a + h * stride, b + h, rows - h, cols, stride);
+            } else {
+                const std::size_t h = transposeSplit(cols);
+                transposeSwapRecursive(a, b, rows, h, stride);
+                transposeSwapRecursive(a + h, b + h * stride, rows, cols - h, stride);
+            }
+        }
+
+        // Large inputs are cut into panels along the longer side, one pool task each (panels of at least the grain
+        // size, whole leaves); the panels write disjoint parts of dst
+        template<storageTypes T>
+        void transposePanels(const T* src, std::size_t rows, std::size_t cols, std::size_t srcStride, T* dst, std::size_t dstStride) {
+            const std::size_t longer = std::max(rows, cols), shorter = std::min(rows, cols);
+            const std::size_t panel = (Parallel::grainSize() / shorter + transposeLeaf - 1) / transposeLeaf * transposeLeaf;
+            Parallel::forChunks(longer, std::max(panel, transposeLeaf), [&](std::size_t begin, std::size_t end) {
+                if (rows >= cols)
+                    transposeRecursive(src + begin * srcStride, end - begin, cols, srcStride, dst + begin, dstStride);
+                else
+                    transposeRecursive(src + begin, rows, end - begin, srcStride, dst + begin * dstStride, dstStride);
+            });
+        }
+
+        // In place for n x n: one task per strip of transposeLeaf rows, its diagonal block and the swap of the rest
+        // of the strip with the matching column strip. The pool hands out strips in order, the longest ones first
+        template<storageTypes T>
+        void transposeSquareInplace(T* data, std::size_t n, std::size_t stride) {
+            const auto strip = [&](std::size_t i) {
+                const std::size_t begin = i * transposeLeaf, size = std::min(transposeLeaf, n - begin), end = begin + size;
+                T* diagonal = data + begin * stride + begin;
+                transposeSwapRecursive(diagonal, diagonal, size, size, stride);
+                if (end < n)
+                    transposeSwapRecursive(data + begin * stride + end, data + end * stride + begin, size, n - end, stride);
+            };
+
+            if (n * n < Parallel::grainSize()) {
+                transposeSwapRecursive(data, data, n, n, stride);
+                return;
+            }
+            Parallel::parallelFor((n + transposeLeaf - 1) / transposeLeaf, strip);
+        }
+
+        // Sum of the valid elements, one row-sum kernel call per block; the partials are added in block order so the
+        // result is the same on any thread count
+        template<floatTypes T>
+        T blockedSum(const T* data, std::size_t rows, std::size_t cols, std::size_t stride) {
+            const auto& kernels = Dispatch::kernels<T>();
+            const Kernels::BlockGrid grid(rows, cols);
+            if (grid.count() <= 1)
+                return kernels.sum(data, rows, cols, stride);
+
+            const std::span<T> partials = Kernels::blockPartials<T>(grid);
+            Kernels::forBlocks(grid, [&](const Kernels::Block& b, std::size_t i) {
+                partials[i] = kernels.sum(data + b.r0 * stride + b.c0, b.r1 - b.r0, b.c1 - b.c0, stride);
+            });
+
+            T result = T{0};
+            for (const T partial : partials)
+                result += partial;
+            return result;
+        }
+
+        bool overlaps(const void* p, const void* begin, const void* end) noexcept {
+            return std::less_equal<>{}(begin, p) && std::less<>{}(p, end);
+        }
+
+        // All the matMulInto overloads, SA / SB are T or bfloat16
+        template<floatTypes T, class SA, class SB>
+        void matMulIntoAny(Matrix<T>& result, MatrixView<const SA> A, MatrixView<const SB> B,
+                           Gemm::Transpose transA, Gemm::Transpose transB, T alpha, T beta,
+                           const Gemm::Epilogue<T>* epilogue = nullptr) {
+            // op(A) (m x k) op(B) (k x n) result (m x n), transposes are only a different read order inside the gemm
+            const std::size_t m = transA == Gemm::Transpose::No ? A.rows() : A.cols();
+            const std::size_t k = transA == Gemm::Transpose::No ? A.cols() : A.rows();
+            const std::size_t kB = transB == Gemm::Transpose::No ? B.rows() : B.cols();
+            const std::size_t n = transB == Gemm::Transpose::No ? B.cols() : B.rows();
+
+            if (k != kB)
+                throw std::invalid_argument("In Matrix::matMulInto() incompatible matrix sizes");
+
+            const void* resultBegin = result.data().data();
+            const void* resultEnd = result.data().data() + result.bufferSize();
+            if (overlaps(A.data(), resultBegin, resultEnd) || overlaps(B.data(), resultBegin, resultEnd))
+                throw std::invalid_argument("In Matrix::matMulInto() result can't alias one of the operands");
+
+            if (result.rows() != m || result.cols() != n) {
+                if (beta != T{0})
+                    throw std::invalid_argument("In Matrix::matMulInto() result has the wrong shape to be scaled by beta");
+                result = Matrix<T>(m, n, uninitialized, 0, result.resource());
+            }
+
+            if (epilogue != nullptr)
+                Gemm::gemm(transA, transB, m, n, k, alpha,
+                           A.data(), A.stride(),
+                           B.data(), B.stride(),
+                           beta, result.data().data(), result.stride(), *epilogue);
+            else
+                Gemm::gemm(transA, transB, m, n, k, alpha,
+                           A.data(), A.stride(),
+                           B.data(), B.stride(),
+                           beta, result.data().data(), result.stride());
+        }
+
+        // Epilogue adding bias to an m x n result and writing f into activated (sized here), see affineInto.
+        // activated == Z (or nullptr) applies f in place
+        template<floatTypes T>
+        // activated is nullptr to apply f over Z
+        Gemm::Epilogue<T> epilogueFor(std::size_t m, std::size_t n, MatrixView<const T> bias, Gemm::Activation f, T alpha,
+                                      Matrix<T>* activated) {
+            Gemm::Epilogue<T> epilogue;
+            epilogue.activation = f;
+            epilogue.alpha = alpha;
+
+            if (bias.rows() != 0 && bias.cols() != 0) {
+                if (bias.rows() == m && bias.cols() == 1) {
+                    epilogue.rowBias = bias.data();
+                    epilogue.rowBiasStride = bias.stride();
+                } else if (bias.rows() == 1 && bias.cols() == n) {
+                    epilogue.colBias = bias.data();
+                } else {
+                    throw std::invalid_argument("In Math::affineInto() the bias has to be (rows x 1) or (1 x cols) of the result");
+                }
+            }
+
+            if (activated != nullptr) {
+                if (activated->rows() != m || activated->cols() != n)
+                    *activated = Matrix<T>(m, n, uninitialized, 0, activated->resource());
+                epilogue.out = activated->data().data();
+                epilogue.ldo = activated->stride();
+            }
+            return epilogue;
+        }
+
+        template<floatTypes T, class SA, class SB>
+        void affineIntoAny(Matrix<T>& Z, MatrixView<const SA> A, MatrixView<const SB> B, Gemm::Transpose transA, Gemm::Transpose transB,
+                           MatrixView<const T> bias, Gemm::Activation f, Matrix<T>* activated, T alpha) {
+            const std::size_t m = transA == Gemm::Transpose::No ? A.rows() : A.cols();
+            const std::size_t n = transB == Gemm::Transpose::No ? B.cols() : B.rows();
+            if (activated != nullptr && activated != &Z) {
+                const void* begin = activated->data().data();
+                const void* end = activated->data().data() + activated->bufferSize();
+                if (overlaps(A.data(), begin, end) || overlaps(B.data(), begin, end))
+                    throw std::invalid_argument("In Math::affineInto() activated can't alias one of the operands");
+            }
+
+            const Gemm::Epilogue<T> epilogue = epilogueFor(m, n, bias, f, alpha, activated == &Z ? nullptr : activated);
+            matMulIntoAny<T>(Z, A, B, transA, transB, T{1}, T{0}, &epilogue);
+        }
+    }
+
+    template<storageTypes T>
     Matrix<T>::Matrix() noexcept : rows_(0), cols_(0), stride_(0) {
         stride_ = 0;  // round up
 
         this->data_.resize(rows_ * stride_);
     }
 
-    template<floatTypes T>
-    Matrix<T>::Matrix(std::size_t rows, std::size_t cols, std::size_t stride): rows_(rows), cols_(cols), stride_(stride) {
+    template<storageTypes T>
+    void Matrix<T>::initShape(std::size_t stride) {
         if (rows_ == 0 || cols_ == 0)
             throw std::invalid_argument("Invalid rows and columns provided, one of them is 0");
 
+        stride_ = stride;
         if (stride_ == 0) {
             // pad to 8 for float, 4 for double (AVX2); adjust as you like
-            const std::size_t w = std::is_same_v<T,float> ? 8 : 4;
-            stride_ = ((cols + w - 1) / w) * w;  // round up
+            const std::size_t w = 32 / sizeof(T); // 16 for bfloat16
+            stride_ = ((cols_ + w - 1) / w) * w;  // round up
         } else if (stride_ < cols_) {
             throw std::invalid_argument("stride must be bigger or equal to columns");
         }
-
-        this->data_.resize(rows_ * stride_);
     }
 
-    template<floatTypes T>
-    T& Matrix<T>::operator()(std::size_t r, std::size_t c) {
-        if (r >= rows_ || c >= cols_)
-            throw std::out_of_range("In Matrix::operator() r or c are out of bounds");
-
-        return this->data_[r * stride_ + c];
+    template<storageTypes T>
+    Matrix<T>::Matrix(std::size_t rows, std::size_t cols, std::size_t stride, std::pmr::memory_resource* resource)
+        : data_(Memory::AlignedAllocator<T>(resource)), rows_(rows), cols_(cols), stride_(0) {
+        this->initShape(stride);
+        this->data_.resize(rows_ * stride_, T{});
     }
 
-    template<floatTypes T>
-    const T& Matrix<T>::operator()(std::size_t r, std::size_t c) const {
-        if (r >= rows_ || c >= cols_)
-            throw std::out_of_range("In Matrix::operator() r or c are out of bounds");
+    template<storageTypes T>
+    Matrix<T>::Matrix(std::size_t rows, std::size_t cols, Uninitialized, std::size_t stride, std::pmr::memory_resource* resource)
+        : data_(Memory::AlignedAllocator<T>(resource)), rows_(rows), cols_(cols), stride_(0) {
+        this->initShape(stride);
+        this->data_.resize(rows_ * stride_); // default-initialised, no memset
+        Kernels::zeroPadding(this->data_.data(), rows_, cols_, stride_);
+    }
 
-        return this->data_[r * stride_ + c];
+    template<storageTypes T>
+    Matrix<T>::Matrix(MatrixView<const T> view, std::pmr::memory_resource* resource)
+        : Matrix(view.rows(), view.cols(), uninitialized, 0, resource) {
+        for (std::size_t r = 0; r < this->rows_; ++r)
+            std::copy_n(view.data() + r * view.stride(), this->cols_, this->data_.data() + r * this->stride_);
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::span<T> Matrix<T>::data() noexcept {
         return this->data_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::span<const T> Matrix<T>::data() const noexcept {
         return this->data_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::size_t Matrix<T>::rows() const noexcept {
         return this->rows_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::size_t Matrix<T>::cols() const noexcept {
         return this->cols_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::size_t Matrix<T>::stride() const noexcept {
         return stride_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::size_t Matrix<T>::bufferSize() const noexcept {
         return rows_ * stride_;
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     std::size_t Matrix<T>::elementCount() const noexcept {
         return rows_ * cols_;
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::transpose() const {
-        Matrix<T> result(cols_, rows_, 0); // Swap rows and col sizes / make sure stride gets recalculated
+    template<storageTypes T>
+    std::pmr::memory_resource* Matrix<T>::resource() const noexcept {
+        return this->data_.get_allocator().resource();
+    }
 
-        for (std::size_t c = 0; c < this->cols_; ++c) {
-            for (std::size_t r = 0; r < this->rows_; ++r) {
-                result(c,r) = (*this)(r,c);
-            }
-        }
+    template<storageTypes T>
+    MatrixView<T> Matrix<T>::view() noexcept {
+        return MatrixView<T>(*this);
+    }
 
+    template<storageTypes T>
+    MatrixView<const T> Matrix<T>::view() const noexcept {
+        return MatrixView<const T>(*this);
+    }
+
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::transpose() const {
+        Matrix<T> result(cols_, rows_, uninitialized); // Swap rows and col sizes / make sure stride gets recalculated
+        transposePanels(this->data_.data(), rows_, cols_, stride_, result.data_.data(), result.stride_);
         return result;
     }
 
-    template<floatTypes T>
-    T Matrix<T>::meanOfRow(const std::size_t row) const {
-        T result = 0;
+    template<storageTypes T>
+    T Matrix<T>::meanOfRow(const std::size_t row) const requires floatTypes<T> {
+        if (row >= this->rows_)
+            throw std::out_of_range("In Matrix::meanOfRow() row is out of bounds");
 
-        for (std::size_t c = 0; c < this->cols_; ++c) {
-                result += (*this)(row,c);
-            }
+        return blockedSum(this->data_.data() + row * this->stride_, 1, this->cols_, this->stride_) / this->cols_;
+    }
+
+    template<storageTypes T>
+    T Matrix<T>::stdDevOfRow(const std::size_t row) const requires floatTypes<T> {
+        if (row >= this->rows_)
+            throw std::out_of_range("In Matrix::stdDevOfRow() row is out of bounds");
+        if (this->cols_ < 2)
+            return T{0};
 
-        return result /  this->cols_;
+        // One pass, mean and squared deviations together (see rowStatistics in Statistics.h)
+        T moments[4];
+        Dispatch::kernels<T>().rowMoments(this->data_.data() + row * this->stride_, this->cols_, moments);
+        return std::sqrt(moments[1] / (static_cast<T>(this->cols_) - T{1}));
     }
 
-    template<floatTypes T>
-    T Matrix<T>::stdDevOfRow(const std::size_t row) const {
-        T result = 0;
+    template<storageTypes T>
+    T Matrix<T>::mean() const requires floatTypes<T> {
+        return blockedSum(this->data_.data(), this->rows_, this->cols_, this->stride_) / (this->rows_ * this->cols_);
+    }
 
-        const T mean = this->meanOfRow(row);
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::clip(const T epsilon) const requires floatTypes<T> {
+        return this->map([epsilon](T num){ return Math::Functions::clamp(num, epsilon);});
+    }
 
-        for (std::size_t c = 0; c < this->cols_; ++c) {
-            result += ((*this)(row,c) - mean) * ((*this)(row,c) - mean);
-        }
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::matMul(MatrixView<const T> other) const requires floatTypes<T> {
+        // this (m x k) other (k x n) (rows x cols) c (m x n)
+        if (this->cols_ != other.rows())
+            throw std::invalid_argument("Incompatible matrix sizes");
+
+        Matrix<T> result(this->rows_, other.cols(), uninitialized); // beta = 0, gemm doesn't read C
+
+        Gemm::gemm(this->rows_, other.cols(), this->cols_,
+                   this->data_.data(), this->stride_,
+                   other.data(), other.stride(),
+                   result.data_.data(), result.stride_);
+        return result;
+    }
+
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::matMul(MatrixView<const T> other, Gemm::Transpose transThis, Gemm::Transpose transOther, T alpha) const requires floatTypes<T> {
+        Matrix<T> result;
+        this->matMulInto(result, other, transThis, transOther, alpha, T{0});
+        return result;
+    }
 
-        return std::sqrt((T{1}/(static_cast<T>(this->cols_) - T{1})) * result);
+    template<storageTypes T>
+    void Matrix<T>::matMulInto(Matrix &result, MatrixView<const T> other, Gemm::Transpose transThis, Gemm::Transpose transOther, T alpha, T beta) const requires floatTypes<T> {
+        Math::matMulInto<T>(result, *this, other, transThis, transOther, alpha, beta);
     }
 
     template<floatTypes T>
-    T Matrix<T>::mean() const {
-        T result = 0;
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        matMulIntoAny<T>(result, A, B, transA, transB, alpha, beta);
+    }
 
-        for (std::size_t c = 0; c < cols_; ++c) {
-            for (std::size_t r = 0; r < rows_; ++r) {
-                result += (*this)(r,c);
-            }
-        }
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> A, std::type_identity_t<MatrixView<const T>> B, Gemm::Transpose transA,
+                    Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, Matrix<T>* activated, std::type_identity_t<T> alpha) {
+        affineIntoAny<T>(Z, A, B, transA, transB, bias, f, activated, alpha);
+    }
 
-        return result / (this->rows_ * this->cols_);
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, MatrixView<const bfloat16> A, MatrixView<const bfloat16> B, Gemm::Transpose transA,
+                    Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, Matrix<T>* activated, std::type_identity_t<T> alpha) {
+        affineIntoAny<T>(Z, A, B, transA, transB, bias, f, activated, alpha);
     }
 
     template<floatTypes T>
-    Matrix<T> Matrix<T>::clip(const T epsilon) const {
-        return this->map([&](T num){ return Math::Functions::clamp(num, epsilon);});
+    void affineInto(Matrix<T>& Z, MatrixView<const bfloat16> A, std::type_identity_t<MatrixView<const T>> B, Gemm::Transpose transA,
+                    Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, Matrix<T>* activated, std::type_identity_t<T> alpha) {
+        affineIntoAny<T>(Z, A, B, transA, transB, bias, f, activated, alpha);
     }
 
-    //TODO: Implement matmul more efficiently (e.g row major friendly)
     template<floatTypes T>
-    Matrix<T> Matrix<T>::matMul(const Matrix<T> &other) const {
-        // this (m x k) other (k x n) (rows x cols) c (m x n)
-        if (this->cols_ != other.rows_)
-            throw std::invalid_argument("Incompatible matrix sizes");
+    void affineInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> A, MatrixView<const bfloat16> B, Gemm::Transpose transA,
+                    Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, Matrix<T>* activated, std::type_identity_t<T> alpha) {
+        affineIntoAny<T>(Z, A, B, transA, transB, bias, f, activated, alpha);
+    }
 
-        Matrix<T> result(this->rows_, other.cols_, 0);
+    template<floatTypes T, Gemm::operandOf<T> SA, Gemm::operandOf<T> SB>
+    void affineInto(MatrixView<T> Z, MatrixView<const SA> A, MatrixView<const SB> B, Gemm::Transpose transA, Gemm::Transpose transB,
+                    std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, std::type_identity_t<T> alpha) {
+        const std::size_t m = transA == Gemm::Transpose::No ? A.rows() : A.cols();
+        const std::size_t k = transA == Gemm::Transpose::No ? A.cols() : A.rows();
+        const std::size_t kB = transB == Gemm::Transpose::No ? B.rows() : B.cols();
+        const std::size_t n = transB == Gemm::Transpose::No ? B.cols() : B.rows();
+        if (k != kB)
+            throw std::invalid_argument("In Math::affineInto() incompatible matrix sizes");
+        if (Z.rows() != m || Z.cols() != n)
+            throw std::invalid_argument("In Math::affineInto() the view has to have the shape of the product");
+        if (m == 0 || n == 0)
+            return; // e.g. an empty batch, nothing to write and no end of Z to compute
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < other.cols_; ++c) {
-                T sum = T{0};
-                for(std::size_t cr = 0; cr < this->cols_; cr++)
-                    sum += this->operator()(r,cr) * other(cr, c);
-                result(r,c) = sum;
-            }
-        }
-        return result;
+        const void* begin = Z.data();
+        const void* end = Z.data() + (Z.rows() - 1) * Z.stride() + Z.cols();
+        if (overlaps(A.data(), begin, end) || overlaps(B.data(), begin, end))
+            throw std::invalid_argument("In Math::affineInto() Z can't alias one of the operands");
+
+        const Gemm::Epilogue<T> epilogue = epilogueFor<T>(m, n, bias, f, alpha, nullptr);
+        Gemm::gemm(transA, transB, m, n, k, T{1}, A.data(), A.stride(), B.data(), B.stride(), T{0}, Z.data(), Z.stride(), epilogue);
     }
 
     template<floatTypes T>
-    Matrix<T> Matrix<T>::add(const Matrix<T> &other) const {
-        if (this->rows_ != other.rows_ || this->cols_ != other.cols_ || this->stride_ != other.stride_)
-            throw std::invalid_argument("In Matrix::add() is not the same size as other (rows/cols/stride)");
+    void biasActivationInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, Matrix<T>* activated, std::type_identity_t<T> alpha) {
+        const Gemm::Epilogue<T> epilogue = epilogueFor(Z.rows(), Z.cols(), bias, f, alpha, activated == &Z ? nullptr : activated);
+        Gemm::applyEpilogue(Z.rows(), Z.cols(), Z.data().data(), Z.stride(), epilogue);
+    }
 
-        Matrix<T> result(this->rows_, this->cols_, this->stride_);
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = this->operator()(r,c) + other(r,c);
-            }
+    template<floatTypes T>
+    void activationInto(Matrix<T>& out, std::type_identity_t<MatrixView<const T>> Z, Gemm::Activation f, std::type_identity_t<T> alpha) {
+        switch (f) {
+            case Gemm::Activation::Identity: mapInto(out, [](T z) { return z; }, Z); break;
+            case Gemm::Activation::ReLU: mapInto(out, Simd::Relu{}, Z); break;
+            case Gemm::Activation::Sigmoid: mapInto(out, Simd::Sigmoid{}, Z); break;
+            case Gemm::Activation::Tanh: mapInto(out, Simd::Tanh{}, Z); break;
+            case Gemm::Activation::Softplus: mapInto(out, Simd::Softplus{}, Z); break;
+            case Gemm::Activation::Elu: mapInto(out, Simd::Elu(static_cast<double>(alpha)), Z); break;
+            case Gemm::Activation::Delu: mapInto(out, Simd::Delu{}, Z); break;
+            case Gemm::Activation::Mish: mapInto(out, Simd::Mish{}, Z); break;
+            case Gemm::Activation::Selu: mapInto(out, Simd::Selu{}, Z); break;
+            case Gemm::Activation::LeakyReLU: mapInto(out, Simd::LeakyRelu(static_cast<double>(alpha)), Z); break;
         }
-        return result;
     }
 
     template<floatTypes T>
-    Matrix<T> Matrix<T>::sub(const Matrix &other) const {
-        if (this->rows_ != other.rows_ || this->cols_ != other.cols_ || this->stride_ != other.stride_)
-            throw std::invalid_argument("In Matrix::sub() is not the same size as other (rows/cols/stride)");
+    void matMulInto(Matrix<T>& result, MatrixView<const bfloat16> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        matMulIntoAny<T>(result, A, B, transA, transB, alpha, beta);
+    }
 
-        Matrix<T> result(this->rows_, this->cols_, this->stride_);
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = this->operator()(r,c) - other(r,c);
-            }
-        }
-        return result;
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, MatrixView<const bfloat16> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        matMulIntoAny<T>(result, A, B, transA, transB, alpha, beta);
     }
 
     template<floatTypes T>
-    Matrix<T> Matrix<T>::divide(T value) const {
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        matMulIntoAny<T>(result, A, B, transA, transB, alpha, beta);
+    }
+
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::add(MatrixView<const T> other) const requires floatTypes<T> {
+        if (this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::add() is not the same size as other (rows/cols)");
+
+        return Matrix<T>(lazy(*this) + lazy(other));
+    }
+
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::sub(MatrixView<const T> other) const requires floatTypes<T> {
+        if (this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::sub() is not the same size as other (rows/cols)");
+
+        return Matrix<T>(lazy(*this) - lazy(other));
+    }
+
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::divide(T value) const requires floatTypes<T> {
         if(value == 0)
             throw std::invalid_argument("Cant divide by 0 in Matrix divide function");
 
-        return this->map([&](T num){ return num / value;});
+        return Matrix<T>(lazy(*this) / value);
     }
 
     //TODO: Implement swap
-    template<floatTypes T>
+    template<storageTypes T>
     void Matrix<T>::swap(const Matrix &other) noexcept {
     }
 
-    template<floatTypes T>
+    template<storageTypes T>
     void Matrix<T>::fill(const T &value) {
-        std::fill(this->data_.begin(), this->data_.end(), value);
+        T* p = this->data_.data();
+        Parallel::forChunks(this->data_.size(), Parallel::grainSize(), [&](std::size_t begin, std::size_t end) {
+            std::fill(p + begin, p + end, value);
+        });
     }
 
-    template<floatTypes T>
-    void Matrix<T>::addInplace(const Matrix &other) {
-        if (this->rows_ != other.rows_ || this->cols_ != other.cols_ || this->stride_ != other.stride_)
-            throw std::invalid_argument("In Matrix::add() is not the same size as other (rows/cols/stride)");
+    template<storageTypes T>
+    void Matrix<T>::addInplace(MatrixView<const T> other) requires floatTypes<T> {
+        if (this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::add() is not the same size as other (rows/cols)");
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                this->operator()(r,c) = this->operator()(r,c) + other(r,c);
-            }
-        }
+        *this = lazy(*this) + lazy(other);
     }
 
-    template<floatTypes T>
-    void Matrix<T>::subInplace(const Matrix &other) {
-        if (this->rows_ != other.rows_ || this->cols_ != other.cols_ || this->stride_ != other.stride_)
-            throw std::invalid_argument("In Matrix::subInplace() is not the same size as other (rows/cols/stride)");
+    template<storageTypes T>
+    void Matrix<T>::subInplace(MatrixView<const T> other) requires floatTypes<T> {
+        if (this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::subInplace() is not the same size as other (rows/cols)");
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                this->operator()(r,c) = this->operator()(r,c) - other(r,c);
-            }
-        }
+        *this = lazy(*this) - lazy(other);
     }
 
-    template <floatTypes T>
-    void Matrix<T>::log1pInplaceOfRow(const std::size_t row) {
-        for (std::size_t c = 0; c < this->cols_; ++c) {
-             this->operator()(row,c) = Functions::log1p((*this)(row,c));
-        }
-    }
+    template<storageTypes T>
+    void Matrix<T>::log1pInplaceOfRow(const std::size_t row) requires floatTypes<T> {
+        if (row >= this->rows_)
+            throw std::out_of_range("In Matrix::log1pInplaceOfRow() row is out of bounds");
 
-    // TODO: Improvable by a LOT
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::hadamard(const Matrix &other) const {
-        if(this->rows_ != other.rows_ || this->cols_ != other.cols_)
-            throw std::invalid_argument("In Matrix::hadamard() shapes are not the same");
+        T* values = this->data_.data() + row * this->stride_;
+        if (std::any_of(values, values + this->cols_, [](T num){ return num <= T{-1}; }))
+            throw std::invalid_argument("log1p is undefined for num <= -1");
 
-        Matrix<T> result(this->rows_, this->cols_, 0);
+        Dispatch::transform(values, values, this->cols_, Simd::Log1p{});
+    }
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = this->operator()(r,c) * other(r,c);
-            }
+    template<storageTypes T>
+    void Matrix<T>::transposeSelf() {
+        if (this->rows_ == this->cols_) { // swap the two triangles, the stride stays valid
+            transposeSquareInplace(this->data_.data(), this->rows_, this->stride_);
+            return;
         }
 
-        return result;
+        // The padded size changes with the shape, so rectangular matrices go through a new buffer from the same resource
+        Matrix<T> result(this->cols_, this->rows_, uninitialized, 0, this->resource());
+        transposePanels(this->data_.data(), this->rows_, this->cols_, this->stride_, result.data_.data(), result.stride_);
+        *this = std::move(result);
     }
 
-    //TODO: Refer to Todo item for scalar_mul (use two templates, so std:function becomes F&& f)
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::map(std::function<T(T)> f) const {
-        Matrix<T> result(this->rows_, this->cols_, this->stride_);
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::hadamard(MatrixView<const T> other) const requires floatTypes<T> {
+        if(this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::hadamard() shapes are not the same");
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = f(this->operator()(r,c));
-            }
-        }
+        return Matrix<T>(Expr::hadamard(lazy(*this), lazy(other)));
+    }
 
-        return result;
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::scalarMul(T alpha) const requires floatTypes<T> {
+        return Matrix<T>(lazy(*this) * alpha);
     }
 
-    //TODO: Could be improved by inlining the mapping with return map([alpha](T x){ return alpha * x; }); according to chatgpt
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::scalarMul(T alpha) const {
-        auto temp = [&](T value) { return alpha*value;};
-        return map(temp);
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::sumOverRows() const requires floatTypes<T> {
+        Matrix<T> result(1, this->cols_, uninitialized, 0, this->resource());
+        this->sumOverRowsInto(result);
+        return result;
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::sumOverColumns() const {
-        Matrix<T> result(this->rows_,1, 0);
+    template<storageTypes T>
+    void Matrix<T>::sumOverRowsInto(Matrix<T>& result) const requires floatTypes<T> {
+        if (&result == this)
+            throw std::invalid_argument("Matrix::sumOverRowsInto() result can't be the matrix itself");
+        if (result.rows_ != 1 || result.cols_ != this->cols_)
+            result = Matrix<T>(1, this->cols_, uninitialized, 0, result.resource());
+        std::fill_n(result.data_.data(), this->cols_, T{0});
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            T column_sum = {0};
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                column_sum += this->operator()(r,c);
+        // Column ranges in parallel, every sum is still added up row by row by a single task
+        T* sums = result.data_.data();
+        const std::size_t width = std::max<std::size_t>(64, Parallel::grainSize() / std::max<std::size_t>(this->rows_, 1) / 64 * 64);
+        Parallel::forChunks(this->cols_, width, [&](std::size_t c0, std::size_t c1) {
+            for (std::size_t r = 0; r < this->rows_; ++r) {
+                const T* row = this->data_.data() + r * this->stride_;
+                for (std::size_t c = c0; c < c1; ++c)
+                    sums[c] += row[c];
             }
-            result(r,0) = column_sum;
-        }
+        });
+    }
 
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::sumOverColumns() const requires floatTypes<T> {
+        Matrix<T> result;
+        this->sumOverColumnsInto(result);
         return result;
     }
 
-    // TODO: Improvable by a LOT
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::divide(const Matrix &other) const {
-        if(this->rows_ != other.rows_ || this->cols_ != other.cols_ || this->stride_ != other.stride_)
-            throw std::invalid_argument("In Matrix::divide() shape or stride are not the same");
-
-        Matrix<T> result(this->rows_, this->cols_, 0);
+    template<storageTypes T>
+    void Matrix<T>::sumOverColumnsInto(Matrix<T>& result) const requires floatTypes<T> {
+        if (&result == this)
+            throw std::invalid_argument("Matrix::sumOverColumnsInto() result can't be the matrix itself");
+        if (result.rows_ != this->rows_ || result.cols_ != 1)
+            result = Matrix<T>(this->rows_, 1, uninitialized, 0, result.resource());
+
+        const auto& kernels = Dispatch::kernels<T>();
+        const T* data = this->data_.data();
+        T* out = result.data_.data();
+        const Kernels::BlockGrid grid(this->rows_, this->cols_);
+        if (grid.colBlocks == 1) { // blocks of whole rows
+            Kernels::forBlocks(grid, [&](const Kernels::Block& b, std::size_t) {
+                kernels.rowSums(data + b.r0 * this->stride_, b.r1 - b.r0, this->cols_, this->stride_, out + b.r0 * result.stride_, result.stride_);
+            });
+            return;
+        }
 
+        // Rows longer than the grain: one partial per block (block i is row i / colBlocks), added in order
+        const std::span<T> partials = Kernels::blockPartials<T>(grid);
+        Kernels::forBlocks(grid, [&](const Kernels::Block& b, std::size_t i) {
+            partials[i] = kernels.sum(data + b.r0 * this->stride_ + b.c0, 1, b.c1 - b.c0, this->stride_);
+        });
         for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = this->operator()(r,c) / other(r,c);
-            }
+            T sum = T{0};
+            for (std::size_t j = 0; j < grid.colBlocks; ++j)
+                sum += partials[r * grid.colBlocks + j];
+            out[r * result.stride_] = sum;
         }
-
-        return result;
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::addBias(const Matrix& bias) const {
-        if(bias.cols_ != 1 || bias.rows_ != this->rows_)
-            throw std::invalid_argument("In Matrix::addBias either bias matrix has more than 1 column or rows don't match");
-
-        Matrix<T> result(this->rows_, this->cols_, this->stride_);
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::divide(MatrixView<const T> other) const requires floatTypes<T> {
+        if(this->rows_ != other.rows() || this->cols_ != other.cols())
+            throw std::invalid_argument("In Matrix::divide() shapes are not the same");
 
-        for (std::size_t r = 0; r < this->rows_; ++r) {
-            for (std::size_t c = 0; c < this->cols_; ++c) {
-                result(r,c) = this->operator()(r,c) + bias(r, 0);
-            }
-        }
+        return Matrix<T>(Expr::divide(lazy(*this), lazy(other)));
+    }
 
-        return result;
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::addBias(MatrixView<const T> bias) const requires floatTypes<T> {
+        return Matrix<T>(Expr::addBias(lazy(*this), bias));
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::sigmoid() const {
-        return this->map([](T num){return Math::Functions::sigmoid(num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::sigmoid() const requires floatTypes<T> {
+        return this->map(Simd::Sigmoid{});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::tanh() const {
-        return this->map([](T num){return Math::Functions::tanh(num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::tanh() const requires floatTypes<T> {
+        return this->map(Simd::Tanh{});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::relu() const {
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::relu() const requires floatTypes<T> {
         return this->map([](T num){return Math::Functions::relu(num);});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::softplus() const {
-        return this->map([](T num){return Math::Functions::softplus(num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::softplus() const requires floatTypes<T> {
+        return this->map(Simd::Softplus{});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::mish() const {
-        return this->map([](T num){return Math::Functions::mish(num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::mish() const requires floatTypes<T> {
+        return this->map(Simd::Mish{});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::linear() const {
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::linear() const requires floatTypes<T> {
         return this->map([](T num){return Math::Functions::linear(num);});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::log(const T base) const {
-        return this->map([&](T num){return Math::Functions::log(base, num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::log(const T base) const requires floatTypes<T> {
+        return this->map(Simd::Log(base));
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::delu(const int a, const int b, const double xc) const {
-        return this->map([&](T num){return Math::Functions::delu(num, a, b, xc);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::delu(const int a, const int b, const double xc) const requires floatTypes<T> {
+        return this->map([a, b, xc](T num){return Math::Functions::delu(num, a, b, xc);});
     }
 
-    template<floatTypes T>
-    Matrix<T> Matrix<T>::elu(const double alpha) const {
-        return this->map([&](T num){return Math::Functions::elu(num, alpha);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::elu(const double alpha) const requires floatTypes<T> {
+        return this->map([alpha](T num){return Math::Functions::elu(num, alpha);});
     }
 
-    template <floatTypes T>
-    Matrix<T> Matrix<T>::log1p() const {
-        return this->map([](T num){return Math::Functions::log1p(num);});
+    template<storageTypes T>
+    Matrix<T> Matrix<T>::log1p() const requires floatTypes<T> {
+        if (std::ranges::any_of(this->data_, [](T num){ return num <= T{-1}; }))
+            throw std::invalid_argument("log1p is undefined for num <= -1");
+
+        return this->map(Simd::Log1p{});
+    }
+
+    template<storageTypes T>
+    void transposeInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A) {
+        const void* resultBegin = result.data().data();
+        const void* resultEnd = result.data().data() + result.bufferSize();
+        if (overlaps(A.data(), resultBegin, resultEnd))
+            throw std::invalid_argument("In Matrix::transposeInto() result can't alias A, use transposeSelf()");
+
+        if (result.rows() != A.cols() || result.cols() != A.rows())
+            result = Matrix<T>(A.cols(), A.rows(), uninitialized, 0, result.resource());
+        transposePanels(A.data(), A.rows(), A.cols(), A.stride(), result.data().data(), result.stride());
     }
 
     template class Matrix<float>;
     template class Matrix<double>;
+    template class Matrix<bfloat16>; // only the storage members, the others require floatTypes
+
+    template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    template void matMulInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, double, double);
+    template void matMulInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, double, double);
+    template void affineInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    template void affineInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    template void affineInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    template void affineInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    template void affineInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    template void affineInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    template void affineInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    template void affineInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    template void affineInto<float, float, float>(MatrixView<float>, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    template void affineInto<float, bfloat16, bfloat16>(MatrixView<float>, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    template void affineInto<float, bfloat16, float>(MatrixView<float>, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    template void affineInto<float, float, bfloat16>(MatrixView<float>, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    template void affineInto<double, double, double>(MatrixView<double>, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    template void affineInto<double, bfloat16, bfloat16>(MatrixView<double>, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    template void affineInto<double, bfloat16, double>(MatrixView<double>, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    template void affineInto<double, double, bfloat16>(MatrixView<double>, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    template void biasActivationInto<float>(Matrix<float>&, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    template void biasActivationInto<double>(Matrix<double>&, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    template void activationInto<float>(Matrix<float>&, MatrixView<const float>, Gemm::Activation, float);
+    template void activationInto<double>(Matrix<double>&, MatrixView<const double>, Gemm::Activation, double);
+    template void transposeInto<float>(Matrix<float>&, MatrixView<const float>);
+    template void transposeInto<double>(Matrix<double>&, MatrixView<const double>);
+    template void transposeInto<bfloat16>(Matrix<bfloat16>&, MatrixView<const bfloat16>);
 } // Math
\ No newline at end of file
@@ -10,6 +10,16 @@
 #include <ostream>
 #include <iomanip>
 #include <functional>
+#include <memory_resource>
+
+#include "Allocator.h"
+#include "BFloat16.h"
+#include "BoundsCheck.h"
+#include "Concepts.h"
+#include "Gemm.h"
+#include "MatrixExpression.h"
+#include "MatrixView.h"
+#include "Elementwise.h"
 
 /*
  *
@@ -23,31 +33,48 @@
 
 namespace Math {
 
-template<typename T>
-concept floatTypes = std::is_floating_point_v<T>;
-
-template<typename T>
-concept numericTypes = std::is_arithmetic_v<T>;
-
-template <floatTypes T>
+// T is float or double, or bfloat16 as storage only: a Matrix<bfloat16> has the shape, storage and view members, the
+// arithmetic requires floatTypes (conversions and mixed precision products are in Precision.h)
+template <storageTypes T>
 class Matrix {
+public:
+    using Storage = std::vector<T, Memory::AlignedAllocator<T>>; // 64 byte aligned, see Allocator.h
 private:
     // stride_ >= cols_, data_.size() == rows_*stride_
-    std::vector<T> data_;
+    Storage data_;
     std::size_t rows_, cols_, stride_;
+
+    void initShape(std::size_t stride);
 public:
     // Con- & Destructors
-    explicit Matrix(std::size_t rows, std::size_t cols, std::size_t stride = 0); // if stride=0, round up cols to a SIMD-friendly multiple (e.g., 8 for float on AVX2)
+    // if stride=0, round up cols to a SIMD-friendly multiple (e.g., 8 for float on AVX2); resource nullptr = Memory::defaultResource()
+    explicit Matrix(std::size_t rows, std::size_t cols, std::size_t stride = 0, std::pmr::memory_resource* resource = nullptr);
+    Matrix(std::size_t rows, std::size_t cols, Uninitialized, std::size_t stride = 0, std::pmr::memory_resource* resource = nullptr);
     explicit Matrix() noexcept; // if stride=0, round up cols to a SIMD-friendly multiple (e.g., 8 for float on AVX2)
     Matrix(const Matrix& other) = default;
     Matrix(Matrix&& other) = default;
+    template<Expr::expression E>
+    explicit Matrix(const E& expression) requires floatTypes<T>; // Evaluates a lazy expression into a new matrix (see MatrixExpression.h)
+    explicit Matrix(MatrixView<const T> view, std::pmr::memory_resource* resource = nullptr); // Copies the view into a new (padded) matrix
     ~Matrix() = default;
 
     // Operators
     Matrix& operator=(const Matrix& other) = default;
     Matrix& operator=(Matrix&& other) = default;
-    T& operator()(std::size_t r, std::size_t c);
-    const T& operator()(std::size_t r, std::size_t c) const;
+    template<Expr::expression E>
+    Matrix& operator=(const E& expression) requires floatTypes<T>; // Evaluates in place if rows/cols match, expression may read from *this
+    // Checked or not depending on the build (BoundsCheck.h), inline so an unchecked build loops like over a pointer
+    T& operator()(std::size_t r, std::size_t c) noexcept(!boundsChecked) {
+        checkIndex(r, c, rows_, cols_, "In Matrix::operator() r or c are out of bounds");
+        return this->data_[r * stride_ + c];
+    }
+    const T& operator()(std::size_t r, std::size_t c) const noexcept(!boundsChecked) {
+        checkIndex(r, c, rows_, cols_, "In Matrix::operator() r or c are out of bounds");
+        return this->data_[r * stride_ + c];
+    }
+    // Never checked, for kernel code that validated its ranges up front
+    T& unchecked(std::size_t r, std::size_t c) noexcept { return this->data_[r * stride_ + c]; }
+    const T& unchecked(std::size_t r, std::size_t c) const noexcept { return this->data_[r * stride_ + c]; }
 
     // Getter & Setter
     [[nodiscard]] std::span<T> data() noexcept;
@@ -57,47 +84,160 @@ public:
     [[nodiscard]] std::size_t stride() const noexcept;
     [[nodiscard]] std::size_t bufferSize() const noexcept; // rows_ * stride_
     [[nodiscard]] std::size_t elementCount() const noexcept; // rows_ * cols_
+    [[nodiscard]] std::pmr::memory_resource* resource() const noexcept;
+    [[nodiscard]] MatrixView<T> view() noexcept;
+    [[nodiscard]] MatrixView<const T> view() const noexcept;
 
     // Functions
-    [[nodiscard]] Matrix transpose() const;
-    [[nodiscard]] T mean() const;
-    [[nodiscard]] T meanOfRow(const std::size_t row) const;
-    [[nodiscard]] T stdDevOfRow(const std::size_t row) const;
-    [[nodiscard]] Matrix clip(const T epsilon) const;
-    [[nodiscard]] Matrix matMul(const Matrix& other) const;
-    [[nodiscard]] Matrix add(const Matrix& other) const;
-    [[nodiscard]] Matrix sub(const Matrix& other) const;
-    [[nodiscard]] Matrix divide(T value) const;
-    [[nodiscard]] Matrix divide(const Matrix& other) const;
-    [[nodiscard]] Matrix hadamard(const Matrix& other) const;
-    [[nodiscard]] Matrix map(std::function<T(T)> f) const;
-    [[nodiscard]] Matrix scalarMul(T value) const;
-    [[nodiscard]] Matrix sumOverColumns() const;
-    [[nodiscard]] Matrix addBias(const Matrix& bias) const;
+    [[nodiscard]] Matrix transpose() const; // see transposeInto
+    [[nodiscard]] T mean() const requires floatTypes<T>;
+    [[nodiscard]] T meanOfRow(const std::size_t row) const requires floatTypes<T>;
+    [[nodiscard]] T stdDevOfRow(const std::size_t row) const requires floatTypes<T>;
+    [[nodiscard]] Matrix clip(const T epsilon) const requires floatTypes<T>;
+    [[nodiscard]] Matrix matMul(MatrixView<const T> other) const requires floatTypes<T>;
+    [[nodiscard]] Matrix matMul(MatrixView<const T> other, Gemm::Transpose transThis, Gemm::Transpose transOther, T alpha = T{1}) const requires floatTypes<T>; // alpha * op(this) * op(other)
+    [[nodiscard]] Matrix add(MatrixView<const T> other) const requires floatTypes<T>;
+    [[nodiscard]] Matrix sub(MatrixView<const T> other) const requires floatTypes<T>;
+    [[nodiscard]] Matrix divide(T value) const requires floatTypes<T>;
+    [[nodiscard]] Matrix divide(MatrixView<const T> other) const requires floatTypes<T>;
+    [[nodiscard]] Matrix hadamard(MatrixView<const T> other) const requires floatTypes<T>;
+    template<class F>
+    [[nodiscard]] Matrix map(F f) const requires floatTypes<T>; // f(T) -> T on every element, see Elementwise.h
+    [[nodiscard]] Matrix scalarMul(T value) const requires floatTypes<T>;
+    [[nodiscard]] Matrix sumOverColumns() const requires floatTypes<T>; // rows x 1
+    [[nodiscard]] Matrix sumOverRows() const requires floatTypes<T>; // 1 x cols
+    // Same sums into result, which keeps its buffer if it already has the shape (result can't be this)
+    void sumOverColumnsInto(Matrix& result) const requires floatTypes<T>;
+    void sumOverRowsInto(Matrix& result) const requires floatTypes<T>;
+    [[nodiscard]] Matrix addBias(MatrixView<const T> bias) const requires floatTypes<T>;
 
     //TODO: Activation functions
-    [[nodiscard]] Matrix tanh() const;
-    [[nodiscard]] Matrix fastSigmoid_Fabs() const;
-    [[nodiscard]] Matrix sigmoid() const;
-    [[nodiscard]] Matrix relu() const;
-    [[nodiscard]] Matrix elu(const double) const;
-    [[nodiscard]] Matrix log1p() const;
-    [[nodiscard]] Matrix softplus() const;
-    [[nodiscard]] Matrix linear() const;
-    [[nodiscard]] Matrix mish() const;
-    [[nodiscard]] Matrix log(const T base) const;
-    [[nodiscard]] Matrix delu(const int a = 1, const int b = 2, const double = 1.25643) const;
+    [[nodiscard]] Matrix tanh() const requires floatTypes<T>;
+    [[nodiscard]] Matrix fastSigmoid_Fabs() const requires floatTypes<T>;
+    [[nodiscard]] Matrix sigmoid() const requires floatTypes<T>;
+    [[nodiscard]] Matrix relu() const requires floatTypes<T>;
+    [[nodiscard]] Matrix elu(const double) const requires floatTypes<T>;
+    [[nodiscard]] Matrix log1p() const requires floatTypes<T>;
+    [[nodiscard]] Matrix softplus() const requires floatTypes<T>;
+    [[nodiscard]] Matrix linear() const requires floatTypes<T>;
+    [[nodiscard]] Matrix mish() const requires floatTypes<T>;
+    [[nodiscard]] Matrix log(const T base) const requires floatTypes<T>;
+    [[nodiscard]] Matrix delu(const int a = 1, const int b = 2, const double = 1.25643) const requires floatTypes<T>;
 
     // Inplace functions
     void swap(const Matrix& other) noexcept;
     void fill(const T& value);
-    void addInplace(const Matrix& other);
-    void subInplace(const Matrix& other);
-    void log1pInplaceOfRow(const std::size_t row);
+    void addInplace(MatrixView<const T> other) requires floatTypes<T>;
+    void subInplace(MatrixView<const T> other) requires floatTypes<T>;
+    void log1pInplaceOfRow(const std::size_t row) requires floatTypes<T>;
+    // *this = this^T, for switching layouts (see Layout.h). Square matrices are transposed in their own buffer;
+    // rectangular ones change their padded size, so they are transposed into a new buffer from the same resource
+    void transposeSelf();
+    void matMulInto(Matrix& result, MatrixView<const T> other, Gemm::Transpose transThis = Gemm::Transpose::No,
+                    Gemm::Transpose transOther = Gemm::Transpose::No, T alpha = T{1}, T beta = T{0}) const requires floatTypes<T>; // result = alpha * op(this) * op(other) + beta * result
 };
 
-    // ChatGPT generated
+    template<storageTypes T>
+    template<Expr::expression E>
+    Matrix<T>::Matrix(const E& expression) requires floatTypes<T> : Matrix(expression.shape.rows, expression.shape.cols, uninitialized) {
+        Expr::evaluate(expression, this->data_.data(), this->stride_);
+    }
+
+    template<storageTypes T>
+    template<Expr::expression E>
+    Matrix<T>& Matrix<T>::operator=(const E& expression) requires floatTypes<T> {
+        static_assert(std::is_same_v<typename E::value_type, T>, "Expression has a different element type");
+        const auto& shape = expression.shape;
+
+        if (this->rows_ != shape.rows || this->cols_ != shape.cols) {
+            Matrix<T> result(expression); // new buffer, so the expression may still read the old one
+            *this = std::move(result);
+            return *this;
+        }
+
+        // Every element only depends on the same index of the operands, writing into one of them is fine
+        Expr::evaluate(expression, this->data_.data(), this->stride_);
+        return *this;
+    }
+
+    // result = alpha * op(A) * op(B) + beta * result for any two views, Matrix::matMulInto is this with A = *this.
+    // result is reallocated (in its memory resource) if its shape doesn't match and beta == 0
     template<floatTypes T>
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    // Mixed precision: bfloat16 operands are widened while the gemm packs them, the products accumulate in T
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, MatrixView<const bfloat16> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, MatrixView<const bfloat16> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    // Dense layer forward as one gemm: Z = op(A) * op(B) + bias, then f(Z) into activated (or over Z if activated is
+    // nullptr or Z), both applied in the gemm epilogue while each tile is still in L1 (Gemm::Epilogue). bias is a column
+    // (rows(Z) x 1, added to every column) or a row (1 x cols(Z), added to every row), an empty view adds nothing;
+    // alpha is the parameter of Elu or the slope of LeakyReLU. Z and activated are reallocated if their shape doesn't match, neither may alias
+    // the operands. A and B can be T or bfloat16 like in matMulInto
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias,
+                    Gemm::Activation f, Matrix<T>* activated = nullptr, std::type_identity_t<T> alpha = T{1});
+
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, MatrixView<const bfloat16> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias,
+                    Gemm::Activation f, Matrix<T>* activated = nullptr, std::type_identity_t<T> alpha = T{1});
+
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, MatrixView<const bfloat16> A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias,
+                    Gemm::Activation f, Matrix<T>* activated = nullptr, std::type_identity_t<T> alpha = T{1});
+
+    template<floatTypes T>
+    void affineInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> A, MatrixView<const bfloat16> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<MatrixView<const T>> bias,
+                    Gemm::Activation f, Matrix<T>* activated = nullptr, std::type_identity_t<T> alpha = T{1});
+
+    // Same into a view that already has the shape of the product (e.g. the top rows of a bigger buffer), f is applied
+    // over Z and nothing gets reallocated
+    template<floatTypes T, Gemm::operandOf<T> SA, Gemm::operandOf<T> SB>
+    void affineInto(MatrixView<T> Z, MatrixView<const SA> A, MatrixView<const SB> B, Gemm::Transpose transA, Gemm::Transpose transB,
+                    std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f, std::type_identity_t<T> alpha = T{1});
+
+    // The epilogue of affineInto as a pass of its own over an existing Z, e.g. after a sparse product
+    template<floatTypes T>
+    void biasActivationInto(Matrix<T>& Z, std::type_identity_t<MatrixView<const T>> bias, Gemm::Activation f,
+                            Matrix<T>* activated = nullptr, std::type_identity_t<T> alpha = T{1});
+
+    // out = f(Z) with the register ops of the epilogue (same bits as the fused path), out can be Z
+    template<floatTypes T>
+    void activationInto(Matrix<T>& out, std::type_identity_t<MatrixView<const T>> Z, Gemm::Activation f, std::type_identity_t<T> alpha = T{1});
+
+    // result = A^T: cache oblivious with SIMD tiles, in parallel for large A (relayouts, see Layout.h). result is
+    // reallocated (in its memory resource) if its shape doesn't match
+    template<storageTypes T>
+    void transposeInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A);
+
+    template<storageTypes T>
+    template<class F>
+    Matrix<T> Matrix<T>::map(F f) const requires floatTypes<T> {
+        Matrix<T> result;
+        mapInto(result, std::move(f), *this);
+        return result;
+    }
+
+    // ChatGPT generated
+    template<storageTypes T>
     std::ostream &operator<<(std::ostream &os, const Matrix<T> &M) {
         // Optional: remember old formatting and restore at end
         std::ios old_state(nullptr);
@@ -124,6 +264,38 @@ public:
 
     extern template class Matrix<float>;
     extern template class Matrix<double>;
+    extern template class Matrix<bfloat16>;
+    extern template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    extern template void matMulInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, double, double);
+    extern template void matMulInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    extern template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, double, double);
+    extern template void affineInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    extern template void affineInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    extern template void affineInto<float>(Matrix<float>&, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    extern template void affineInto<float>(Matrix<float>&, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    extern template void affineInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    extern template void affineInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    extern template void affineInto<double>(Matrix<double>&, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    extern template void affineInto<double>(Matrix<double>&, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    extern template void affineInto<float, float, float>(MatrixView<float>, MatrixView<const float>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    extern template void affineInto<float, bfloat16, bfloat16>(MatrixView<float>, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    extern template void affineInto<float, bfloat16, float>(MatrixView<float>, MatrixView<const bfloat16>, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    extern template void affineInto<float, float, bfloat16>(MatrixView<float>, MatrixView<const float>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const float>, Gemm::Activation, float);
+    extern template void affineInto<double, double, double>(MatrixView<double>, MatrixView<const double>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    extern template void affineInto<double, bfloat16, bfloat16>(MatrixView<double>, MatrixView<const bfloat16>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    extern template void affineInto<double, bfloat16, double>(MatrixView<double>, MatrixView<const bfloat16>, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    extern template void affineInto<double, double, bfloat16>(MatrixView<double>, MatrixView<const double>, MatrixView<const bfloat16>, Gemm::Transpose, Gemm::Transpose, MatrixView<const double>, Gemm::Activation, double);
+    extern template void biasActivationInto<float>(Matrix<float>&, MatrixView<const float>, Gemm::Activation, Matrix<float>*, float);
+    extern template void biasActivationInto<double>(Matrix<double>&, MatrixView<const double>, Gemm::Activation, Matrix<double>*, double);
+    extern template void activationInto<float>(Matrix<float>&, MatrixView<const float>, Gemm::Activation, float);
+    extern template void activationInto<double>(Matrix<double>&, MatrixView<const double>, Gemm::Activation, double);
+    extern template void transposeInto<float>(Matrix<float>&, MatrixView<const float>);
+    extern template void transposeInto<double>(Matrix<double>&, MatrixView<const double>);
+    extern template void transposeInto<bfloat16>(Matrix<bfloat16>&, MatrixView<const bfloat16>);
 
 } // Math
 
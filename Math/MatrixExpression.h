@@ -0,0 +1,268 @@
+//
+// Created by timwe on 11/15/2025.
+//
+
+#ifndef NEUROINFORMATICS_MATRIXEXPRESSION_H
+#define NEUROINFORMATICS_MATRIXEXPRESSION_H
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Concepts.h"
+#include "Elementwise.h"
+#include "Functions.h"
+#include "MatrixView.h"
+
+/*
+ * Lazy element-wise expressions over Matrix.
+ * Math::lazy(M) wraps a matrix into a leaf, the operators/functions below only build a tree of small structs.
+ * Nothing is computed until the tree gets assigned to a Matrix, then the whole tree is evaluated in one loop over the
+ * rows, i.e. one read of every operand and one write of the result, no temporaries.
+ *
+ *      W = Math::lazy(W) - Math::lazy(dW) * lr;                        // in place, no allocation
+ *      Math::Matrix<T> dA(Math::Expr::divide(-Math::lazy(Y), p) + ...); // one allocation for the result
+ *
+ * All operands have to share rows and cols, each leaf keeps its own stride, so lazy(view) of a slice mixes with whole
+ * matrices. A tree keeps pointers into the matrices it was built from, so it must not outlive them (don't keep an
+ * expression built from a temporary in an auto variable).
+ */
+
+namespace Math {
+    template<storageTypes T>
+    class Matrix;
+
+    namespace Expr {
+        struct Node {}; // Tag base, everything deriving from it can be assigned to a Matrix
+
+        template<typename E>
+        concept expression = std::is_base_of_v<Node, std::remove_cvref_t<E>>;
+
+        struct Shape {
+            std::size_t rows, cols;
+
+            [[nodiscard]] bool operator==(const Shape&) const = default;
+        };
+
+        inline Shape commonShape(const Shape& a, const Shape& b) {
+            if (a != b)
+                throw std::invalid_argument("In Math::Expr operands are not the same size (rows/cols)");
+            return a;
+        }
+
+        // Reads one matrix or view
+        template<floatTypes T>
+        struct Leaf : Node {
+            using value_type = T;
+            const T* data;
+            std::size_t stride;
+            Shape shape;
+
+            [[nodiscard]] T at(std::size_t r, std::size_t c) const noexcept { return data[r * stride + c]; }
+        };
+
+        template<class E, class Op>
+        struct Unary : Node {
+            using value_type = typename E::value_type;
+            E operand;
+            Op op;
+            Shape shape;
+
+            Unary(E _operand, Op _op) : operand(std::move(_operand)), op(std::move(_op)), shape(operand.shape) {}
+
+            [[nodiscard]] value_type at(std::size_t r, std::size_t c) const { return op(operand.at(r, c)); }
+        };
+
+        template<class L, class R, class Op>
+        struct Binary : Node {
+            using value_type = typename L::value_type;
+            L left;
+            R right;
+            Op op;
+            Shape shape;
+
+            Binary(L _left, R _right, Op _op)
+                : left(std::move(_left)), right(std::move(_right)), op(std::move(_op)), shape(commonShape(left.shape, right.shape)) {}
+
+            [[nodiscard]] value_type at(std::size_t r, std::size_t c) const { return op(left.at(r, c), right.at(r, c)); }
+        };
+
+        // Adds bias(r, 0) to every element of row r
+        template<class E>
+        struct RowBias : Node {
+            using value_type = typename E::value_type;
+            E operand;
+            const value_type* bias;
+            std::size_t biasStride;
+            Shape shape;
+
+            RowBias(E _operand, const value_type* _bias, std::size_t _biasStride)
+                : operand(std::move(_operand)), bias(_bias), biasStride(_biasStride), shape(operand.shape) {}
+
+            [[nodiscard]] value_type at(std::size_t r, std::size_t c) const { return operand.at(r, c) + bias[r * biasStride]; }
+        };
+
+        // Adds bias(0, c) to every element of column c (the bias of sample-major activations)
+        template<class E>
+        struct ColumnBias : Node {
+            using value_type = typename E::value_type;
+            E operand;
+            const value_type* bias;
+            Shape shape;
+
+            ColumnBias(E _operand, const value_type* _bias) : operand(std::move(_operand)), bias(_bias), shape(operand.shape) {}
+
+            [[nodiscard]] value_type at(std::size_t r, std::size_t c) const { return operand.at(r, c) + bias[c]; }
+        };
+
+        // Element-wise operations
+        struct Add { template<class T> T operator()(T a, T b) const { return a + b; } };
+        struct Sub { template<class T> T operator()(T a, T b) const { return a - b; } };
+        struct Mul { template<class T> T operator()(T a, T b) const { return a * b; } };
+        struct Div { template<class T> T operator()(T a, T b) const { return a / b; } };
+        struct Negate { template<class T> T operator()(T a) const { return -a; } };
+
+        template<class T> struct ScalarMul { T value; T operator()(T a) const { return a * value; } };
+        template<class T> struct ScalarDiv { T value; T operator()(T a) const { return a / value; } };
+        template<class T> struct ScalarAdd { T value; T operator()(T a) const { return a + value; } };
+        template<class T> struct ScalarSubFrom { T value; T operator()(T a) const { return value - a; } };
+
+        // Activation maps
+        struct Sigmoid { template<class T> T operator()(T a) const { return Functions::sigmoid(a); } };
+        struct Tanh { template<class T> T operator()(T a) const { return Functions::tanh(a); } };
+        struct Relu { template<class T> T operator()(T a) const { return Functions::relu(a); } };
+        struct Softplus { template<class T> T operator()(T a) const { return Functions::softplus(a); } };
+        struct Mish { template<class T> T operator()(T a) const { return Functions::mish(a); } };
+        struct Linear { template<class T> T operator()(T a) const { return Functions::linear(a); } };
+        template<class T> struct Elu { double alpha; T operator()(T a) const { return Functions::elu(a, alpha); } };
+        template<class T> struct Delu { int a, b; double xc; T operator()(T num) const { return Functions::delu(num, a, b, xc); } };
+        template<class T> struct Log { T invLnBase; T operator()(T a) const { return std::log(a) * invLnBase; } }; // 1/ln(base) once per tree
+        template<class T> struct Clamp { T epsilon; T operator()(T a) const { return Functions::clamp(a, epsilon); } };
+
+        // Builders
+        template<expression L, expression R>
+        auto operator+(const L& l, const R& r) { return Binary<L, R, Add>(l, r, Add{}); }
+
+        template<expression L, expression R>
+        auto operator-(const L& l, const R& r) { return Binary<L, R, Sub>(l, r, Sub{}); }
+
+        template<expression E>
+        auto operator-(const E& e) { return Unary<E, Negate>(e, Negate{}); }
+
+        template<expression E>
+        auto operator*(const E& e, typename E::value_type value) { return Unary<E, ScalarMul<typename E::value_type>>(e, {value}); }
+
+        template<expression E>
+        auto operator*(typename E::value_type value, const E& e) { return e * value; }
+
+        template<expression E>
+        auto operator/(const E& e, typename E::value_type value) {
+            if (value == 0)
+                throw std::invalid_argument("Cant divide by 0 in Math::Expr");
+            return Unary<E, ScalarDiv<typename E::value_type>>(e, {value});
+        }
+
+        template<expression E>
+        auto operator+(const E& e, typename E::value_type value) { return Unary<E, ScalarAdd<typename E::value_type>>(e, {value}); }
+
+        template<expression E>
+        auto operator-(typename E::value_type value, const E& e) { return Unary<E, ScalarSubFrom<typename E::value_type>>(e, {value}); }
+
+        template<expression L, expression R>
+        auto hadamard(const L& l, const R& r) { return Binary<L, R, Mul>(l, r, Mul{}); }
+
+        template<expression L, expression R>
+        auto divide(const L& l, const R& r) { return Binary<L, R, Div>(l, r, Div{}); }
+
+        template<expression E, class F>
+        auto map(const E& e, F f) { return Unary<E, F>(e, std::move(f)); }
+
+        template<expression E>
+        auto addBias(const E& e, MatrixView<const typename E::value_type> bias) {
+            if (bias.cols() != 1 || bias.rows() != e.shape.rows)
+                throw std::invalid_argument("In Math::Expr::addBias either bias matrix has more than 1 column or rows don't match");
+            return RowBias<E>(e, bias.data(), bias.stride());
+        }
+
+        template<expression E>
+        auto addColumnBias(const E& e, MatrixView<const typename E::value_type> bias) {
+            if (bias.rows() != 1 || bias.cols() != e.shape.cols)
+                throw std::invalid_argument("In Math::Expr::addColumnBias either bias matrix has more than 1 row or cols don't match");
+            return ColumnBias<E>(e, bias.data());
+        }
+
+        template<expression E> auto sigmoid(const E& e) { return Unary<E, Sigmoid>(e, {}); }
+        template<expression E> auto tanh(const E& e) { return Unary<E, Tanh>(e, {}); }
+        template<expression E> auto relu(const E& e) { return Unary<E, Relu>(e, {}); }
+        template<expression E> auto softplus(const E& e) { return Unary<E, Softplus>(e, {}); }
+        template<expression E> auto mish(const E& e) { return Unary<E, Mish>(e, {}); }
+        template<expression E> auto linear(const E& e) { return Unary<E, Linear>(e, {}); }
+        template<expression E> auto elu(const E& e, double alpha) { return Unary<E, Elu<typename E::value_type>>(e, {alpha}); }
+        template<expression E> auto delu(const E& e, int a, int b, double xc) { return Unary<E, Delu<typename E::value_type>>(e, {a, b, xc}); }
+        template<expression E> auto log(const E& e, typename E::value_type base) { return Unary<E, Log<typename E::value_type>>(e, {static_cast<typename E::value_type>(1.0 / std::log(base))}); }
+        template<expression E> auto clip(const E& e, typename E::value_type epsilon) { return Unary<E, Clamp<typename E::value_type>>(e, {epsilon}); }
+
+        // Writes e into dst (rows rows of stride elements) in one pass, big shapes block-wise on the worker pool;
+        // padding is reset to 0
+        template<expression E>
+        void evaluate(const E& e, typename E::value_type* dst, std::size_t stride) {
+            using T = typename E::value_type;
+            const auto [rows, cols] = e.shape;
+
+            Kernels::forBlocks(Kernels::BlockGrid(rows, cols), [&](const Kernels::Block& b, std::size_t) {
+                for (std::size_t r = b.r0; r < b.r1; ++r) {
+                    T* out = dst + r * stride;
+                    for (std::size_t c = b.c0; c < b.c1; ++c)
+                        out[c] = e.at(r, c);
+                }
+            });
+
+            Kernels::zeroPadding(dst, rows, cols, stride);
+        }
+
+        // Sum over the valid elements (padding excluded), fused with the expression so nothing gets materialised.
+        // One partial sum per block, added in block order, so the result doesn't depend on the thread count
+        template<expression E>
+        typename E::value_type sum(const E& e) {
+            using T = typename E::value_type;
+            const auto [rows, cols] = e.shape;
+
+            const Kernels::BlockGrid grid(rows, cols);
+            const std::span<T> partials = Kernels::blockPartials<T>(grid);
+            Kernels::forBlocks(grid, [&](const Kernels::Block& b, std::size_t i) {
+                T sum = T{0};
+                for (std::size_t r = b.r0; r < b.r1; ++r)
+                    for (std::size_t c = b.c0; c < b.c1; ++c)
+                        sum += e.at(r, c);
+                partials[i] = sum;
+            });
+
+            T result = T{0};
+            for (const T partial : partials)
+                result += partial;
+            return result;
+        }
+
+        template<expression E>
+        typename E::value_type mean(const E& e) {
+            using T = typename E::value_type;
+            const auto [rows, cols] = e.shape;
+            return sum(e) / static_cast<T>(rows * cols);
+        }
+    } // Expr
+
+    template<floatTypes T>
+    Expr::Leaf<T> lazy(const Matrix<T>& M) noexcept {
+        return Expr::Leaf<T>{{}, M.data().data(), M.stride(), {M.rows(), M.cols()}};
+    }
+
+    template<floatTypes T>
+    Expr::Leaf<std::remove_const_t<T>> lazy(MatrixView<T> V) noexcept {
+        return Expr::Leaf<std::remove_const_t<T>>{{}, V.data(), V.stride(), {V.rows(), V.cols()}};
+    }
+} // Math
+
+#endif //NEUROINFORMATICS_MATRIXEXPRESSION_H
@@ -0,0 +1,82 @@
+//
+// Created by timwe on 11/20/2025.
+//
+
+#ifndef NEUROINFORMATICS_MATRIXVIEW_H
+#define NEUROINFORMATICS_MATRIXVIEW_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "BoundsCheck.h"
+#include "Concepts.h"
+
+/*
+ * Non-owning rows x cols window into a row-major buffer with its own stride, like std::span for Matrix.
+ * Slicing never copies, a view of a column range keeps the stride of its parent:
+ *
+ *      Math::MatrixView<const float> batch = X.view().colRange(first, batchSize);   // samples first .. first+batchSize
+ *      network.forward(batch);
+ *      Math::Matrix<float> copy(batch);                                             // materialise when needed
+ *
+ * MatrixView<const T> is the read-only form, every Matrix and MatrixView<T> converts to it implicitly, so functions
+ * taking one accept both. Unlike a Matrix the elements behind cols() up to stride() are not padding, they belong to
+ * the parent (or to nobody after the last row), kernels only touch the valid ones.
+ * A view must not outlive the matrix it points into, and resizing that matrix invalidates it.
+ */
+
+namespace Math {
+    template<storageTypes T>
+    class Matrix;
+
+    template<storageTypes T> // T may be const
+    class MatrixView {
+    private:
+        T* data_;
+        std::size_t rows_, cols_, stride_;
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        MatrixView() noexcept : data_(nullptr), rows_(0), cols_(0), stride_(0) {}
+        MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t stride) : data_(data), rows_(rows), cols_(cols), stride_(stride) {
+            if (stride_ < cols_)
+                throw std::invalid_argument("In MatrixView stride must be bigger or equal to columns");
+        }
+
+        MatrixView(Matrix<value_type>& M) noexcept requires (!std::is_const_v<T>)
+            : data_(M.data().data()), rows_(M.rows()), cols_(M.cols()), stride_(M.stride()) {}
+        MatrixView(const Matrix<value_type>& M) noexcept requires std::is_const_v<T>
+            : data_(M.data().data()), rows_(M.rows()), cols_(M.cols()), stride_(M.stride()) {}
+        template<class U> requires (std::is_const_v<T> && std::is_same_v<U, value_type>) // view -> const view
+        MatrixView(const MatrixView<U>& other) noexcept
+            : data_(other.data()), rows_(other.rows()), cols_(other.cols()), stride_(other.stride()) {}
+
+        // Checked or not depending on the build, see BoundsCheck.h; unchecked() never is
+        T& operator()(std::size_t r, std::size_t c) const noexcept(!boundsChecked) {
+            checkIndex(r, c, this->rows_, this->cols_, "In MatrixView::operator() r or c are out of bounds");
+            return this->data_[r * this->stride_ + c];
+        }
+        T& unchecked(std::size_t r, std::size_t c) const noexcept { return this->data_[r * this->stride_ + c]; }
+
+        [[nodiscard]] T* data() const noexcept { return this->data_; }
+        [[nodiscard]] std::size_t rows() const noexcept { return this->rows_; }
+        [[nodiscard]] std::size_t cols() const noexcept { return this->cols_; }
+        [[nodiscard]] std::size_t stride() const noexcept { return this->stride_; }
+        [[nodiscard]] std::size_t elementCount() const noexcept { return this->rows_ * this->cols_; }
+        [[nodiscard]] bool empty() const noexcept { return this->rows_ == 0 || this->cols_ == 0; }
+
+        // Sub-block of rows [row, row + rows) and columns [col, col + cols)
+        [[nodiscard]] MatrixView block(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const {
+            if (row + rows > this->rows_ || col + cols > this->cols_ || row + rows < row || col + cols < col)
+                throw std::out_of_range("In MatrixView::block() the block is out of bounds");
+
+            return MatrixView(this->data_ + row * this->stride_ + col, rows, cols, this->stride_);
+        }
+
+        [[nodiscard]] MatrixView rowRange(std::size_t first, std::size_t count) const { return this->block(first, 0, count, this->cols_); }
+        [[nodiscard]] MatrixView colRange(std::size_t first, std::size_t count) const { return this->block(0, first, this->rows_, count); }
+    };
+} // Math
+
+#endif //NEUROINFORMATICS_MATRIXVIEW_H
@@ -0,0 +1,79 @@
+//
+// Created by timwe on 11/23/2025.
+//
+
+#include "Precision.h"
+#include "Elementwise.h"
+#include "ThreadPool.h"
+
+#include <span>
+#include <stdexcept>
+
+namespace Math {
+    namespace {
+        // dst = convert(src) on the valid elements, block by block on the pool; the padding of dst is zeroed
+        template<storageTypes D, storageTypes S, class Convert>
+        void convertInto(Matrix<D>& dst, MatrixView<const S> src, Convert convert) {
+            if (dst.rows() != src.rows() || dst.cols() != src.cols())
+                dst = Matrix<D>(src.rows(), src.cols(), uninitialized, 0, dst.resource());
+
+            D* out = dst.data().data();
+            const std::size_t stride = dst.stride();
+            Kernels::forBlocks(Kernels::BlockGrid(src.rows(), src.cols()), [&](const Kernels::Block& b, std::size_t) {
+                for (std::size_t r = b.r0; r < b.r1; ++r) {
+                    const S* in = src.data() + r * src.stride();
+                    for (std::size_t c = b.c0; c < b.c1; ++c)
+                        out[r * stride + c] = convert(in[c]);
+                }
+            });
+            Kernels::zeroPadding(out, dst.rows(), dst.cols(), stride);
+        }
+    } // namespace
+
+    template<floatTypes T>
+    void narrowInto(Matrix<bfloat16>& dst, std::type_identity_t<MatrixView<const T>> src) {
+        convertInto(dst, src, [](T value) { return bfloat16(static_cast<float>(value)); });
+    }
+
+    template<floatTypes T>
+    void widenInto(Matrix<T>& dst, MatrixView<const bfloat16> src) {
+        convertInto(dst, src, [](bfloat16 value) { return static_cast<T>(static_cast<float>(value)); });
+    }
+
+    // One partial per block, added in block order (see BlockGrid)
+    template<floatTypes T>
+    T sum(MatrixView<const bfloat16> M) {
+        const Kernels::BlockGrid grid(M.rows(), M.cols());
+        const std::span<T> partials = Kernels::blockPartials<T>(grid);
+        Kernels::forBlocks(grid, [&](const Kernels::Block& b, std::size_t i) {
+            T partial = T{0};
+            for (std::size_t r = b.r0; r < b.r1; ++r) {
+                const bfloat16* row = M.data() + r * M.stride();
+                for (std::size_t c = b.c0; c < b.c1; ++c)
+                    partial += static_cast<T>(static_cast<float>(row[c]));
+            }
+            partials[i] = partial;
+        });
+
+        T result = T{0};
+        for (const T partial : partials)
+            result += partial;
+        return result;
+    }
+
+    template<floatTypes T>
+    T mean(MatrixView<const bfloat16> M) {
+        if (M.rows() == 0 || M.cols() == 0)
+            throw std::invalid_argument("In Math::mean() the matrix is empty");
+        return sum<T>(M) / static_cast<T>(M.rows() * M.cols());
+    }
+
+    template void narrowInto<float>(Matrix<bfloat16>&, MatrixView<const float>);
+    template void narrowInto<double>(Matrix<bfloat16>&, MatrixView<const double>);
+    template void widenInto<float>(Matrix<float>&, MatrixView<const bfloat16>);
+    template void widenInto<double>(Matrix<double>&, MatrixView<const bfloat16>);
+    template float sum<float>(MatrixView<const bfloat16>);
+    template double sum<double>(MatrixView<const bfloat16>);
+    template float mean<float>(MatrixView<const bfloat16>);
+    template double mean<double>(MatrixView<const bfloat16>);
+} // Math
@@ -0,0 +1,54 @@
+//
+// Created by timwe on 11/23/2025.
+//
+
+#ifndef NEUROINFORMATICS_PRECISION_H
+#define NEUROINFORMATICS_PRECISION_H
+
+#include "BFloat16.h"
+#include "Concepts.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+
+/*
+ * Mixed precision: Matrix<bfloat16> only stores, these move data between it and float / double and reduce it with a
+ * T accumulator. The products go through matMulInto (Matrix.h), which takes bfloat16 views for either operand and
+ * widens them while the gemm packs, so a bfloat16 operand costs half the memory traffic of a float one and nothing
+ * else.
+ *
+ *      narrowInto(dst, src)    dst (bfloat16) = src rounded to nearest even
+ *      widenInto(dst, src)     dst (T) = src, exact
+ *      sum<T>(M), mean<T>(M)   accumulated in T, same bits on any thread count
+ *
+ * dst is only reallocated if its rows/cols don't match, like mapInto.
+ */
+
+namespace Math {
+    enum class Precision {
+        Full, // everything in T
+        BFloat16 // weights and activation caches stored as bfloat16, computed and accumulated in T
+    };
+
+    template<floatTypes T>
+    void narrowInto(Matrix<bfloat16>& dst, std::type_identity_t<MatrixView<const T>> src);
+
+    template<floatTypes T>
+    void widenInto(Matrix<T>& dst, MatrixView<const bfloat16> src);
+
+    template<floatTypes T>
+    [[nodiscard]] T sum(MatrixView<const bfloat16> M);
+
+    template<floatTypes T>
+    [[nodiscard]] T mean(MatrixView<const bfloat16> M);
+
+    extern template void narrowInto<float>(Matrix<bfloat16>&, MatrixView<const float>);
+    extern template void narrowInto<double>(Matrix<bfloat16>&, MatrixView<const double>);
+    extern template void widenInto<float>(Matrix<float>&, MatrixView<const bfloat16>);
+    extern template void widenInto<double>(Matrix<double>&, MatrixView<const bfloat16>);
+    extern template float sum<float>(MatrixView<const bfloat16>);
+    extern template double sum<double>(MatrixView<const bfloat16>);
+    extern template float mean<float>(MatrixView<const bfloat16>);
+    extern template double mean<double>(MatrixView<const bfloat16>);
+} // Math
+
+#endif //NEUROINFORMATICS_PRECISION_H
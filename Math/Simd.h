@@ -0,0 +1,244 @@
+//
+// Created by timwe on 11/14/2025.
+//
+
+#ifndef NEUROINFORMATICS_SIMD_H
+#define NEUROINFORMATICS_SIMD_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include "Concepts.h"
+
+/*
+ * Thin wrapper around the vector registers the kernels use. Every kernel (GEMM micro kernel etc.) is written once
+ * against Vec<T, Isa> and instantiated for the ISA it gets compiled for.
+ * Generic uses the GCC/Clang vector extensions (16 byte, so SSE2 on x86 and NEON on ARM).
+ *
+ * Besides the arithmetic, every Vec has the few bit level helpers the polynomial math in VectorMath.h needs:
+ *      round(a)                nearest integer (ties don't matter)
+ *      pow2(n)                 2^n for integral n inside the normal exponent range
+ *      getexp(x), getmant(x)   x = getmant(x) * 2^getexp(x) with getmant in [1, 2), x positive and normal
+ *      selectLess(a, b, x, y)  a < b ? x : y per lane
+ *      opaque(a)               a, but -ffast-math can't re-associate across it (only needed by Generic, where the
+ *                              arithmetic are plain operators; the intrinsics are opaque builtins already)
+ */
+
+namespace Math::Simd {
+    struct Generic {};
+    struct AVX2 {};
+    struct AVX512 {};
+    struct AVX512VNNI {}; // AVX512 + the int8 dot product (vpdpbusd), only the int8 gemm has a kernel for it
+
+    // Best level the flags of the current translation unit allow. Generic in the normal (baseline) build, library code
+    // goes through Math/Dispatch.h instead of using this
+#if defined(__AVX512F__)
+    using NativeIsa = AVX512;
+#elif defined(__AVX2__) && defined(__FMA__)
+    using NativeIsa = AVX2;
+#else
+    using NativeIsa = Generic;
+#endif
+
+    template<floatTypes T, class Isa>
+    struct Vec;
+
+    template<class V>
+    V opaqueRegister(V a) noexcept {
+#if defined(__x86_64__) || defined(_M_X64)
+        __asm__("" : "+x"(a));
+#elif defined(__aarch64__)
+        __asm__("" : "+w"(a));
+#else
+        __asm__("" : "+m"(a));
+#endif
+        return a;
+    }
+
+    template<>
+    struct Vec<float, Generic> {
+        typedef float type __attribute__((vector_size(16)));
+        typedef int itype __attribute__((vector_size(16)));
+        static constexpr std::size_t width = 4;
+
+        static type zero() noexcept { return type{}; }
+        static type broadcast(float value) noexcept { return type{} + value; }
+        static type loadu(const float* p) noexcept { type v; std::memcpy(&v, p, sizeof(type)); return v; }
+        static void storeu(float* p, type v) noexcept { std::memcpy(p, &v, sizeof(type)); }
+        static type add(type a, type b) noexcept { return a + b; }
+        static type mul(type a, type b) noexcept { return a * b; }
+        static type fmadd(type a, type b, type c) noexcept { return a * b + c; } // a*b+c
+        static type sub(type a, type b) noexcept { return a - b; }
+        static type div(type a, type b) noexcept { return a / b; }
+        static type min(type a, type b) noexcept { return a < b ? a : b; }
+        static type max(type a, type b) noexcept { return a < b ? b : a; }
+        static type abs(type a) noexcept { return (type)((itype)a & 0x7fffffff); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return a < b ? x : y; }
+        static type round(type a) noexcept {
+            const type half = (type)(((itype)a & (int)0x80000000) | 0x3f000000); // copysign(0.5, a)
+            return __builtin_convertvector(__builtin_convertvector(a + half, itype), type);
+        }
+        static type pow2(type n) noexcept { return (type)((__builtin_convertvector(n, itype) + 127) << 23); }
+        static type getexp(type x) noexcept { return __builtin_convertvector((((itype)x >> 23) & 0xff) - 127, type); }
+        static type getmant(type x) noexcept { return (type)(((itype)x & 0x007fffff) | 0x3f800000); }
+        static type opaque(type a) noexcept { return opaqueRegister(a); }
+    };
+
+    template<>
+    struct Vec<double, Generic> {
+        typedef double type __attribute__((vector_size(16)));
+        typedef long long itype __attribute__((vector_size(16)));
+        static constexpr std::size_t width = 2;
+
+        static type zero() noexcept { return type{}; }
+        static type broadcast(double value) noexcept { return type{} + value; }
+        static type loadu(const double* p) noexcept { type v; std::memcpy(&v, p, sizeof(type)); return v; }
+        static void storeu(double* p, type v) noexcept { std::memcpy(p, &v, sizeof(type)); }
+        static type add(type a, type b) noexcept { return a + b; }
+        static type mul(type a, type b) noexcept { return a * b; }
+        static type fmadd(type a, type b, type c) noexcept { return a * b + c; }
+        static type sub(type a, type b) noexcept { return a - b; }
+        static type div(type a, type b) noexcept { return a / b; }
+        static type min(type a, type b) noexcept { return a < b ? a : b; }
+        static type max(type a, type b) noexcept { return a < b ? b : a; }
+        static type abs(type a) noexcept { return (type)((itype)a & 0x7fffffffffffffffLL); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return a < b ? x : y; }
+        static type round(type a) noexcept {
+            const type half = (type)(((itype)a & (long long)0x8000000000000000ULL) | 0x3fe0000000000000LL);
+            return __builtin_convertvector(__builtin_convertvector(a + half, itype), type);
+        }
+        static type pow2(type n) noexcept { return (type)((__builtin_convertvector(n, itype) + 1023) << 52); }
+        static type getexp(type x) noexcept { return __builtin_convertvector((((itype)x >> 52) & 0x7ff) - 1023, type); }
+        static type getmant(type x) noexcept { return (type)(((itype)x & 0x000fffffffffffffLL) | 0x3ff0000000000000LL); }
+        static type opaque(type a) noexcept { return opaqueRegister(a); }
+    };
+
+#if defined(__AVX2__) && defined(__FMA__)
+    template<>
+    struct Vec<float, AVX2> {
+        using type = __m256;
+        static constexpr std::size_t width = 8;
+
+        static type zero() noexcept { return _mm256_setzero_ps(); }
+        static type broadcast(float value) noexcept { return _mm256_set1_ps(value); }
+        static type loadu(const float* p) noexcept { return _mm256_loadu_ps(p); }
+        static void storeu(float* p, type v) noexcept { _mm256_storeu_ps(p, v); }
+        static type add(type a, type b) noexcept { return _mm256_add_ps(a, b); }
+        static type mul(type a, type b) noexcept { return _mm256_mul_ps(a, b); }
+        static type fmadd(type a, type b, type c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+        static type sub(type a, type b) noexcept { return _mm256_sub_ps(a, b); }
+        static type div(type a, type b) noexcept { return _mm256_div_ps(a, b); }
+        static type min(type a, type b) noexcept { return _mm256_min_ps(a, b); }
+        static type max(type a, type b) noexcept { return _mm256_max_ps(a, b); }
+        static type abs(type a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+        static type round(type a) noexcept { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static type pow2(type n) noexcept {
+            return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+        }
+        static type getexp(type x) noexcept {
+            return _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(127)));
+        }
+        static type getmant(type x) noexcept {
+            const __m256i bits = _mm256_and_si256(_mm256_castps_si256(x), _mm256_set1_epi32(0x007fffff));
+            return _mm256_castsi256_ps(_mm256_or_si256(bits, _mm256_set1_epi32(0x3f800000)));
+        }
+        static type opaque(type a) noexcept { return a; }
+    };
+
+    template<>
+    struct Vec<double, AVX2> {
+        using type = __m256d;
+        static constexpr std::size_t width = 4;
+
+        static type zero() noexcept { return _mm256_setzero_pd(); }
+        static type broadcast(double value) noexcept { return _mm256_set1_pd(value); }
+        static type loadu(const double* p) noexcept { return _mm256_loadu_pd(p); }
+        static void storeu(double* p, type v) noexcept { _mm256_storeu_pd(p, v); }
+        static type add(type a, type b) noexcept { return _mm256_add_pd(a, b); }
+        static type mul(type a, type b) noexcept { return _mm256_mul_pd(a, b); }
+        static type fmadd(type a, type b, type c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+        static type sub(type a, type b) noexcept { return _mm256_sub_pd(a, b); }
+        static type div(type a, type b) noexcept { return _mm256_div_pd(a, b); }
+        static type min(type a, type b) noexcept { return _mm256_min_pd(a, b); }
+        static type max(type a, type b) noexcept { return _mm256_max_pd(a, b); }
+        static type abs(type a) noexcept { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+        static type round(type a) noexcept { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        // AVX2 has no double <-> int64 conversion: adding 1.5 * 2^52 puts the (integral) n into the low mantissa bits
+        static type pow2(type n) noexcept {
+            const __m256i bits = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0)));
+            return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52));
+        }
+        // and the other way round: the biased exponent or'ed into the mantissa of 2^52 is 2^52 + e
+        static type getexp(type x) noexcept {
+            const __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(x), 52);
+            const __m256d biased = _mm256_castsi256_pd(_mm256_or_si256(e, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0))));
+            return _mm256_sub_pd(biased, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        }
+        static type getmant(type x) noexcept {
+            const __m256i bits = _mm256_and_si256(_mm256_castpd_si256(x), _mm256_set1_epi64x(0x000fffffffffffffLL));
+            return _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3ff0000000000000LL)));
+        }
+        static type opaque(type a) noexcept { return a; }
+    };
+#endif
+
+#if defined(__AVX512F__)
+    template<>
+    struct Vec<float, AVX512> {
+        using type = __m512;
+        static constexpr std::size_t width = 16;
+
+        static type zero() noexcept { return _mm512_setzero_ps(); }
+        static type broadcast(float value) noexcept { return _mm512_set1_ps(value); }
+        static type loadu(const float* p) noexcept { return _mm512_loadu_ps(p); }
+        static void storeu(float* p, type v) noexcept { _mm512_storeu_ps(p, v); }
+        static type add(type a, type b) noexcept { return _mm512_add_ps(a, b); }
+        static type mul(type a, type b) noexcept { return _mm512_mul_ps(a, b); }
+        static type fmadd(type a, type b, type c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+        static type sub(type a, type b) noexcept { return _mm512_sub_ps(a, b); }
+        static type div(type a, type b) noexcept { return _mm512_div_ps(a, b); }
+        static type min(type a, type b) noexcept { return _mm512_min_ps(a, b); }
+        static type max(type a, type b) noexcept { return _mm512_max_ps(a, b); }
+        static type abs(type a) noexcept { return _mm512_abs_ps(a); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x); }
+        static type round(type a) noexcept { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static type pow2(type n) noexcept { return _mm512_scalef_ps(_mm512_set1_ps(1.0f), n); }
+        static type getexp(type x) noexcept { return _mm512_getexp_ps(x); }
+        static type getmant(type x) noexcept { return _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src); }
+        static type opaque(type a) noexcept { return a; }
+    };
+
+    template<>
+    struct Vec<double, AVX512> {
+        using type = __m512d;
+        static constexpr std::size_t width = 8;
+
+        static type zero() noexcept { return _mm512_setzero_pd(); }
+        static type broadcast(double value) noexcept { return _mm512_set1_pd(value); }
+        static type loadu(const double* p) noexcept { return _mm512_loadu_pd(p); }
+        static void storeu(double* p, type v) noexcept { _mm512_storeu_pd(p, v); }
+        static type add(type a, type b) noexcept { return _mm512_add_pd(a, b); }
+        static type mul(type a, type b) noexcept { return _mm512_mul_pd(a, b); }
+        static type fmadd(type a, type b, type c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+        static type sub(type a, type b) noexcept { return _mm512_sub_pd(a, b); }
+        static type div(type a, type b) noexcept { return _mm512_div_pd(a, b); }
+        static type min(type a, type b) noexcept { return _mm512_min_pd(a, b); }
+        static type max(type a, type b) noexcept { return _mm512_max_pd(a, b); }
+        static type abs(type a) noexcept { return _mm512_abs_pd(a); }
+        static type selectLess(type a, type b, type x, type y) noexcept { return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), y, x); }
+        static type round(type a) noexcept { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static type pow2(type n) noexcept { return _mm512_scalef_pd(_mm512_set1_pd(1.0), n); }
+        static type getexp(type x) noexcept { return _mm512_getexp_pd(x); }
+        static type getmant(type x) noexcept { return _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src); }
+        static type opaque(type a) noexcept { return a; }
+    };
+#endif
+} // Math::Simd
+
+#endif //NEUROINFORMATICS_SIMD_H
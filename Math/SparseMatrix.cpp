@@ -0,0 +1,301 @@
+//
+// Created by timwe on 11/27/2025.
+//
+
+#include "SparseMatrix.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace Math {
+    namespace {
+        // Rows of the result in chunks of about grainSize multiply-adds, one pool task each
+        template<class F>
+        void forResultRows(std::size_t rows, std::size_t workPerRow, F&& f) {
+            const std::size_t grain = std::max<std::size_t>(1, Parallel::grainSize() / std::max<std::size_t>(1, workPerRow));
+            Parallel::forChunks(rows, grain, std::forward<F>(f));
+        }
+
+        // Shape and alias checks of the dense matMulInto, result is reallocated if its shape doesn't match and beta == 0
+        template<floatTypes T>
+        void prepareResult(Matrix<T>& result, std::size_t m, std::size_t n, const T* dense, T beta) {
+            const T* begin = result.data().data();
+            if (std::less_equal<>{}(begin, dense) && std::less<>{}(dense, begin + result.bufferSize()))
+                throw std::invalid_argument("In matMulInto() result can't alias one of the operands");
+
+            if (result.rows() != m || result.cols() != n) {
+                if (beta != T{0})
+                    throw std::invalid_argument("In matMulInto() result has the wrong shape to be scaled by beta");
+                result = Matrix<T>(m, n, uninitialized, 0, result.resource());
+            }
+        }
+
+        // row *= beta, beta == 0 overwrites whatever an uninitialised result had
+        template<floatTypes T>
+        void scaleRow(T* row, std::size_t n, T beta) {
+            if (beta == T{0})
+                std::fill(row, row + n, T{0});
+            else if (beta != T{1})
+                for (std::size_t j = 0; j < n; ++j)
+                    row[j] *= beta;
+        }
+    } // namespace
+
+    template<floatTypes T>
+    SparseMatrix<T>::SparseMatrix() noexcept : rows_(0), cols_(0) {}
+
+    template<floatTypes T>
+    SparseMatrix<T>::SparseMatrix(std::size_t rows, std::size_t cols) : rowStart_(rows + 1, 0), rows_(rows), cols_(cols) {
+        if (cols > std::size_t{std::numeric_limits<std::uint32_t>::max()} + 1)
+            throw std::invalid_argument("In SparseMatrix() too many columns for 32 bit indices");
+    }
+
+    template<floatTypes T>
+    SparseMatrix<T>::SparseMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> rowStart, std::vector<std::uint32_t> colIndex, std::vector<T> values)
+        : SparseMatrix(rows, cols) {
+        if (rowStart.size() != rows + 1 || rowStart.front() != 0 || rowStart.back() != colIndex.size() || colIndex.size() != values.size())
+            throw std::invalid_argument("In SparseMatrix() the CSR arrays don't fit together");
+
+        for (std::size_t r = 0; r < rows; ++r) {
+            if (rowStart[r] > rowStart[r + 1])
+                throw std::invalid_argument("In SparseMatrix() rowStart is not ascending");
+            for (std::size_t p = rowStart[r]; p < rowStart[r + 1]; ++p)
+                if (colIndex[p] >= cols || (p > rowStart[r] && colIndex[p] <= colIndex[p - 1]))
+                    throw std::invalid_argument("In SparseMatrix() column indices are out of bounds or not sorted");
+        }
+
+        this->rowStart_ = std::move(rowStart);
+        this->colIndex_ = std::move(colIndex);
+        this->values_ = std::move(values);
+    }
+
+    template<floatTypes T>
+    SparseMatrix<T>::SparseMatrix(MatrixView<const T> dense) : SparseMatrix(dense.rows(), dense.cols()) {
+        for (std::size_t r = 0; r < this->rows_; ++r) {
+            const T* row = dense.data() + r * dense.stride();
+            for (std::size_t c = 0; c < this->cols_; ++c)
+                if (row[c] != T{0}) {
+                    this->colIndex_.push_back(static_cast<std::uint32_t>(c));
+                    this->values_.push_back(row[c]);
+                }
+            this->rowStart_[r + 1] = this->colIndex_.size();
+        }
+    }
+
+    template<floatTypes T>
+    SparseMatrix<T> SparseMatrix<T>::fromTriplets(std::size_t rows, std::size_t cols, std::span<const Triplet<T>> triplets) {
+        SparseMatrix<T> result(rows, cols);
+        for (const auto& t : triplets) {
+            if (t.row >= rows || t.col >= cols)
+                throw std::out_of_range("In SparseMatrix::fromTriplets() a triplet is out of bounds");
+            ++result.rowStart_[t.row + 1];
+        }
+        std::partial_sum(result.rowStart_.begin(), result.rowStart_.end(), result.rowStart_.begin());
+
+        // Bucket by row, then sort every row by column and add up duplicates
+        std::vector<std::pair<std::uint32_t, T>> entries(triplets.size());
+        std::vector<std::size_t> next(result.rowStart_.begin(), result.rowStart_.end() - 1);
+        for (const auto& t : triplets)
+            entries[next[t.row]++] = {static_cast<std::uint32_t>(t.col), t.value};
+
+        result.colIndex_.reserve(entries.size());
+        result.values_.reserve(entries.size());
+        std::size_t begin = 0;
+        for (std::size_t r = 0; r < rows; ++r) {
+            const std::size_t end = result.rowStart_[r + 1];
+            std::sort(entries.begin() + static_cast<std::ptrdiff_t>(begin), entries.begin() + static_cast<std::ptrdiff_t>(end),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (std::size_t p = begin; p < end; ++p) {
+                if (p > begin && entries[p].first == result.colIndex_.back())
+                    result.values_.back() += entries[p].second;
+                else {
+                    result.colIndex_.push_back(entries[p].first);
+                    result.values_.push_back(entries[p].second);
+                }
+            }
+            begin = end;
+            result.rowStart_[r + 1] = result.colIndex_.size();
+        }
+        return result;
+    }
+
+    template<floatTypes T>
+    std::size_t SparseMatrix<T>::rows() const noexcept {
+        return this->rows_;
+    }
+
+    template<floatTypes T>
+    std::size_t SparseMatrix<T>::cols() const noexcept {
+        return this->cols_;
+    }
+
+    template<floatTypes T>
+    std::size_t SparseMatrix<T>::nonZeros() const noexcept {
+        return this->values_.size();
+    }
+
+    template<floatTypes T>
+    std::span<const std::size_t> SparseMatrix<T>::rowStart() const noexcept {
+        return this->rowStart_;
+    }
+
+    template<floatTypes T>
+    std::span<const std::uint32_t> SparseMatrix<T>::colIndex() const noexcept {
+        return this->colIndex_;
+    }
+
+    template<floatTypes T>
+    std::span<const T> SparseMatrix<T>::values() const noexcept {
+        return this->values_;
+    }
+
+    template<floatTypes T>
+    std::span<T> SparseMatrix<T>::values() noexcept {
+        return this->values_;
+    }
+
+    // Counting sort by column; rows are visited in order, so every row of the result comes out sorted
+    template<floatTypes T>
+    SparseMatrix<T> SparseMatrix<T>::transpose() const {
+        SparseMatrix<T> result(this->cols_, this->rows_);
+        for (const std::uint32_t c : this->colIndex_)
+            ++result.rowStart_[c + 1];
+        std::partial_sum(result.rowStart_.begin(), result.rowStart_.end(), result.rowStart_.begin());
+
+        result.colIndex_.resize(this->nonZeros());
+        result.values_.resize(this->nonZeros());
+        std::vector<std::size_t> next(result.rowStart_.begin(), result.rowStart_.end() - 1);
+        for (std::size_t r = 0; r < this->rows_; ++r)
+            for (std::size_t p = this->rowStart_[r]; p < this->rowStart_[r + 1]; ++p) {
+                const std::size_t q = next[this->colIndex_[p]]++;
+                result.colIndex_[q] = static_cast<std::uint32_t>(r);
+                result.values_[q] = this->values_[p];
+            }
+        return result;
+    }
+
+    template<floatTypes T>
+    SparseMatrix<T> SparseMatrix<T>::rowRange(std::size_t first, std::size_t count) const {
+        if (first + count > this->rows_)
+            throw std::out_of_range("In SparseMatrix::rowRange() the rows are out of bounds");
+
+        const std::size_t begin = this->rowStart_[first], end = this->rowStart_[first + count];
+        SparseMatrix<T> result(count, this->cols_);
+        for (std::size_t r = 0; r <= count; ++r)
+            result.rowStart_[r] = this->rowStart_[first + r] - begin;
+        result.colIndex_.assign(this->colIndex_.begin() + static_cast<std::ptrdiff_t>(begin), this->colIndex_.begin() + static_cast<std::ptrdiff_t>(end));
+        result.values_.assign(this->values_.begin() + static_cast<std::ptrdiff_t>(begin), this->values_.begin() + static_cast<std::ptrdiff_t>(end));
+        return result;
+    }
+
+    template<floatTypes T>
+    Matrix<T> SparseMatrix<T>::toDense() const {
+        Matrix<T> result(this->rows_, this->cols_);
+        T* data = result.data().data();
+        for (std::size_t r = 0; r < this->rows_; ++r)
+            for (std::size_t p = this->rowStart_[r]; p < this->rowStart_[r + 1]; ++p)
+                data[r * result.stride() + this->colIndex_[p]] = this->values_[p];
+        return result;
+    }
+
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, const SparseMatrix<T>& A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        if (transA == Gemm::Transpose::Yes) {
+            matMulInto(result, A.transpose(), B, Gemm::Transpose::No, transB, alpha, beta);
+            return;
+        }
+
+        const bool bTransposed = transB == Gemm::Transpose::Yes;
+        const std::size_t m = A.rows(), n = bTransposed ? B.rows() : B.cols();
+        if (A.cols() != (bTransposed ? B.cols() : B.rows()))
+            throw std::invalid_argument("In matMulInto() incompatible matrix sizes");
+        prepareResult(result, m, n, B.data(), beta);
+
+        const auto rowStart = A.rowStart();
+        const auto colIndex = A.colIndex();
+        const auto values = A.values();
+        T* out = result.data().data();
+        const std::size_t ldc = result.stride(), ldb = B.stride();
+        const T* b = B.data();
+
+        forResultRows(m, (A.nonZeros() / std::max<std::size_t>(1, m) + 1) * n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                T* c = out + i * ldc;
+                scaleRow(c, n, beta);
+                if (!bTransposed) { // c += (alpha * a_ik) * row k of B, contiguous
+                    for (std::size_t p = rowStart[i]; p < rowStart[i + 1]; ++p) {
+                        const T v = alpha * values[p];
+                        const T* bRow = b + colIndex[p] * ldb;
+                        for (std::size_t j = 0; j < n; ++j)
+                            c[j] += v * bRow[j];
+                    }
+                } else { // c_ij += alpha * sparse row i . row j of B, gathered
+                    for (std::size_t j = 0; j < n; ++j) {
+                        const T* bRow = b + j * ldb;
+                        T sum = T{0};
+                        for (std::size_t p = rowStart[i]; p < rowStart[i + 1]; ++p)
+                            sum += values[p] * bRow[colIndex[p]];
+                        c[j] += alpha * sum;
+                    }
+                }
+            }
+        });
+    }
+
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, const SparseMatrix<T>& B,
+                    Gemm::Transpose transA, Gemm::Transpose transB, std::type_identity_t<T> alpha, std::type_identity_t<T> beta) {
+        const bool aTransposed = transA == Gemm::Transpose::Yes, bTransposed = transB == Gemm::Transpose::Yes;
+        const std::size_t m = aTransposed ? A.cols() : A.rows(), k = aTransposed ? A.rows() : A.cols();
+        const std::size_t n = bTransposed ? B.rows() : B.cols();
+        if (k != (bTransposed ? B.cols() : B.rows()))
+            throw std::invalid_argument("In matMulInto() incompatible matrix sizes");
+        prepareResult(result, m, n, A.data(), beta);
+
+        const auto rowStart = B.rowStart();
+        const auto colIndex = B.colIndex();
+        const auto values = B.values();
+        T* out = result.data().data();
+        const std::size_t ldc = result.stride(), lda = A.stride();
+        const T* a = A.data();
+        // op(A)_ik
+        const std::size_t rowStep = aTransposed ? 1 : lda, colStep = aTransposed ? lda : 1;
+
+        forResultRows(m, B.nonZeros() + k, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                T* c = out + i * ldc;
+                const T* aRow = a + i * rowStep;
+                scaleRow(c, n, beta);
+                if (!bTransposed) { // c += (alpha * a_ik) * sparse row k, scattered; zeros of A skip the row
+                    for (std::size_t kk = 0; kk < k; ++kk) {
+                        const T d = aRow[kk * colStep];
+                        if (d == T{0})
+                            continue;
+                        const T v = alpha * d;
+                        for (std::size_t p = rowStart[kk]; p < rowStart[kk + 1]; ++p)
+                            c[colIndex[p]] += v * values[p];
+                    }
+                } else { // c_ij += alpha * row i of op(A) . sparse row j, gathered
+                    for (std::size_t j = 0; j < n; ++j) {
+                        T sum = T{0};
+                        for (std::size_t p = rowStart[j]; p < rowStart[j + 1]; ++p)
+                            sum += aRow[colIndex[p] * colStep] * values[p];
+                        c[j] += alpha * sum;
+                    }
+                }
+            }
+        });
+    }
+
+    template class SparseMatrix<float>;
+    template class SparseMatrix<double>;
+    template void matMulInto<float>(Matrix<float>&, const SparseMatrix<float>&, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<double>(Matrix<double>&, const SparseMatrix<double>&, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, const SparseMatrix<float>&, Gemm::Transpose, Gemm::Transpose, float, float);
+    template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, const SparseMatrix<double>&, Gemm::Transpose, Gemm::Transpose, double, double);
+} // Math
@@ -0,0 +1,91 @@
+//
+// Created by timwe on 11/27/2025.
+//
+
+#ifndef NEUROINFORMATICS_SPARSEMATRIX_H
+#define NEUROINFORMATICS_SPARSEMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Concepts.h"
+#include "Gemm.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+
+/*
+ * Compressed sparse row matrix for inputs that are almost all zeros (one-hot blocks, bag of words). Row r has the
+ * nonzeros [rowStart[r], rowStart[r + 1]) of colIndex / values, sorted by column. transpose() builds the CSR of the
+ * transpose, which is the CSC of the matrix, in O(nonzeros).
+ *
+ *      SparseMatrix<float> X(dense.view());                    keeps the nonzeros of a dense matrix
+ *      auto X = SparseMatrix<float>::fromTriplets(r, c, t);    (row, col, value) in any order, duplicates are added
+ *      matMulInto(Z, W, X);                                    Z = W * X, costs rows(W) * nonZeros(X) multiply-adds
+ *
+ * Shapes follow the Layout of the dense matrix it stands for, so featureCount / sampleCount work on it (Layout.h).
+ * DenseLayer::forward takes one as the input of the first layer.
+ */
+
+namespace Math {
+    template<floatTypes T>
+    struct Triplet {
+        std::size_t row, col;
+        T value;
+    };
+
+    template<floatTypes T>
+    class SparseMatrix {
+    private:
+        std::vector<std::size_t> rowStart_; // rows_ + 1 offsets into colIndex_ / values_
+        std::vector<std::uint32_t> colIndex_; // sorted within a row, 32 bit to halve the index traffic
+        std::vector<T> values_;
+        std::size_t rows_, cols_;
+
+    public:
+        SparseMatrix() noexcept; // 0 x 0
+        SparseMatrix(std::size_t rows, std::size_t cols); // all zero
+        // Takes the CSR arrays as they are, throws std::invalid_argument if they aren't consistent or not sorted
+        SparseMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> rowStart, std::vector<std::uint32_t> colIndex, std::vector<T> values);
+        explicit SparseMatrix(MatrixView<const T> dense); // every element != 0
+
+        [[nodiscard]] static SparseMatrix fromTriplets(std::size_t rows, std::size_t cols, std::span<const Triplet<T>> triplets);
+
+        [[nodiscard]] std::size_t rows() const noexcept;
+        [[nodiscard]] std::size_t cols() const noexcept;
+        [[nodiscard]] std::size_t nonZeros() const noexcept;
+        [[nodiscard]] std::span<const std::size_t> rowStart() const noexcept;
+        [[nodiscard]] std::span<const std::uint32_t> colIndex() const noexcept;
+        [[nodiscard]] std::span<const T> values() const noexcept;
+        [[nodiscard]] std::span<T> values() noexcept; // the pattern is fixed, the values can change (e.g. scaling)
+
+        [[nodiscard]] SparseMatrix transpose() const; // CSR of the transpose = CSC of this
+        [[nodiscard]] SparseMatrix rowRange(std::size_t first, std::size_t count) const; // copy of rows [first, first + count)
+        [[nodiscard]] Matrix<T> toDense() const;
+    };
+
+    // result = alpha * op(A) * op(B) + beta * result with one sparse operand; work is proportional to the nonzeros
+    // times the other dimension of the dense operand, never to the full inner dimension. A transposed sparse A is
+    // transposed (O(nonzeros)) first, every other combination reads the operands as they are. Same reallocation and
+    // aliasing rules as the dense matMulInto (Matrix.h)
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, const SparseMatrix<T>& A, std::type_identity_t<MatrixView<const T>> B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    template<floatTypes T>
+    void matMulInto(Matrix<T>& result, std::type_identity_t<MatrixView<const T>> A, const SparseMatrix<T>& B,
+                    Gemm::Transpose transA = Gemm::Transpose::No, Gemm::Transpose transB = Gemm::Transpose::No,
+                    std::type_identity_t<T> alpha = T{1}, std::type_identity_t<T> beta = T{0});
+
+    extern template class SparseMatrix<float>;
+    extern template class SparseMatrix<double>;
+    extern template void matMulInto<float>(Matrix<float>&, const SparseMatrix<float>&, MatrixView<const float>, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<double>(Matrix<double>&, const SparseMatrix<double>&, MatrixView<const double>, Gemm::Transpose, Gemm::Transpose, double, double);
+    extern template void matMulInto<float>(Matrix<float>&, MatrixView<const float>, const SparseMatrix<float>&, Gemm::Transpose, Gemm::Transpose, float, float);
+    extern template void matMulInto<double>(Matrix<double>&, MatrixView<const double>, const SparseMatrix<double>&, Gemm::Transpose, Gemm::Transpose, double, double);
+} // Math
+
+#endif //NEUROINFORMATICS_SPARSEMATRIX_H
@@ -0,0 +1,111 @@
+//
+// Created by timwe on 11/25/2025.
+//
+
+#include "Statistics.h"
+#include "Dispatch.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Math {
+    namespace {
+        // Chunks of whole rows (or columns) with about grainSize elements each
+        std::size_t linesPerChunk(std::size_t length) {
+            return std::max<std::size_t>(1, Parallel::grainSize() / std::max<std::size_t>(1, length));
+        }
+
+        template<floatTypes T>
+        T sampleVariance(T m2, std::size_t count) {
+            return count > 1 ? m2 / static_cast<T>(count - 1) : T{0};
+        }
+    } // namespace
+
+    template<floatTypes T>
+    std::vector<RowStatistics<T>> rowStatistics(MatrixView<const T> M) {
+        const std::size_t cols = M.cols();
+        std::vector<RowStatistics<T>> result(M.rows(), RowStatistics<T>{cols, T{0}, T{0}, T{0}, T{0}});
+        if (cols == 0)
+            return result;
+
+        const auto& kernels = Dispatch::kernels<T>();
+        Parallel::forChunks(M.rows(), linesPerChunk(cols), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r) {
+                T moments[4];
+                kernels.rowMoments(M.data() + r * M.stride(), cols, moments);
+                result[r] = {cols, moments[0], sampleVariance(moments[1], cols), moments[2], moments[3]};
+            }
+        });
+        return result;
+    }
+
+    // Welford over the rows, the update is the same for every column so the inner loop vectorises
+    template<floatTypes T>
+    std::vector<RowStatistics<T>> columnStatistics(MatrixView<const T> M) {
+        const std::size_t rows = M.rows(), cols = M.cols();
+        std::vector<RowStatistics<T>> result(cols, RowStatistics<T>{rows, T{0}, T{0}, T{0}, T{0}});
+        if (rows == 0)
+            return result;
+
+        std::vector<T> mean(cols), m2(cols, T{0}), min(cols), max(cols);
+        // Column ranges of at least a cache line per task, every range walks all rows
+        const std::size_t width = std::max<std::size_t>(64, linesPerChunk(rows) / 64 * 64);
+        Parallel::forChunks(cols, width, [&](std::size_t begin, std::size_t end) {
+            const T* first = M.data();
+            for (std::size_t c = begin; c < end; ++c)
+                mean[c] = min[c] = max[c] = first[c];
+
+            for (std::size_t r = 1; r < rows; ++r) {
+                const T* row = M.data() + r * M.stride();
+                const T inv = T{1} / static_cast<T>(r + 1);
+                for (std::size_t c = begin; c < end; ++c) {
+                    const T x = row[c], delta = x - mean[c];
+                    mean[c] += delta * inv;
+                    m2[c] += delta * (x - mean[c]);
+                    min[c] = x < min[c] ? x : min[c];
+                    max[c] = x > max[c] ? x : max[c];
+                }
+            }
+
+            for (std::size_t c = begin; c < end; ++c)
+                result[c] = {rows, mean[c], sampleVariance(m2[c], rows), min[c], max[c]};
+        });
+        return result;
+    }
+
+    template<floatTypes T>
+    Matrix<T> rowQuantiles(MatrixView<const T> M, std::span<const T> q) {
+        for (const T p : q)
+            if (!(p >= T{0} && p <= T{1}))
+                throw std::invalid_argument("In Math::rowQuantiles() q has to be in [0, 1]");
+        if (M.cols() == 0 && M.rows() > 0 && !q.empty())
+            throw std::invalid_argument("In Math::rowQuantiles() the rows are empty");
+
+        Matrix<T> result(M.rows(), q.size());
+        T* out = result.data().data();
+        const std::size_t cols = M.cols(), outStride = result.stride();
+        Parallel::forChunks(M.rows(), linesPerChunk(cols), [&](std::size_t begin, std::size_t end) {
+            std::vector<T> sorted(cols);
+            for (std::size_t r = begin; r < end; ++r) {
+                const T* row = M.data() + r * M.stride();
+                std::copy(row, row + cols, sorted.begin());
+                std::sort(sorted.begin(), sorted.end());
+                for (std::size_t i = 0; i < q.size(); ++i) {
+                    const T position = q[i] * static_cast<T>(cols - 1);
+                    const auto lower = static_cast<std::size_t>(position);
+                    const std::size_t upper = std::min(lower + 1, cols - 1);
+                    out[r * outStride + i] = sorted[lower] + (position - static_cast<T>(lower)) * (sorted[upper] - sorted[lower]);
+                }
+            }
+        });
+        return result;
+    }
+
+    template std::vector<RowStatistics<float>> rowStatistics<float>(MatrixView<const float>);
+    template std::vector<RowStatistics<double>> rowStatistics<double>(MatrixView<const double>);
+    template std::vector<RowStatistics<float>> columnStatistics<float>(MatrixView<const float>);
+    template std::vector<RowStatistics<double>> columnStatistics<double>(MatrixView<const double>);
+    template Matrix<float> rowQuantiles<float>(MatrixView<const float>, std::span<const float>);
+    template Matrix<double> rowQuantiles<double>(MatrixView<const double>, std::span<const double>);
+} // Math
@@ -0,0 +1,67 @@
+//
+// Created by timwe on 11/25/2025.
+//
+
+#ifndef NEUROINFORMATICS_STATISTICS_H
+#define NEUROINFORMATICS_STATISTICS_H
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Concepts.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+
+/*
+ * Per row / per column statistics in one pass over the data.
+ *
+ *      rowStatistics(M)            one entry per row: SIMD kernel per row (Dispatch.h), rows in parallel
+ *      columnStatistics(M)         one entry per column, still read row by row (a vectorised Welford update over
+ *                                  the columns), for the features of a sample-major matrix
+ *      rowQuantiles(M, q)          rows x q.size(), linearly interpolated between the order statistics (numpy default)
+ *
+ * Features are rows of a feature-major matrix and columns of a sample-major one (Layout.h). The variance is the sample
+ * variance (n - 1) like stdDevOfRow, 0 for a single element. Every entry only depends on its own row / column, so the
+ * result is the same for any thread count.
+ */
+
+namespace Math {
+    template<floatTypes T>
+    struct RowStatistics {
+        std::size_t count;
+        T mean, variance, min, max;
+
+        [[nodiscard]] T stdDev() const noexcept { return std::sqrt(this->variance); }
+    };
+
+    template<floatTypes T>
+    [[nodiscard]] std::vector<RowStatistics<T>> rowStatistics(MatrixView<const T> M);
+
+    template<floatTypes T>
+    [[nodiscard]] std::vector<RowStatistics<T>> columnStatistics(MatrixView<const T> M);
+
+    template<floatTypes T>
+    [[nodiscard]] Matrix<T> rowQuantiles(MatrixView<const T> M, std::span<const T> q); // q in [0, 1]
+
+    // The same taking a Matrix (the view parameters don't deduce T from one)
+    template<floatTypes T>
+    [[nodiscard]] std::vector<RowStatistics<T>> rowStatistics(const Matrix<T>& M) { return rowStatistics(M.view()); }
+
+    template<floatTypes T>
+    [[nodiscard]] std::vector<RowStatistics<T>> columnStatistics(const Matrix<T>& M) { return columnStatistics(M.view()); }
+
+    template<floatTypes T>
+    [[nodiscard]] Matrix<T> rowQuantiles(const Matrix<T>& M, std::span<const std::type_identity_t<T>> q) { return rowQuantiles(M.view(), q); }
+
+    extern template std::vector<RowStatistics<float>> rowStatistics<float>(MatrixView<const float>);
+    extern template std::vector<RowStatistics<double>> rowStatistics<double>(MatrixView<const double>);
+    extern template std::vector<RowStatistics<float>> columnStatistics<float>(MatrixView<const float>);
+    extern template std::vector<RowStatistics<double>> columnStatistics<double>(MatrixView<const double>);
+    extern template Matrix<float> rowQuantiles<float>(MatrixView<const float>, std::span<const float>);
+    extern template Matrix<double> rowQuantiles<double>(MatrixView<const double>, std::span<const double>);
+} // Math
+
+#endif //NEUROINFORMATICS_STATISTICS_H
@@ -0,0 +1,176 @@
+//
+// Created by timwe on 11/22/2025.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Math::Parallel {
+    namespace {
+        thread_local bool insideJob = false;
+
+        // NEUROINFORMATICS_THREADS if it is set, the core count otherwise
+        std::size_t defaultThreadCount() {
+            const char* value = std::getenv("NEUROINFORMATICS_THREADS");
+            if (value != nullptr && *value != '\0') {
+                char* end = nullptr;
+                const unsigned long long count = std::strtoull(value, &end, 10);
+                if (*end == '\0' && count > 0)
+                    return static_cast<std::size_t>(count);
+                std::cerr << "NEUROINFORMATICS_THREADS=" << value << " is not a positive number, using the core count\n";
+            }
+
+            const unsigned int cores = std::thread::hardware_concurrency();
+            return cores == 0 ? 1 : cores;
+        }
+
+        class Pool {
+        private:
+            std::mutex jobMutex; // owned by the thread whose job is running, also guards workers
+            std::mutex mutex; // guards the job description below
+            std::condition_variable wake, finished;
+            std::vector<std::thread> workers;
+            std::atomic<std::size_t> threads;
+
+            Task task = nullptr;
+            void* context = nullptr;
+            std::size_t tasks = 0;
+            std::size_t participants = 0; // workers [0, participants) join the current job
+            std::size_t pending = 0; // participants that are not done yet
+            std::size_t generation = 0; // bumped for every job
+            bool stopping = false;
+            std::atomic<std::size_t> next{0}; // next unclaimed task index
+
+            void work() {
+                for (std::size_t i; (i = this->next.fetch_add(1, std::memory_order_relaxed)) < this->tasks;)
+                    this->task(this->context, i);
+            }
+
+            // seen is the generation at spawn time, so a worker that starts late still joins the job it was spawned for
+            void workerLoop(std::size_t index, std::size_t seen) {
+                insideJob = true;
+                std::unique_lock lock(this->mutex);
+                while (true) {
+                    this->wake.wait(lock, [&] { return this->stopping || this->generation != seen; });
+                    if (this->stopping)
+                        return;
+
+                    seen = this->generation;
+                    if (index >= this->participants)
+                        continue;
+
+                    lock.unlock();
+                    this->work();
+                    lock.lock();
+                    if (--this->pending == 0)
+                        this->finished.notify_one();
+                }
+            }
+
+            void stopWorkers() { // jobMutex is held
+                {
+                    std::lock_guard lock(this->mutex);
+                    this->stopping = true;
+                }
+                this->wake.notify_all();
+                for (auto& worker : this->workers)
+                    worker.join();
+                this->workers.clear();
+                this->stopping = false;
+            }
+
+        public:
+            Pool() : threads(defaultThreadCount()) {}
+
+            ~Pool() {
+                std::lock_guard job(this->jobMutex);
+                this->stopWorkers();
+            }
+
+            std::size_t threadCount() const noexcept {
+                return this->threads.load(std::memory_order_relaxed);
+            }
+
+            std::size_t setThreadCount(std::size_t count) {
+                std::lock_guard job(this->jobMutex);
+                this->stopWorkers(); // restarted lazily with the new count
+                this->threads.store(count == 0 ? defaultThreadCount() : count, std::memory_order_relaxed);
+                return this->threadCount();
+            }
+
+            void run(std::size_t count, Task _task, void* _context) {
+                std::unique_lock job(this->jobMutex, std::try_to_lock);
+                if (count <= 1 || insideJob || !job.owns_lock() || this->threadCount() == 1) {
+                    for (std::size_t i = 0; i < count; ++i)
+                        _task(_context, i);
+                    return;
+                }
+
+                while (this->workers.size() + 1 < this->threadCount()) {
+                    const std::size_t index = this->workers.size();
+                    this->workers.emplace_back(&Pool::workerLoop, this, index, this->generation);
+                }
+
+                {
+                    std::lock_guard lock(this->mutex);
+                    this->task = _task;
+                    this->context = _context;
+                    this->tasks = count;
+                    this->participants = std::min(count - 1, this->workers.size());
+                    this->pending = this->participants;
+                    this->next.store(0, std::memory_order_relaxed);
+                    ++this->generation;
+                }
+                this->wake.notify_all();
+
+                insideJob = true; // nested jobs of the tasks run serially
+                this->work();
+                insideJob = false;
+
+                std::unique_lock lock(this->mutex);
+                this->finished.wait(lock, [&] { return this->pending == 0; });
+            }
+        };
+
+        // function static, like the default memory resource
+        Pool& pool() {
+            static Pool instance;
+            return instance;
+        }
+
+        std::atomic<std::size_t> grain{defaultGrainSize};
+    } // namespace
+
+    std::size_t threadCount() noexcept {
+        return pool().threadCount();
+    }
+
+    std::size_t setThreadCount(std::size_t count) {
+        return pool().setThreadCount(count);
+    }
+
+    bool inParallelRegion() noexcept {
+        return insideJob;
+    }
+
+    void run(std::size_t tasks, Task task, void* context) {
+        pool().run(tasks, task, context);
+    }
+
+    std::size_t grainSize() noexcept {
+        return grain.load(std::memory_order_relaxed);
+    }
+
+    std::size_t setGrainSize(std::size_t elements) noexcept {
+        const std::size_t rounded = elements == 0 ? defaultGrainSize : (elements + 63) / 64 * 64;
+        return grain.exchange(rounded, std::memory_order_relaxed);
+    }
+} // Math::Parallel
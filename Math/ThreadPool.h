@@ -0,0 +1,63 @@
+//
+// Created by timwe on 11/22/2025.
+//
+
+#ifndef NEUROINFORMATICS_THREADPOOL_H
+#define NEUROINFORMATICS_THREADPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * Persistent worker pool for the parallel kernels. The workers are started the first time a job needs them and sleep
+ * on a condition variable between jobs, so a parallel gemm only pays for a wake up, not for thread creation.
+ *
+ *      NEUROINFORMATICS_THREADS=n                  threads a job may use (calling thread included), default is
+ *                                                  std::thread::hardware_concurrency()
+ *      Math::Parallel::setThreadCount(n)           same from code, 0 goes back to the default
+ *      Math::Parallel::setGrainSize(n)             elements per task of the element-wise kernels and reductions
+ *
+ * A job runs serially on the calling thread if it is started from inside a pool task or while the pool is busy with
+ * the job of another thread, so code that is already parallel can call into Math without oversubscribing the cores.
+ */
+
+namespace Math::Parallel {
+    [[nodiscard]] std::size_t threadCount() noexcept; // threads a job can use, >= 1
+    std::size_t setThreadCount(std::size_t count); // returns the count that is used; not while jobs are running
+    [[nodiscard]] bool inParallelRegion() noexcept; // true on pool workers and on a thread waiting for its job
+
+    using Task = void (*)(void* context, std::size_t index);
+
+    // Runs task(context, i) for every i in [0, tasks) on the pool and the calling thread, returns once all are done.
+    // Tasks must not throw.
+    void run(std::size_t tasks, Task task, void* context);
+
+    template<class F>
+    void parallelFor(std::size_t tasks, F&& f) {
+        using Fn = std::remove_reference_t<F>;
+        run(tasks, [](void* context, std::size_t i) { (*static_cast<Fn*>(context))(i); }, const_cast<void*>(static_cast<const void*>(&f)));
+    }
+
+    // Default keeps the wake up of the pool well below the time a task takes, a multiple of 64 so chunks of a flat
+    // buffer start on a cache line
+    inline constexpr std::size_t defaultGrainSize = std::size_t{1} << 15;
+
+    [[nodiscard]] std::size_t grainSize() noexcept;
+    std::size_t setGrainSize(std::size_t elements) noexcept; // rounded up to a multiple of 64, 0 goes back to the default; returns the previous one
+
+    // f(begin, end) on consecutive chunks of [0, n) with grain elements each (the last one shorter), in parallel if
+    // there is more than one. The chunks only depend on n and grain, never on the thread count
+    template<class F>
+    void forChunks(std::size_t n, std::size_t grain, F&& f) {
+        const std::size_t chunks = (n + grain - 1) / grain;
+        if (chunks <= 1) {
+            if (n > 0)
+                f(std::size_t{0}, n);
+            return;
+        }
+        parallelFor(chunks, [&](std::size_t i) { f(i * grain, std::min(n, (i + 1) * grain)); });
+    }
+} // Math::Parallel
+
+#endif //NEUROINFORMATICS_THREADPOOL_H
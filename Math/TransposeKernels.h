@@ -0,0 +1,190 @@
+//
+// Created by timwe on 11/26/2025.
+//
+
+#ifndef NEUROINFORMATICS_TRANSPOSEKERNELS_H
+#define NEUROINFORMATICS_TRANSPOSEKERNELS_H
+
+#include <cstddef>
+
+#include "Concepts.h"
+#include "Simd.h"
+
+/*
+ * Leaves of the recursive transposes in Matrix.cpp: blocks of at most a few tiles per side. A full W x W tile is loaded
+ * into W registers, transposed with shuffles and stored as W rows, so both sides are read / written a vector at a
+ * time. Edges that don't fill a tile are copied element by element.
+ *
+ *      AVX2, AVX512    8 x 8 float, 4 x 4 double (ymm shuffles)
+ *      Generic         4 x 4 through a local array
+ *
+ * Only included by Math/IsaKernels.h, the rules of GemmKernels.h apply (templated on the Isa tag, no standard library calls).
+ */
+
+namespace Math::Dispatch::Kernels {
+    template<floatTypes T, class Isa>
+    struct TransposeTile {
+        static constexpr std::size_t W = 4;
+
+        static void load(const T* src, std::size_t stride, T (&tile)[W][W]) noexcept {
+            for (std::size_t r = 0; r < W; ++r)
+                for (std::size_t c = 0; c < W; ++c)
+                    tile[c][r] = src[r * stride + c];
+        }
+
+        static void store(T* dst, std::size_t stride, const T (&tile)[W][W]) noexcept {
+            for (std::size_t r = 0; r < W; ++r)
+                for (std::size_t c = 0; c < W; ++c)
+                    dst[r * stride + c] = tile[r][c];
+        }
+
+        static void transpose(const T* src, std::size_t srcStride, T* dst, std::size_t dstStride) noexcept {
+            T tile[W][W];
+            load(src, srcStride, tile);
+            store(dst, dstStride, tile);
+        }
+
+        // a <- b^T and b <- a^T, a == b transposes the tile in place
+        static void swap(T* a, T* b, std::size_t stride) noexcept {
+            T ta[W][W], tb[W][W];
+            load(a, stride, ta);
+            load(b, stride, tb);
+            store(b, stride, ta);
+            store(a, stride, tb);
+        }
+    };
+
+#if defined(__AVX2__)
+    template<>
+    struct TransposeTile<float, Simd::AVX2> {
+        static constexpr std::size_t W = 8;
+
+        static void inRegisters(__m256 (&r)[8]) noexcept {
+            const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+            const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+            const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+            const __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xee);
+            const __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xee);
+            const __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xee);
+            const __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xee);
+            r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+            r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+            r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+            r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+            r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+            r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+            r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+            r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+        }
+
+        static void load(const float* src, std::size_t stride, __m256 (&r)[8]) noexcept {
+            for (std::size_t i = 0; i < 8; ++i)
+                r[i] = _mm256_loadu_ps(src + i * stride);
+            inRegisters(r);
+        }
+
+        static void store(float* dst, std::size_t stride, const __m256 (&r)[8]) noexcept {
+            for (std::size_t i = 0; i < 8; ++i)
+                _mm256_storeu_ps(dst + i * stride, r[i]);
+        }
+
+        static void transpose(const float* src, std::size_t srcStride, float* dst, std::size_t dstStride) noexcept {
+            __m256 r[8];
+            load(src, srcStride, r);
+            store(dst, dstStride, r);
+        }
+
+        static void swap(float* a, float* b, std::size_t stride) noexcept {
+            __m256 ra[8], rb[8];
+            load(a, stride, ra);
+            load(b, stride, rb);
+            store(b, stride, ra);
+            store(a, stride, rb);
+        }
+    };
+
+    template<>
+    struct TransposeTile<double, Simd::AVX2> {
+        static constexpr std::size_t W = 4;
+
+        static void load(const double* src, std::size_t stride, __m256d (&r)[4]) noexcept {
+            const __m256d r0 = _mm256_loadu_pd(src), r1 = _mm256_loadu_pd(src + stride);
+            const __m256d r2 = _mm256_loadu_pd(src + 2 * stride), r3 = _mm256_loadu_pd(src + 3 * stride);
+            const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+            const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+            r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+            r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+            r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+            r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+        }
+
+        static void store(double* dst, std::size_t stride, const __m256d (&r)[4]) noexcept {
+            for (std::size_t i = 0; i < 4; ++i)
+                _mm256_storeu_pd(dst + i * stride, r[i]);
+        }
+
+        static void transpose(const double* src, std::size_t srcStride, double* dst, std::size_t dstStride) noexcept {
+            __m256d r[4];
+            load(src, srcStride, r);
+            store(dst, dstStride, r);
+        }
+
+        static void swap(double* a, double* b, std::size_t stride) noexcept {
+            __m256d ra[4], rb[4];
+            load(a, stride, ra);
+            load(b, stride, rb);
+            store(b, stride, ra);
+            store(a, stride, rb);
+        }
+    };
+#endif
+
+#if defined(__AVX512F__)
+    // The ymm tiles, a 16 x 16 zmm tile needs twice the shuffles per element and spills
+    template<floatTypes T>
+    struct TransposeTile<T, Simd::AVX512> : TransposeTile<T, Simd::AVX2> {};
+#endif
+
+    // dst (cols x rows) = src (rows x cols)^T
+    template<floatTypes T, class Isa>
+    void transpose(const T* src, std::size_t rows, std::size_t cols, std::size_t srcStride, T* dst, std::size_t dstStride) {
+        using Tile = TransposeTile<T, Isa>;
+        constexpr std::size_t W = Tile::W;
+        const std::size_t fullRows = rows - rows % W, fullCols = cols - cols % W;
+
+        for (std::size_t r = 0; r < fullRows; r += W)
+            for (std::size_t c = 0; c < fullCols; c += W)
+                Tile::transpose(src + r * srcStride + c, srcStride, dst + c * dstStride + r, dstStride);
+
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = r < fullRows ? fullCols : 0; c < cols; ++c)
+                dst[c * dstStride + r] = src[r * srcStride + c];
+    }
+
+    // Exchanges a (rows x cols) with b (cols x rows) transposed, both with the same stride. a == b (rows == cols)
+    // transposes the block in place
+    template<floatTypes T, class Isa>
+    void transposeSwap(T* a, T* b, std::size_t rows, std::size_t cols, std::size_t stride) {
+        using Tile = TransposeTile<T, Isa>;
+        constexpr std::size_t W = Tile::W;
+        const bool inPlace = a == b;
+        const std::size_t fullRows = rows - rows % W, fullCols = cols - cols % W;
+
+        for (std::size_t r = 0; r < fullRows; r += W)
+            for (std::size_t c = inPlace ? r : 0; c < fullCols; c += W)
+                Tile::swap(a + r * stride + c, b + c * stride + r, stride);
+
+        // In place, the lower edge is swapped together with the right edge
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = r < fullRows ? fullCols : 0; c < cols; ++c) {
+                if (inPlace && c <= r)
+                    continue;
+                const T x = a[r * stride + c];
+                a[r * stride + c] = b[c * stride + r];
+                b[c * stride + r] = x;
+            }
+    }
+} // Math::Dispatch::Kernels
+
+#endif //NEUROINFORMATICS_TRANSPOSEKERNELS_H
@@ -0,0 +1,293 @@
+//
+// Created by timwe on 11/17/2025.
+//
+
+#ifndef NEUROINFORMATICS_VECTORMATH_H
+#define NEUROINFORMATICS_VECTORMATH_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "Concepts.h"
+#include "Simd.h"
+
+/*
+ * Vectorized exp/expm1/log/log1p and the activations built on them, written once against Vec<T, Isa> so they run
+ * 4/8/16 (float) lanes at a time. Same structure as Cephes/fdlibm, but with plain Taylor coefficients:
+ *
+ *      exp(x)   = 2^n * exp(r)                 n = round(x / ln2), r = x - n*ln2 (two part ln2), |r| <= ln2/2
+ *      log(x)   = e*ln2 + 2*atanh(f / (2 + f)) x = m * 2^e, m in [sqrt(1/2), sqrt(2)), f = m - 1
+ *      log1p(u) = 2*atanh(u / (2 + u)) inside that range of f, log(1 + u) outside (where 1 + u loses nothing relevant)
+ *      tanh(x)  = sign(x) * t / (t + 2)        t = expm1(2|x|), no cancellation for small |x|
+ *      sigmoid  = 1 / (1 + exp(-|x|)), mirrored for x < 0
+ *      softplus = max(x, 0) + log1p(exp(-|x|))
+ *      mish     = x * tanh(softplus(x))
+ *      elu      = x > 0 ? x : alpha * expm1(x), delu the same with its own threshold, relu = max(x, 0)
+ *
+ * Max error against libm (long double reference rounded to T), measured over the ranges in tests/Math/VectorMath.h
+ * for Generic, AVX2 and AVX512 (float / double, in ulp); the test checks exactly these bounds:
+ *      exp 1 / 1, expm1 2 / 2, log 4 / 3, log1p 4 / 3, tanh 4 / 3, sigmoid 4 / 3, softplus 4 / 3, mish 7 / 6
+ *
+ * Domains: exp saturates to +inf above 88.37 (float) / 709.43 (double), slightly before libm does, and flushes to 0
+ * where the result would be subnormal. log/log1p expect positive normal arguments (1 + u for log1p), there is no
+ * NaN/inf handling (the build uses -ffast-math anyway).
+ */
+
+namespace Math::Simd {
+    namespace Detail {
+        template<floatTypes T>
+        struct MathConstants;
+
+        template<>
+        struct MathConstants<float> {
+            static constexpr float expHi = 88.37f;
+            static constexpr float expLo = -87.33f;
+            static constexpr float ln2Hi = 0.693359375f; // few mantissa bits, so n * ln2Hi is exact
+            static constexpr float ln2Lo = -2.12194440e-4f;
+            static constexpr float log2e = 1.44269504088896341f;
+            static constexpr float tanhMax = 10.0f; // tanh rounds to 1 from here on
+            static constexpr std::size_t expTerms = 7; // r^7/7! term, truncation < 1e-8 for |r| <= ln2/2
+            static constexpr std::size_t atanhTerms = 5; // s^9/9 term, truncation < 1e-8 for s^2 <= 0.0295
+        };
+
+        template<>
+        struct MathConstants<double> {
+            static constexpr double expHi = 709.43;
+            static constexpr double expLo = -708.39;
+            static constexpr double ln2Hi = 6.93147180369123816490e-01;
+            static constexpr double ln2Lo = 1.90821492927058770002e-10;
+            static constexpr double log2e = 1.44269504088896341;
+            static constexpr double tanhMax = 20.0;
+            static constexpr std::size_t expTerms = 13;
+            static constexpr std::size_t atanhTerms = 10;
+        };
+
+        // 1/(k+1)! for k = N-1 .. 0 (highest first, Horner order); r * sum(c_k r^k) = exp(r) - 1
+        template<floatTypes T, std::size_t N>
+        constexpr std::array<T, N> expm1Coefficients() {
+            std::array<T, N> c{};
+            double factorial = 1.0;
+            for (std::size_t k = 0; k < N; ++k) {
+                factorial *= static_cast<double>(k + 1);
+                c[N - 1 - k] = static_cast<T>(1.0 / factorial);
+            }
+            return c;
+        }
+
+        // 1/(2k+1) highest first; s * sum(c_k s^2k) = atanh(s)
+        template<floatTypes T, std::size_t N>
+        constexpr std::array<T, N> atanhCoefficients() {
+            std::array<T, N> c{};
+            for (std::size_t k = 0; k < N; ++k)
+                c[N - 1 - k] = static_cast<T>(1.0 / static_cast<double>(2 * k + 1));
+            return c;
+        }
+    } // Detail
+
+    template<floatTypes T, class Isa>
+    struct VecMath {
+        using V = Vec<T, Isa>;
+        using type = typename V::type;
+        using C = Detail::MathConstants<T>;
+
+        template<std::size_t N>
+        static type horner(type x, const std::array<T, N>& c) noexcept {
+            type p = V::broadcast(c[0]);
+            for (std::size_t k = 1; k < N; ++k)
+                p = V::fmadd(p, x, V::broadcast(c[k]));
+            return p;
+        }
+
+        // x = n*ln2 + r, returns exp(r) - 1 and 2^n
+        static type reduceExp(type x, type& scale) noexcept {
+            static constexpr auto coefficients = Detail::expm1Coefficients<T, C::expTerms>();
+
+            const type n = V::round(V::mul(x, V::broadcast(C::log2e)));
+            const type r = V::fmadd(n, V::broadcast(-C::ln2Lo), V::opaque(V::fmadd(n, V::broadcast(-C::ln2Hi), x)));
+
+            scale = V::pow2(n);
+            return V::mul(r, horner(r, coefficients));
+        }
+
+        // 2 * atanh(f / (2 + f)) = log(1 + f), only accurate for f in [sqrt(1/2) - 1, sqrt(2) - 1]
+        static type log1pCore(type f) noexcept {
+            static constexpr auto coefficients = Detail::atanhCoefficients<T, C::atanhTerms>();
+
+            const type s = V::div(f, V::add(V::broadcast(T{2}), f));
+            const type s2 = V::mul(s, s);
+            return V::mul(V::add(s, s), horner(s2, coefficients));
+        }
+
+        static type exp(type x) noexcept {
+            const type clamped = V::min(V::max(x, V::broadcast(C::expLo)), V::broadcast(C::expHi));
+            type scale;
+            const type q = reduceExp(clamped, scale);
+            type result = V::fmadd(q, scale, scale); // 2^n * (1 + q)
+
+            result = V::selectLess(x, V::broadcast(C::expLo), V::zero(), result);
+            return V::selectLess(V::broadcast(C::expHi), x, V::broadcast(std::numeric_limits<T>::infinity()), result);
+        }
+
+        static type expm1(type x) noexcept {
+            const type clamped = V::min(V::max(x, V::broadcast(C::expLo)), V::broadcast(C::expHi));
+            type scale;
+            const type q = reduceExp(clamped, scale);
+            const type result = V::fmadd(q, scale, V::sub(scale, V::broadcast(T{1}))); // 2^n * q + (2^n - 1), exact for n = 0
+
+            return V::selectLess(V::broadcast(C::expHi), x, V::broadcast(std::numeric_limits<T>::infinity()), result);
+        }
+
+        static type log(type x) noexcept {
+            const type sqrt2 = V::broadcast(static_cast<T>(1.41421356237309504880));
+            type e = V::getexp(x);
+            type m = V::getmant(x); // [1, 2)
+
+            // move m into [sqrt(1/2), sqrt(2)) so f = m - 1 stays small; m/2 - 1 is exact
+            e = V::selectLess(sqrt2, m, V::add(e, V::broadcast(T{1})), e);
+            m = V::selectLess(sqrt2, m, V::mul(m, V::broadcast(T{0.5})), m);
+
+            const type f = V::sub(m, V::broadcast(T{1}));
+            const type result = V::opaque(V::fmadd(e, V::broadcast(C::ln2Lo), log1pCore(f)));
+            return V::fmadd(e, V::broadcast(C::ln2Hi), result);
+        }
+
+        static type log1p(type u) noexcept {
+            const type direct = log1pCore(u); // u is exact here, 1 + u would round
+            const type general = log(V::add(V::broadcast(T{1}), u));
+
+            const type inside = V::selectLess(V::broadcast(static_cast<T>(-0.29289321881345247560)), u, direct, general);
+            return V::selectLess(u, V::broadcast(static_cast<T>(0.41421356237309504880)), inside, general);
+        }
+
+        static type tanh(type x) noexcept {
+            const type ax = V::min(V::abs(x), V::broadcast(C::tanhMax));
+            const type t = expm1(V::add(ax, ax));
+            const type result = V::div(t, V::add(t, V::broadcast(T{2})));
+
+            return V::selectLess(x, V::zero(), V::sub(V::zero(), result), result);
+        }
+
+        static type sigmoid(type x) noexcept {
+            const type e = exp(V::sub(V::zero(), V::abs(x))); // never overflows
+            const type one = V::broadcast(T{1});
+            // -ffast-math may turn the division into a reciprocal estimate, one Newton step on top makes 1/1 and 1/2
+            // exact again on every level (the saturated ends and sigmoid(0)). With q clamped to [1/2, 1], where 1/(1+e)
+            // lies, 1-q is exact and the residual 1 - (1+e)q = (1-q) - eq needs no fma (Generic has none). The opaque
+            // copies keep the compiler from folding the step back into q * (1 + r)
+            const type q = V::opaque(V::min(V::max(V::div(one, V::add(one, e)), V::broadcast(T{0.5})), one));
+            const type r = V::sub(V::opaque(V::sub(one, q)), V::mul(e, q));
+            const type s = V::fmadd(q, r, V::opaque(q));
+
+            return V::selectLess(x, V::zero(), V::mul(e, s), s); // sigmoid(-|x|) = e/(1+e)
+        }
+
+        static type softplus(type x) noexcept {
+            const type e = exp(V::sub(V::zero(), V::abs(x)));
+            return V::add(V::max(x, V::zero()), log1p(e));
+        }
+
+        static type mish(type x) noexcept {
+            return V::mul(x, tanh(softplus(x)));
+        }
+    };
+
+    // Operations for transform / Math::mapInto, apply<T, Isa> works on one register
+    struct Exp { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::exp(x); } };
+    struct Expm1 { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::expm1(x); } };
+    struct Log1p { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::log1p(x); } };
+    struct Tanh { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::tanh(x); } };
+    struct Sigmoid { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::sigmoid(x); } };
+    struct Softplus { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::softplus(x); } };
+    struct Mish { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return VecMath<T, Isa>::mish(x); } };
+    struct Relu { template<floatTypes T, class Isa> typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept { return Vec<T, Isa>::max(x, Vec<T, Isa>::zero()); } };
+
+    // x > 0 ? x : alpha * (e^x - 1)
+    struct Elu {
+        double alpha = 1.0;
+
+        Elu() = default;
+        explicit Elu(double _alpha) : alpha(_alpha) {}
+
+        template<floatTypes T, class Isa>
+        typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept {
+            using V = Vec<T, Isa>;
+            return V::selectLess(V::zero(), x, x, V::mul(V::broadcast(static_cast<T>(this->alpha)), VecMath<T, Isa>::expm1(x)));
+        }
+    };
+
+    // lambda * (x > 0 ? x : alpha * (e^x - 1)) with the self-normalizing constants of Klambauer et al.
+    struct Selu {
+        static constexpr double lambda = 1.0507009873554805, alpha = 1.6732632423543772;
+
+        template<floatTypes T, class Isa>
+        typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept {
+            using V = Vec<T, Isa>;
+            return V::mul(V::broadcast(static_cast<T>(lambda)), Elu(alpha).template apply<T, Isa>(x));
+        }
+    };
+
+    // x > 0 ? x : slope * x
+    struct LeakyRelu {
+        double slope = 0.01;
+
+        LeakyRelu() = default;
+        explicit LeakyRelu(double _slope) : slope(_slope) {}
+
+        template<floatTypes T, class Isa>
+        typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept {
+            using V = Vec<T, Isa>;
+            return V::selectLess(V::zero(), x, x, V::mul(V::broadcast(static_cast<T>(this->slope)), x));
+        }
+    };
+
+    // x > xc ? x : (e^x - 1) / 2, Functions::delu with its default parameters
+    struct Delu {
+        template<floatTypes T, class Isa>
+        typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept {
+            using V = Vec<T, Isa>;
+            return V::selectLess(V::broadcast(static_cast<T>(1.25643)), x, x, V::mul(VecMath<T, Isa>::expm1(x), V::broadcast(T{0.5})));
+        }
+    };
+
+    // log_base(x) = log(x) * (1 / ln(base)), the division by ln(base) is done once when the op is built
+    struct Log {
+        double invLnBase = 1.0;
+
+        Log() = default;
+        explicit Log(double base) : invLnBase(1.0 / std::log(base)) {}
+
+        template<floatTypes T, class Isa>
+        typename Vec<T, Isa>::type apply(typename Vec<T, Isa>::type x) const noexcept {
+            using V = Vec<T, Isa>;
+            return V::mul(VecMath<T, Isa>::log(x), V::broadcast(static_cast<T>(this->invLnBase)));
+        }
+    };
+
+    template<class Op, class T>
+    concept vectorOp = requires(const Op& op, typename Vec<T, Generic>::type v) {
+        { op.template apply<T, Generic>(v) };
+    };
+
+    // out[i] = op(in[i]) for n elements, in and out may be the same buffer. The tail goes through a zeroed register.
+    // This is the kernel of one ISA (see Math/Isa), Dispatch::transform picks the one of the running CPU.
+    template<floatTypes T, class Op, class Isa>
+    void transform(const T* in, T* out, std::size_t n, const Op& op = {}) noexcept {
+        using V = Vec<T, Isa>;
+
+        std::size_t i = 0;
+        for (; i + V::width <= n; i += V::width)
+            V::storeu(out + i, op.template apply<T, Isa>(V::loadu(in + i)));
+
+        if (i < n) {
+            alignas(64) T tail[V::width] = {};
+            std::memcpy(tail, in + i, (n - i) * sizeof(T));
+            V::storeu(tail, op.template apply<T, Isa>(V::loadu(tail)));
+            std::memcpy(out + i, tail, (n - i) * sizeof(T));
+        }
+    }
+} // Math::Simd
+
+#endif //NEUROINFORMATICS_VECTORMATH_H
@@ -0,0 +1,179 @@
+//
+// Created by timwe on 12/2/2025.
+//
+
+#ifndef NEUROINFORMATICS_ACTIVATIONS_H
+#define NEUROINFORMATICS_ACTIVATIONS_H
+
+#include <cmath>
+#include <stdexcept>
+
+#include "ActivationTypes.h"
+#include "../Math/Elementwise.h"
+#include "../Math/Gemm.h"
+#include "../Math/Layout.h"
+#include "../Math/Matrix.h"
+#include "../Math/VectorMath.h"
+
+/*
+ * The activations as static policies, each one carries
+ *
+ *      type                    its ActivationTypes value
+ *      forward                 the Gemm::Activation the gemm epilogue (or Math::activationInto) applies, one of the
+ *                              register ops of VectorMath.h
+ *      parameter               alpha of Elu, the slope of LeakyReLU (passed along as the alpha of the epilogue)
+ *      cache                   what the derivative reads: Z, A, or nothing
+ *      derivative(da, c, p)    dA * f' of one element, c the cached Z or A, p the parameter
+ *
+ * A DenseLayer looks its activation up once when it is built (activationKernels<T>(type)). The entry holds the
+ * forward op for the epilogue and a derivative kernel instantiated for the policy, so f' is inlined into the loop
+ * of Math::mapSumInto (dZ = dA * f' and db = the sample mean of dZ, one sweep) instead of going through a switch or
+ * a function per element.
+ */
+
+namespace NeuralNetworks {
+    enum class DerivativeCache { None, Z, A };
+
+    namespace Activations {
+        struct Linear {
+            static constexpr ActivationTypes type = ActivationTypes::Linear;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Identity;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::None;
+            template<Math::floatTypes T> static T derivative(T da, T, T) noexcept { return da; }
+        };
+
+        struct Sigmoid {
+            static constexpr ActivationTypes type = ActivationTypes::Sigmoid;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Sigmoid;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::A;
+            template<Math::floatTypes T> static T derivative(T da, T a, T) noexcept { return da * a * (T{1} - a); }
+        };
+
+        struct Tanh {
+            static constexpr ActivationTypes type = ActivationTypes::Tanh;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Tanh;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::A;
+            template<Math::floatTypes T> static T derivative(T da, T a, T) noexcept { return da * (T{1} - a * a); }
+        };
+
+        struct ReLU {
+            static constexpr ActivationTypes type = ActivationTypes::ReLU;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::ReLU;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T) noexcept { return z > T{0} ? da : T{0}; }
+        };
+
+        struct LeakyReLU {
+            static constexpr ActivationTypes type = ActivationTypes::LeakyReLU;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::LeakyReLU;
+            static constexpr double parameter = 0.01; // slope for z <= 0
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T slope) noexcept { return z > T{0} ? da : da * slope; }
+        };
+
+        struct Elu {
+            static constexpr ActivationTypes type = ActivationTypes::Elu;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Elu;
+            static constexpr double parameter = 0.5; // alpha
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T alpha) noexcept { return z > T{0} ? da : da * alpha * std::exp(z); }
+        };
+
+        struct SELU {
+            static constexpr ActivationTypes type = ActivationTypes::SELU;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Selu;
+            static constexpr double parameter = 0.0; // the constants are fixed, Math::Simd::Selu
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T) noexcept {
+                constexpr T lambda = Math::Simd::Selu::lambda, alpha = Math::Simd::Selu::alpha;
+                return z > T{0} ? da * lambda : da * (lambda * alpha) * std::exp(z);
+            }
+        };
+
+        struct Softplus {
+            static constexpr ActivationTypes type = ActivationTypes::Softplus;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Softplus;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T) noexcept { return da / (T{1} + std::exp(-z)); } // sigmoid(z)
+        };
+
+        // x > xc ? x : (e^x - 1) / 2, the Math::Simd::Delu op
+        struct Delu {
+            static constexpr ActivationTypes type = ActivationTypes::Delu;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Delu;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T) noexcept {
+                return z > static_cast<T>(1.25643) ? da : da * T{0.5} * std::exp(z);
+            }
+        };
+
+        // z * tanh(softplus(z)): f' = tanh(sp) + z * (1 - tanh(sp)^2) * sigmoid(z)
+        struct Mish {
+            static constexpr ActivationTypes type = ActivationTypes::Mish;
+            static constexpr Math::Gemm::Activation forward = Math::Gemm::Activation::Mish;
+            static constexpr double parameter = 0.0;
+            static constexpr DerivativeCache cache = DerivativeCache::Z;
+            template<Math::floatTypes T> static T derivative(T da, T z, T) noexcept {
+                const T e = std::exp(z > T{20} ? T{20} : z); // softplus(z) = z from there on in any precision
+                const T t = std::tanh(z > T{20} ? z : std::log1p(e));
+                return da * (t + z * (T{1} - t * t) * e / (T{1} + e));
+            }
+        };
+
+        // dZ = P::derivative(dA, cache) and db = the mean of dZ over the samples, one sweep: the row sums feature-major,
+        // the column sums sample-major
+        template<Math::floatTypes T, class P>
+        void derivative(Math::Layout layout, Math::MatrixView<const T> dA, Math::MatrixView<const T> cache, T parameter,
+                        Math::Matrix<T>& dZ, Math::Matrix<T>& db) {
+            const auto over = layout == Math::Layout::FeatureMajor ? Math::SumOver::Columns : Math::SumOver::Rows;
+            const T scale = T{1} / static_cast<T>(Math::sampleCount(dA, layout));
+            if constexpr (P::cache == DerivativeCache::None)
+                Math::mapSumInto(dZ, db, over, scale, [parameter](T da) { return P::template derivative<T>(da, da, parameter); }, dA);
+            else
+                Math::mapSumInto(dZ, db, over, scale, [parameter](T da, T c) { return P::template derivative<T>(da, c, parameter); }, dA, cache);
+        }
+    } // Activations
+
+    // What a layer needs of its activation, looked up once
+    template<Math::floatTypes T>
+    struct ActivationKernels {
+        ActivationTypes type;
+        Math::Gemm::Activation forward;
+        T parameter;
+        DerivativeCache cache;
+        // dZ = dA * f'(cache) and db = the sample mean of dZ; dZ may be dA or cache
+        void (*derivative)(Math::Layout layout, Math::MatrixView<const T> dA, Math::MatrixView<const T> cache, T parameter,
+                           Math::Matrix<T>& dZ, Math::Matrix<T>& db);
+    };
+
+    template<Math::floatTypes T, class P>
+    [[nodiscard]] constexpr ActivationKernels<T> activationKernelsOf() noexcept {
+        return {P::type, P::forward, static_cast<T>(P::parameter), P::cache, &Activations::derivative<T, P>};
+    }
+
+    // Throws std::invalid_argument for a type without a policy
+    template<Math::floatTypes T>
+    [[nodiscard]] ActivationKernels<T> activationKernels(ActivationTypes type) {
+        switch (type) {
+            case ActivationTypes::Linear: return activationKernelsOf<T, Activations::Linear>();
+            case ActivationTypes::Sigmoid: return activationKernelsOf<T, Activations::Sigmoid>();
+            case ActivationTypes::Tanh: return activationKernelsOf<T, Activations::Tanh>();
+            case ActivationTypes::ReLU: return activationKernelsOf<T, Activations::ReLU>();
+            case ActivationTypes::LeakyReLU: return activationKernelsOf<T, Activations::LeakyReLU>();
+            case ActivationTypes::Elu: return activationKernelsOf<T, Activations::Elu>();
+            case ActivationTypes::SELU: return activationKernelsOf<T, Activations::SELU>();
+            case ActivationTypes::Softplus: return activationKernelsOf<T, Activations::Softplus>();
+            case ActivationTypes::Delu: return activationKernelsOf<T, Activations::Delu>();
+            case ActivationTypes::Mish: return activationKernelsOf<T, Activations::Mish>();
+        }
+        throw std::invalid_argument("Unknown activation type");
+    }
+} // NeuralNetworks
+
+#endif //NEUROINFORMATICS_ACTIVATIONS_H
@@ -3,167 +3,292 @@
 //
 
 #include <cmath>
+#include <type_traits>
+#include <utility>
 #include "DenseLayer.h"
 
 namespace NeuralNetworks {
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::linearDerivative(const std::size_t _rows, const std::size_t _cols, const std::size_t _stride) const {
-        Math::Matrix<T> ones(_rows, _cols, _stride);
-        ones.fill(T{1});
-
-        return ones;
+    void activate(ActivationTypes act, const Math::Matrix<T> &mat, Math::Matrix<T> &out) {
+        const ActivationKernels<T> activation = activationKernels<T>(act);
+        Math::activationInto(out, mat, activation.forward, activation.parameter);
     }
 
-    // A-based
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::sigmoidDerivative() const {
-        Math::Matrix<T> ones(this->A.rows(), this->A.cols(), this->A.stride());
-        ones.fill(T{1});
+    bool DenseLayer<T>::derivativeReadsZ() const noexcept {
+        return this->activation.cache == DerivativeCache::Z;
+    }
 
-        return this->A.hadamard(ones.sub(this->A));
+    // out = dA * f' and _db = its mean over the samples in one sweep, f' inlined for the activation (Activations.h);
+    // in BFloat16 mode the cache gets widened into out first, the derivative may read and write it
+    template<Math::floatTypes T>
+    void DenseLayer<T>::applyDerivative(Math::MatrixView<const T> dA, Math::Matrix<T> &out, Math::Matrix<T> &_db) const {
+        Math::MatrixView<const T> cache;
+        if(this->activation.cache != DerivativeCache::None) {
+            cache = this->derivativeReadsZ() ? this->Z : this->A;
+            if(this->precision == Math::Precision::BFloat16) {
+                Math::widenInto(out, this->derivativeReadsZ() ? this->Z16 : this->A16);
+                cache = out;
+            }
+        }
+        this->activation.derivative(this->layout, dA, cache, this->activation.parameter, out, _db);
     }
 
-    // A-based
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::tanhDerivative() const {
-        Math::Matrix<T> ones(this->A.rows(), this->A.cols(), this->A.stride());
-        ones.fill(T{1});
+    template<class S, class In>
+    void DenseLayer<T>::affine(const In& _Aprev, Math::MatrixView<const S> _W, Math::Matrix<T> &_Z, Math::Matrix<T>* _A, Math::Gemm::Activation f) const {
+        if(Math::featureCount(_Aprev, this->layout) != this->inNodes)
+            throw std::invalid_argument("Aprev has an unexpected amount of features");
+
+        if(_W.rows() != this->outNodes || _W.cols() != this->inNodes)
+            throw std::invalid_argument("W has an unexpected shape");
+
+        if(Math::featureCount(b, this->layout) != this->outNodes || Math::sampleCount(b, this->layout) != 1)
+            throw std::invalid_argument("b has an unexpected shape");
 
-        return ones.sub(this->A.hadamard(this->A));
+        // b is a column (feature-major) or a row (sample-major) of Z either way, the epilogue adds it as it comes
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+        if constexpr (std::is_same_v<In, Math::SparseMatrix<T>>) { // no gemm to fuse into, one epilogue pass after the product
+            if(featureMajor)
+                Math::matMulInto(_Z, _W, _Aprev);
+            else
+                Math::matMulInto(_Z, _Aprev, _W, Math::Gemm::Transpose::No, Math::Gemm::Transpose::Yes);
+            Math::biasActivationInto(_Z, this->b, f, _A, this->activation.parameter);
+        } else if(featureMajor) {
+            Math::affineInto<T>(_Z, _W, _Aprev, Math::Gemm::Transpose::No, Math::Gemm::Transpose::No, this->b, f, _A, this->activation.parameter);
+        } else { // Z (m x out) = Aprev (m x in) * W^T, the gemm reads the rows of W as columns
+            Math::affineInto<T>(_Z, _Aprev, _W, Math::Gemm::Transpose::No, Math::Gemm::Transpose::Yes, this->b, f, _A, this->activation.parameter);
+        }
     }
 
-    // Z-based
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::reluDerivative() const {
-        return this->Z.map([](T num){ return num > T{0} ? T{1} : T{0}; });
+    const Math::Matrix<T>& DenseLayer<T>::forward(Math::MatrixView<const T> _Aprev) {
+        if(this->precision != Math::Precision::Full)
+            throw std::logic_error("DenseLayer::forward() in BFloat16 mode takes a bfloat16 input");
+
+        // Keep a view of Aprev (in x m) for backward; Z (out x m) only if the derivative reads it, otherwise the
+        // activation goes over it in the A buffer. A comes out of the same gemm either way
+        const bool keepZ = this->derivativeReadsZ();
+        this->affine<T>(_Aprev, this->W, keepZ ? this->Z : this->A, keepZ ? &this->A : nullptr, this->activation.forward);
+        this->Aprev = _Aprev;
+        this->sparsePrev = nullptr;
+
+        return this->A;
     }
 
-    // Z-based
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::eluDerivative(T alpha) const {
-        return this->Z.map([&](T num){ return num > T{0} ? T{1} : alpha*std::exp(num); });
+    void DenseLayer<T>::infer(Math::MatrixView<const T> _Aprev, Math::MatrixView<T> out) const {
+        if(Math::featureCount(_Aprev, this->layout) != this->inNodes)
+            throw std::invalid_argument("Aprev has an unexpected amount of features");
+
+        const auto run = [&]<class S>(Math::MatrixView<const S> _W) {
+            if(this->layout == Math::Layout::FeatureMajor)
+                Math::affineInto<T>(out, _W, _Aprev, Math::Gemm::Transpose::No, Math::Gemm::Transpose::No, this->b, this->activation.forward, this->activation.parameter);
+            else
+                Math::affineInto<T>(out, _Aprev, _W, Math::Gemm::Transpose::No, Math::Gemm::Transpose::Yes, this->b, this->activation.forward, this->activation.parameter);
+        };
+        if(this->precision == Math::Precision::BFloat16)
+            run(Math::MatrixView<const Math::bfloat16>(this->W16));
+        else
+            run(Math::MatrixView<const T>(this->W));
     }
 
-    // Z-based
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::softplusDerivative() const {
-        return this->Z.sigmoid();
+    const Math::Matrix<T>& DenseLayer<T>::forward(const Math::SparseMatrix<T>& _Aprev) {
+        if(this->precision != Math::Precision::Full)
+            throw std::logic_error("DenseLayer::forward() with a sparse input needs Full precision");
+
+        const bool keepZ = this->derivativeReadsZ(); // sparse x dense gemm (SparseMatrix.h), caches as in the dense forward
+        this->affine<T>(_Aprev, this->W, keepZ ? this->Z : this->A, keepZ ? &this->A : nullptr, this->activation.forward);
+        this->Aprev = {};
+        this->sparsePrev = &_Aprev;
+
+        return this->A;
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::mishDerivative() const {
-        throw std::logic_error("Not implemented yet");
+    const Math::Matrix<T>& DenseLayer<T>::recompute() {
+        if(this->sparsePrev != nullptr)
+            return this->forward(*this->sparsePrev);
+        return this->forward(this->Aprev);
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::deluDerivative() const {
-        throw std::logic_error("Not implemented yet");
+    void DenseLayer<T>::rebindInput(Math::MatrixView<const T> _Aprev) {
+        if(this->sparsePrev != nullptr || _Aprev.rows() != this->Aprev.rows() || _Aprev.cols() != this->Aprev.cols())
+            throw std::invalid_argument("In DenseLayer::rebindInput() Aprev has another shape than the input of the last forward");
+
+        this->Aprev = _Aprev;
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::applyActivation(const Math::Matrix<T> &mat) const {
-        if(this->act == NeuralNetworks::ActivationTypes::Tanh)
-            return mat.tanh();
-        else if(this->act == NeuralNetworks::ActivationTypes::ReLU)
-            return mat.relu();
-        else if(this->act == NeuralNetworks::ActivationTypes::Sigmoid)
-            return mat.sigmoid();
-        else if(this->act == NeuralNetworks::ActivationTypes::Softplus)
-            return mat.softplus();
-        else if(this->act == NeuralNetworks::ActivationTypes::Elu)
-            return mat.elu(0.5);
-        else if(this->act == NeuralNetworks::ActivationTypes::Delu)
-            return mat.delu();
-        else if(this->act == NeuralNetworks::ActivationTypes::Mish)
-           return mat.mish();
-        else if(this->act == NeuralNetworks::ActivationTypes::Linear)
-            return mat.linear();
-        else
-           return mat.tanh();
-    }
-
-    template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::applyDerivative() const {
-        if(this->act == NeuralNetworks::ActivationTypes::Linear)
-            return this->linearDerivative(A.rows(), A.cols(), A.stride());
-        else if(this->act == NeuralNetworks::ActivationTypes::Tanh)
-            return this->tanhDerivative();
-        else if(this->act == NeuralNetworks::ActivationTypes::ReLU)
-            return this->reluDerivative();
-        else if(this->act == NeuralNetworks::ActivationTypes::Sigmoid)
-            return this->sigmoidDerivative();
-        else if(this->act == NeuralNetworks::ActivationTypes::Softplus)
-            return this->softplusDerivative();
-        else if(this->act == NeuralNetworks::ActivationTypes::Elu)
-            return this->eluDerivative(0.5);
-        else if(this->act == NeuralNetworks::ActivationTypes::Delu)
-            return this->deluDerivative();
-        else if(this->act == NeuralNetworks::ActivationTypes::Mish)
-            return this->mishDerivative();
-        else
-            throw std::logic_error("Derivative type is unknown in DenseLayer::applyDerivative");
+    void DenseLayer<T>::exchangeCache(ActivationCache<T>& cache) noexcept {
+        std::swap(this->Z, cache.Z);
+        std::swap(this->A, cache.A);
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::forward(const Math::Matrix<T> &_Aprev) {
-        if(_Aprev.rows() != this->inNodes)
-            throw std::invalid_argument("Aprev has an unexpected amount of features");
-
-        if(W.rows() != this->outNodes || W.cols() != this->inNodes)
-            throw std::invalid_argument("W has an unexpected shape");
-
-        if(b.rows() != this->outNodes || b.cols() != 1)
-            throw std::invalid_argument("b has an unexpected shape");
+    std::size_t DenseLayer<T>::cacheBytes(std::size_t samples) const noexcept {
+        const std::size_t matrices = this->derivativeReadsZ() ? 2 : 1;
+        return matrices * this->outNodes * samples * sizeof(T);
+    }
 
-        // Store Aprev (in x m) and Z ( out x m) after forward
-        this->Z = (this->W.matMul(_Aprev)).addBias(this->b);
-        this->Aprev = _Aprev;
-        this->A = applyActivation(this->Z);
+    template<Math::floatTypes T>
+    const Math::Matrix<Math::bfloat16>& DenseLayer<T>::forward(Math::MatrixView<const Math::bfloat16> _Aprev) {
+        if(this->precision != Math::Precision::BFloat16)
+            throw std::logic_error("DenseLayer::forward() with a bfloat16 input needs BFloat16 mode");
+
+        // Z and the activation are computed in T in the dZ scratch, only Aprev16 and the narrowed caches are kept.
+        // If Z is kept as well the activation is a pass of its own after narrowing it
+        if(this->derivativeReadsZ()) {
+            this->affine<Math::bfloat16>(_Aprev, this->W16, this->dZ, nullptr, Math::Gemm::Activation::Identity);
+            Math::narrowInto<T>(this->Z16, this->dZ);
+            Math::activationInto(this->dZ, this->dZ, this->activation.forward, this->activation.parameter);
+        } else {
+            this->affine<Math::bfloat16>(_Aprev, this->W16, this->dZ, nullptr, this->activation.forward);
+        }
+        this->Aprev16 = _Aprev;
+        this->sparsePrev = nullptr;
+        Math::narrowInto<T>(this->A16, this->dZ);
+
+        return this->A16;
+    }
 
-        return this->A;
+    template<Math::floatTypes T>
+    template<class S, class In>
+    void DenseLayer<T>::gradients(Math::MatrixView<const T> _dZ, const In& _Aprev, Math::MatrixView<const S> _W, std::size_t samples,
+                                  Math::MatrixView<T> _dAprev) {
+        constexpr bool sparse = std::is_same_v<In, Math::SparseMatrix<T>>;
+        const T m = samples;
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+        // Feature-major: dW = 1/m * dZ * Aprev^T, dAprev = W^T * dZ
+        // Sample-major:  dW = 1/m * dZ^T * Aprev, dAprev (m x in) = dZ * W
+        // 1/m is the alpha of the gemm, db already came out of the sweep that made dZ. The gemm reads the transposed
+        // operands in place, dW goes into the buffer of the last step and dAprev into the view the caller passed
+        if(featureMajor)
+            Math::matMulInto(this->dW, _dZ, _Aprev, Math::Gemm::Transpose::No, Math::Gemm::Transpose::Yes, T{1} / m);
+        else
+            Math::matMulInto(this->dW, _dZ, _Aprev, Math::Gemm::Transpose::Yes, Math::Gemm::Transpose::No, T{1} / m);
+
+        if constexpr (!sparse) {
+            if(_dAprev.empty())
+                return;
+            const Math::MatrixView<const T> noBias;
+            if(featureMajor)
+                Math::affineInto<T>(_dAprev, _W, _dZ, Math::Gemm::Transpose::Yes, Math::Gemm::Transpose::No, noBias, Math::Gemm::Activation::Identity);
+            else
+                Math::affineInto<T>(_dAprev, _dZ, _W, Math::Gemm::Transpose::No, Math::Gemm::Transpose::No, noBias, Math::Gemm::Activation::Identity);
+        }
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::backward(const Math::Matrix<T> &dA, bool treatInputASdZ) {
-        if(dA.rows() != this->outNodes)
+    void DenseLayer<T>::backward(Math::MatrixView<const T> dA, Math::MatrixView<T> dAprev, bool treatInputASdZ) {
+        const bool full = this->precision == Math::Precision::Full, sparse = this->sparsePrev != nullptr;
+        std::size_t inputFeatures, samples;
+        if(sparse) {
+            inputFeatures = Math::featureCount(*this->sparsePrev, this->layout);
+            samples = Math::sampleCount(*this->sparsePrev, this->layout);
+        } else if(full) {
+            inputFeatures = Math::featureCount(this->Aprev, this->layout);
+            samples = Math::sampleCount(this->Aprev, this->layout);
+        } else {
+            inputFeatures = Math::featureCount(this->Aprev16, this->layout);
+            samples = Math::sampleCount(this->Aprev16, this->layout);
+        }
+        const std::size_t cachedSamples = full ? Math::sampleCount(this->A, this->layout) : Math::sampleCount(this->A16, this->layout);
+
+        if(Math::featureCount(dA, this->layout) != this->outNodes)
             throw std::invalid_argument("dA Shape is not matching features of the layer");
 
-        if(this->Aprev.rows() != this->inNodes)
+        if(inputFeatures != this->inNodes)
             throw std::invalid_argument("Aprev Shape is not matching features of the input layer");
 
-        if(this->Aprev.cols() == 0 || this->Aprev.cols() != this->Z.cols())
+        if(samples == 0 || samples != cachedSamples)
             throw std::invalid_argument("Aprev columns are 0 or shape is not matching Z");
 
-        if(dA.cols() != this->Z.cols())
+        if(Math::sampleCount(dA, this->layout) != samples)
             throw std::invalid_argument("dA upstream passes does not match the Z batch size");
 
-        const T m = this->Aprev.cols();
+        if(!dAprev.empty() && (sparse || Math::featureCount(dAprev, this->layout) != this->inNodes || Math::sampleCount(dAprev, this->layout) != samples))
+            throw std::invalid_argument("dAprev has to have the shape of Aprev (empty for a sparse input)");
 
+        // dZ = dA * f'(Z) and db = the mean of dZ over the samples in one pass. In Full precision dZ goes over the cache
+        // it is computed from, nothing reads Z or A after this (the next layer's backward is done with A as its Aprev);
+        // BFloat16 mode has the dZ scratch. All of them keep their buffers between steps
+        Math::Matrix<T>& _dZ = !full ? this->dZ : this->derivativeReadsZ() ? this->Z : this->A;
         if(treatInputASdZ) // BCE + Sigmoid trick
-            this->dZ = dA;
+            Activations::derivative<T, Activations::Linear>(this->layout, dA, {}, T{0}, _dZ, this->db);
+        else
+            this->applyDerivative(dA, _dZ, this->db);
+
+        if(sparse)
+            this->gradients<T>(_dZ, *this->sparsePrev, this->W, samples, dAprev);
+        else if(full)
+            this->gradients<T>(_dZ, this->Aprev, this->W, samples, dAprev);
         else
-            this->dZ = dA.hadamard(applyDerivative());
+            this->gradients<Math::bfloat16>(_dZ, this->Aprev16, this->W16, samples, dAprev);
+    }
 
-        this->dW = (this->dZ.matMul(this->Aprev.transpose())).divide(m);
-        this->db = dZ.sumOverColumns().divide(m);
-        return this->W.transpose().matMul(this->dZ); // Return dAprev
+    template<Math::floatTypes T>
+    void DenseLayer<T>::syncWeights() {
+        if(this->precision == Math::Precision::BFloat16)
+            Math::narrowInto<T>(this->W16, this->W);
     }
 
     template<Math::floatTypes T>
-    void DenseLayer<T>::update(T lr) {
-        this->W = this->W.sub(this->dW.scalarMul(lr));
-        this->b = this->b.sub(this->db.scalarMul(lr));
+    void DenseLayer<T>::placeParameters(std::pmr::memory_resource* parameters, std::pmr::memory_resource* gradients) {
+        this->W = Math::Matrix<T>(this->W.view(), parameters);
+        this->b = Math::Matrix<T>(this->b.view(), parameters);
+        this->dW = Math::Matrix<T>(this->dW.view(), gradients);
+        this->db = Math::Matrix<T>(this->db.view(), gradients);
     }
 
     template<Math::floatTypes T>
-    ActivationTypes DenseLayer<T>::getActivation() noexcept {
+    bool DenseLayer<T>::placedIn(Math::MatrixView<const T> parameters, Math::MatrixView<const T> gradients) const noexcept {
+        const auto inside = [](const Math::Matrix<T>& M, Math::MatrixView<const T> block) {
+            const T* p = M.data().data();
+            return p >= block.data() && p + M.bufferSize() <= block.data() + (block.rows() - 1) * block.stride() + block.cols();
+        };
+        return inside(this->W, parameters) && inside(this->b, parameters) && inside(this->dW, gradients) && inside(this->db, gradients);
+    }
+
+    template<Math::floatTypes T>
+    ActivationTypes DenseLayer<T>::getActivation() const noexcept {
         return this->act;
     }
 
     template<Math::floatTypes T>
-    Math::Matrix<T> DenseLayer<T>::getA() noexcept {
-        return this->A;
+    const Math::Matrix<T>& DenseLayer<T>::getW() const noexcept {
+        return this->W;
+    }
+
+    template<Math::floatTypes T>
+    const Math::Matrix<T>& DenseLayer<T>::getB() const noexcept {
+        return this->b;
+    }
+
+    template<Math::floatTypes T>
+    Math::Matrix<T> DenseLayer<T>::getA() const {
+        if(this->precision == Math::Precision::Full)
+            return this->A;
+
+        Math::Matrix<T> A;
+        Math::widenInto(A, this->A16);
+        return A;
+    }
+
+    template<Math::floatTypes T>
+    Math::Precision DenseLayer<T>::getPrecision() const noexcept {
+        return this->precision;
+    }
+
+    // Only draws for the valid elements (row by row), the padding of W stays 0 and the random sequence doesn't depend on the stride
+    template<Math::floatTypes T>
+    void DenseLayer<T>::fillWeights(std::normal_distribution<T>& norm) {
+        for (std::size_t r = 0; r < this->W.rows(); ++r)
+            for (std::size_t c = 0; c < this->W.cols(); ++c)
+                this->W.unchecked(r, c) = norm(this->gen);
     }
 
     template<Math::floatTypes T>
@@ -171,7 +296,7 @@ namespace NeuralNetworks {
         double sigma = std::sqrt(2.0/(this->inNodes + this->outNodes));
         std::normal_distribution<T> norm(0,sigma); // mean 0; stddev sigma
 
-        this->W = this->W.map([&](T num){return T{norm(this->gen)};});
+        this->fillWeights(norm);
     }
 
     template<Math::floatTypes T>
@@ -179,7 +304,7 @@ namespace NeuralNetworks {
         double sigma = std::sqrt(2.0/this->inNodes);
         std::normal_distribution<T> norm(0,sigma); // mean 0; stddev sigma
 
-        this->W = this->W.map([&](T num){return T{norm(this->gen)};});
+        this->fillWeights(norm);
     }
 
     template<Math::floatTypes T>
@@ -187,7 +312,7 @@ namespace NeuralNetworks {
         double sigma = std::sqrt(1.0/(this->inNodes));
         std::normal_distribution<T> norm(0,sigma); // mean 0; stddev sigma
 
-        this->W = this->W.map([&](T num){return T{norm(this->gen)};});
+        this->fillWeights(norm);
     }
 
     template<Math::floatTypes T>
@@ -200,32 +325,40 @@ namespace NeuralNetworks {
             this->lecunInitializer();
         else
             this->xavierInitializer();
+
+        this->syncWeights();
     }
 
     template<Math::floatTypes T>
-    std::size_t DenseLayer<T>::getinNodes() noexcept {
+    std::size_t DenseLayer<T>::getinNodes() const noexcept {
         return this->inNodes;
     }
 
     template<Math::floatTypes T>
-    std::size_t DenseLayer<T>::getoutNodes() noexcept {
+    std::size_t DenseLayer<T>::getoutNodes() const noexcept {
         return this->outNodes;
     }
 
     template<Math::floatTypes T>
-    DenseLayer<T>::DenseLayer(std::size_t _inNodes, std::size_t _outNodes, NeuralNetworks::ActivationTypes _act, std::mt19937& _gen, bool initializeInConstructor)
-        : gen(_gen), inNodes(_inNodes), outNodes(_outNodes), act(_act) {
+    DenseLayer<T>::DenseLayer(std::size_t _inNodes, std::size_t _outNodes, NeuralNetworks::ActivationTypes _act, std::mt19937& _gen, bool initializeInConstructor,
+                              Math::Layout _layout, Math::Precision _precision)
+        : gen(_gen), inNodes(_inNodes), outNodes(_outNodes), act(_act), activation(activationKernels<T>(_act)), layout(_layout), precision(_precision) {
         this->initMode = NeuralNetworks::getInitializationModeFromActivationFunction(this->act);
         this->W = Math::Matrix<T>(this->outNodes, this->inNodes);
-        this->b = Math::Matrix<T>(this->outNodes, 1);
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+        this->b = Math::Matrix<T>(featureMajor ? this->outNodes : 1, featureMajor ? 1 : this->outNodes);
         this->dW = Math::Matrix<T>(this->outNodes, this->inNodes);
-        this->db = Math::Matrix<T>(this->outNodes, 1);
+        this->db = Math::Matrix<T>(this->b.rows(), this->b.cols());
         this->b.fill(0);
 
         if (initializeInConstructor)
             this->initialize();
+        else
+            this->syncWeights();
     }
 
+    template void activate<float>(ActivationTypes, const Math::Matrix<float>&, Math::Matrix<float>&);
+    template void activate<double>(ActivationTypes, const Math::Matrix<double>&, Math::Matrix<double>&);
     template class NeuralNetworks::DenseLayer<float>;
     template class NeuralNetworks::DenseLayer<double>;
 } // NeuralNetworks
\ No newline at end of file
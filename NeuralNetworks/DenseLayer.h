@@ -7,11 +7,25 @@
 
 #include <iostream>
 #include <random>
+#include "../Math/Layout.h"
 #include "../Math/Matrix.h"
+#include "../Math/Precision.h"
+#include "../Math/SparseMatrix.h"
 #include "ActivationTypes.h"
+#include "Activations.h"
 #include "InitializationMode.h"
 
 namespace NeuralNetworks {
+    template<Math::floatTypes T>
+    void activate(ActivationTypes act, const Math::Matrix<T>& Z, Math::Matrix<T>& out); // out = act(Z), out can be Z
+
+    // The Full precision activation caches of a layer. A NeuralNetwork that checkpoints lends one pair to every layer
+    // it recomputes (DenseLayer::exchangeCache), layers of the same width in different segments share it
+    template<Math::floatTypes T>
+    struct ActivationCache {
+        Math::Matrix<T> Z, A;
+    };
+
     template<Math::floatTypes T>
     class DenseLayer {
     private:
@@ -19,49 +33,99 @@ namespace NeuralNetworks {
         std::size_t inNodes; // Number of nodes from last layer
         std::size_t outNodes; // Number of nodes in this layer
         NeuralNetworks::ActivationTypes act; // Activation function
+        ActivationKernels<T> activation; // act looked up once: forward op of the gemm epilogue and its derivative (Activations.h)
         InitializationMode initMode; // Initialization Mode picked based on the activation function
+        Math::Layout layout; // Layout of Aprev, Z, A and their gradients; W is (outNodes x inNodes) in both
+        Math::Precision precision; // BFloat16: the gemms read W16 and the caches are Z16 / A16, Z and A stay empty
 
+        // W and b live in the parameter arena of the NeuralNetwork, dW and db in its gradient arena (placeParameters).
+        // Only ever write into them in place: the allocator propagates on move assignment, so assigning a new matrix
+        // would silently take it out of the arena (the update sweep would miss it), and as the arena has no upstream
+        // a reallocation throws bad_alloc. Their shapes never change, so the Into / in place kernels never reallocate
         Math::Matrix<T> W; // Weights; Shape (outNodes x inNodes)
-        Math::Matrix<T> b; // Biases; Shape (outNodes x 1) only one per Node
-        Math::Matrix<T> Z; // Cache for backprop, pre activation; Shape (outNodes x m); Z = W * Aprev + b
-        Math::Matrix<T> dZ; // Cache for inspection; Can be kept in backward function
-        Math::Matrix<T> A; // Cache for A; Z after Activation; Shape (outNodes x m); A = activation(Z)
-        // Math::Matrix<T> dAprev; // Cache for inspection; Is returned from backward function
+        Math::Matrix<T> b; // Biases; Shape (outNodes x 1) only one per Node, (1 x outNodes) sample-major
+        // Full precision caches. Which ones are kept follows from the activation (DerivativeCache): Z only if the
+        // derivative reads it, A always (input of the next layer, Yhat of the last). backward writes dZ over the cache
+        // its derivative read (Z, else A), so after backward neither holds the forward values anymore
+        Math::Matrix<T> Z; // Pre activation; Shape (outNodes x m); Z = W * Aprev + b (sample-major (m x outNodes), Aprev * W^T + b)
+        Math::Matrix<T> A; // Z after Activation; Shape (outNodes x m); A = activation(Z)
+        Math::Matrix<T> dZ; // BFloat16 mode only, see below
         Math::Matrix<T> dW; // Shape (outNodes x inNodes)
         Math::Matrix<T> db; // Shape (outNodes x 1)
-        Math::Matrix<T> Aprev; // Cache for backprop, input to this layer; Shape (inNodes x m)
+        Math::MatrixView<const T> Aprev; // Input to this layer (not a copy), has to stay alive until backward; Shape (inNodes x m)
+        const Math::SparseMatrix<T>* sparsePrev = nullptr; // instead of Aprev if forward got a sparse input, same lifetime rule
+
+        // Precision::BFloat16 only. W stays the T master copy the updates go to, W16 is refreshed after every change.
+        // dZ doubles as the T scratch of forward (pre activation, then activation), it's overwritten in backward anyway
+        Math::Matrix<Math::bfloat16> W16;
+        Math::Matrix<Math::bfloat16> Z16; // only for the derivatives that read Z (DerivativeCache::Z)
+        Math::Matrix<Math::bfloat16> A16;
+        Math::MatrixView<const Math::bfloat16> Aprev16;
 
+        void fillWeights(std::normal_distribution<T>& norm);
         void xavierInitializer();
         void heInitializer();
         void lecunInitializer();
-        Math::Matrix<T> applyActivation(const Math::Matrix<T>&) const;
-        Math::Matrix<T> applyDerivative() const;
-
-        Math::Matrix<T> linearDerivative(std::size_t, std::size_t, std::size_t) const;
-        Math::Matrix<T> sigmoidDerivative() const;
-        Math::Matrix<T> tanhDerivative() const;
-        Math::Matrix<T> reluDerivative() const;
-        Math::Matrix<T> eluDerivative(T) const;
-        Math::Matrix<T> softplusDerivative() const;
-        [[maybe_unused]] Math::Matrix<T> mishDerivative() const;
-        [[maybe_unused]] Math::Matrix<T> deluDerivative() const;
+        void applyDerivative(Math::MatrixView<const T> dA, Math::Matrix<T>& out, Math::Matrix<T>& _db) const; // out = dA * activation'(Z), _db its sample mean
+        [[nodiscard]] bool derivativeReadsZ() const noexcept;
+
+        // Z = W * Aprev + b (sample-major Aprev * W^T + b) and f(Z) into A (nullptr: over Z), bias and f fused into the
+        // gemm epilogue. S is T or bfloat16, Aprev a view of S or a SparseMatrix<T>
+        template<class S, class In>
+        void affine(const In& _Aprev, Math::MatrixView<const S> _W, Math::Matrix<T>& _Z, Math::Matrix<T>* _A, Math::Gemm::Activation f) const;
+        // dW and, unless _dAprev is empty, dAprev from dZ
+        template<class S, class In>
+        void gradients(Math::MatrixView<const T> _dZ, const In& _Aprev, Math::MatrixView<const S> _W, std::size_t samples,
+                       Math::MatrixView<T> _dAprev);
 
     public:
-        explicit DenseLayer(std::size_t _inNodes, std::size_t _outNodes, NeuralNetworks::ActivationTypes _act, std::mt19937& gen, bool initializeInConstructor = true); // Constructor
-        [[nodiscard]] Math::Matrix<T> forward(const Math::Matrix<T>& Aprev); // Returns A, stores Aprev and Z
-        [[nodiscard]] Math::Matrix<T> backward(const Math::Matrix<T>& dA, bool treatInputAsdZ = false); // Returns dA_prev; also computs dW, db stored  internally for updated
-        [[nodiscard]] std::size_t getinNodes() noexcept;
-        [[nodiscard]] std::size_t getoutNodes() noexcept;
-        [[nodiscard]] ActivationTypes getActivation() noexcept;
-        [[nodiscard]] Math::Matrix<T> getA() noexcept;
+        explicit DenseLayer(std::size_t _inNodes, std::size_t _outNodes, NeuralNetworks::ActivationTypes _act, std::mt19937& gen, bool initializeInConstructor = true,
+                            Math::Layout _layout = Math::Layout::FeatureMajor, Math::Precision _precision = Math::Precision::Full); // Constructor
+        [[nodiscard]] const Math::Matrix<T>& forward(Math::MatrixView<const T> Aprev); // Returns A (valid until backward), keeps a view of Aprev
+        [[nodiscard]] const Math::Matrix<Math::bfloat16>& forward(Math::MatrixView<const Math::bfloat16> Aprev); // Same in BFloat16 mode
+        // Sparse input of the first layer (Full precision): forward and dW cost outNodes * nonZeros instead of
+        // outNodes * inNodes * m, backward computes no dAprev since nothing reads the gradient of the input
+        [[nodiscard]] const Math::Matrix<T>& forward(const Math::SparseMatrix<T>& Aprev);
+        // forward once more from the input the last forward kept (dense or sparse), for checkpointing: the input has to
+        // hold the same values again by then
+        [[nodiscard]] const Math::Matrix<T>& recompute();
+        // Points the kept input view at Aprev, same shape and the values the last forward read, without running forward
+        // again (checkpointing: the layer before recomputed its A into another buffer)
+        void rebindInput(Math::MatrixView<const T> Aprev);
+        // Swaps Z and A with the ones of cache, no copies; the view the next layer holds of A keeps pointing at the same
+        // memory, wherever it is owned now
+        void exchangeCache(ActivationCache<T>& cache) noexcept;
+        // Bytes of A and Z (if the derivative reads it) for a batch of m samples, without the padding
+        [[nodiscard]] std::size_t cacheBytes(std::size_t samples) const noexcept;
+        // Inference only: out = f(W * Aprev + b) (sample-major f(Aprev * W^T + b)) with nothing cached, so several threads
+        // can run it at once. out has the shape of A already, e.g. the top rows of a bigger buffer; BFloat16 mode
+        // multiplies with W16, the activations stay T
+        void infer(Math::MatrixView<const T> Aprev, Math::MatrixView<T> out) const;
+        // Writes dA_prev into dAprev (the shape of Aprev, e.g. the top rows of a bigger buffer; an empty view skips it,
+        // as for the first layer or a sparse input); also computs dW, db stored  internally for updated
+        void backward(Math::MatrixView<const T> dA, Math::MatrixView<T> dAprev, bool treatInputAsdZ = false);
+        [[nodiscard]] std::size_t getinNodes() const noexcept;
+        [[nodiscard]] std::size_t getoutNodes() const noexcept;
+        [[nodiscard]] ActivationTypes getActivation() const noexcept;
+        [[nodiscard]] const Math::Matrix<T>& getW() const noexcept;
+        [[nodiscard]] const Math::Matrix<T>& getB() const noexcept; // (outNodes x 1), (1 x outNodes) sample-major
+        [[nodiscard]] Math::Matrix<T> getA() const; // between forward and backward, widened in BFloat16 mode
+        [[nodiscard]] Math::Precision getPrecision() const noexcept;
 
 
-        void update(T lr); //SGD step: W -= learningRate*dW; b -= learningRate*db
+        void syncWeights(); // W16 = W in BFloat16 mode, after W changed (NeuralNetwork::update, setParameters)
+        // Moves W and b into parameters and dW and db into gradients (in this order), values and shapes stay. A
+        // NeuralNetwork places every layer in its arenas this way
+        void placeParameters(std::pmr::memory_resource* parameters, std::pmr::memory_resource* gradients);
+        // Whether W and b lie inside the parameters buffer and dW and db inside the gradients buffer
+        [[nodiscard]] bool placedIn(Math::MatrixView<const T> parameters, Math::MatrixView<const T> gradients) const noexcept;
         void initialize();
     };
 
 
 
+    extern template void activate<float>(ActivationTypes, const Math::Matrix<float>&, Math::Matrix<float>&);
+    extern template void activate<double>(ActivationTypes, const Math::Matrix<double>&, Math::Matrix<double>&);
     extern template class NeuralNetworks::DenseLayer<float>;
     extern template class NeuralNetworks::DenseLayer<double>;
 } // NeuralNetworks
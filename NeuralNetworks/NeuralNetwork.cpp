@@ -4,94 +4,463 @@
 
 #include "NeuralNetwork.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "../Math/Elementwise.h"
+#include "../Math/Statistics.h"
 
 namespace NeuralNetworks {
     template<Math::floatTypes T>
-    NeuralNetwork<T>::NeuralNetwork(LossType _loss, double _learningRate, std::size_t _epochs, std::size_t _batchSize, std::size_t rngSeed)
-        : loss(_loss), learningRate(_learningRate), epochs(_epochs), batchSize(_batchSize) {
+    NeuralNetwork<T>::NeuralNetwork(LossType _loss, double _learningRate, std::size_t _epochs, std::size_t _batchSize, std::size_t rngSeed, Math::Layout _layout,
+                                     Math::Precision _precision)
+        : loss(_loss), learningRate(_learningRate), epochs(_epochs), batchSize(_batchSize), layout(_layout), precision(_precision) {
         this->gen = std::mt19937 {static_cast<uint32_t>(rngSeed)};
     }
 
+    template<Math::floatTypes T>
+    NeuralNetwork<T>::NeuralNetwork(const NeuralNetwork& other)
+        : layers(other.layers), loss(other.loss), learningRate(other.learningRate), epochs(other.epochs), batchSize(other.batchSize),
+          layout(other.layout), precision(other.precision), X16(other.X16), Yhat16(other.Yhat16), dALast(other.dALast),
+          dAprevPing(other.dAprevPing), dAprevPong(other.dAprevPong), checkpoints(other.checkpoints),
+          recomputeCaches(other.recomputeCaches), cacheSlots(other.cacheSlots), cachesLent(other.cachesLent), gen(other.gen) {
+        if(!this->layers.empty())
+            this->placeParameters(); // the copied W, b, dW and db are on the default resource until here
+    }
+
+    template<Math::floatTypes T>
+    NeuralNetwork<T>& NeuralNetwork<T>::operator=(const NeuralNetwork& other) {
+        if(this != &other)
+            *this = NeuralNetwork(other);
+        return *this;
+    }
+
+    template<Math::floatTypes T>
+    NeuralNetwork<T>& NeuralNetwork<T>::operator=(NeuralNetwork&& other) noexcept {
+        if(this == &other)
+            return *this;
+        this->layers.clear(); // while the arenas their matrices came from are still alive
+        this->parameters = std::move(other.parameters);
+        this->gradients = std::move(other.gradients);
+        this->layers = std::move(other.layers);
+        this->loss = other.loss;
+        this->learningRate = other.learningRate;
+        this->epochs = other.epochs;
+        this->batchSize = other.batchSize;
+        this->layout = other.layout;
+        this->precision = other.precision;
+        this->X16 = std::move(other.X16);
+        this->Yhat16 = std::move(other.Yhat16);
+        this->dALast = std::move(other.dALast);
+        this->dAprevPing = std::move(other.dAprevPing);
+        this->dAprevPong = std::move(other.dAprevPong);
+        this->checkpoints = std::move(other.checkpoints);
+        this->recomputeCaches = std::move(other.recomputeCaches);
+        this->cacheSlots = std::move(other.cacheSlots);
+        this->cachesLent = other.cachesLent;
+        this->gen = other.gen;
+        return *this;
+    }
+
     template<Math::floatTypes T>
     void NeuralNetwork<T>::AddDenseLayer(std::size_t inNodes, std::size_t outNodes, ActivationTypes act, bool initializeConstructor) {
         if(!this->layers.empty())
             if(inNodes != this->layers.back().getoutNodes())
                 throw std::logic_error("inNodes does not match outNodes of last layer");
 
-        this->layers.emplace_back(inNodes, outNodes, act, this->gen, initializeConstructor);
+        this->returnCaches(); // the new layer ends the last segment
+        this->layers.emplace_back(inNodes, outNodes, act, this->gen, initializeConstructor, this->layout, this->precision);
+        this->placeParameters();
+        this->assignCacheSlots();
     }
 
+    // New arenas sized to every layer, each matrix rounded up to the alignment the resource hands out. Both get the
+    // same matrix shapes in the same order, so dW and db end up at the offsets of W and b. The old arenas live until
+    // every matrix moved out of them
     template<Math::floatTypes T>
-    Math::Matrix<T> NeuralNetwork<T>::forward(const Math::Matrix<T> &X) {
+    void NeuralNetwork<T>::placeParameters() {
+        std::size_t bytes = 0;
+        const auto add = [&bytes](const Math::Matrix<T>& M) {
+            bytes += (M.bufferSize() * sizeof(T) + Math::Memory::alignment - 1) / Math::Memory::alignment * Math::Memory::alignment;
+        };
+        for(const auto& layer : this->layers) {
+            add(layer.getW());
+            add(layer.getB());
+        }
+
+        const auto arena = [bytes] {
+            Arena a{Math::Matrix<T>(1, bytes / sizeof(T)), nullptr}; // zeroed, the gaps stay 0
+            a.resource = std::make_unique<std::pmr::monotonic_buffer_resource>(a.block.data().data(), a.block.bufferSize() * sizeof(T),
+                                                                               std::pmr::null_memory_resource());
+            return a;
+        };
+        Arena newParameters = arena(), newGradients = arena();
+        for(auto& layer : this->layers)
+            layer.placeParameters(newParameters.resource.get(), newGradients.resource.get());
+        this->parameters = std::move(newParameters);
+        this->gradients = std::move(newGradients);
+        this->checkArenas();
+    }
+
+    // The update sweep and getParameters only see what is inside the blocks, a matrix that moved out of its arena would
+    // silently stop training. A few pointer compares per layer
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::checkArenas() const {
+        for(const auto& layer : this->layers)
+            if(!layer.placedIn(this->parameters.block, this->gradients.block))
+                throw std::logic_error("A layer's W, b, dW or db is not inside the arenas of the network anymore");
+    }
+
+    template<Math::floatTypes T>
+    const Math::Matrix<T>& NeuralNetwork<T>::forward(Math::MatrixView<const T> X) {
         if(this->layers.size() < 1)
             throw std::logic_error("Not enough layers in the Network");
 
-        if(X.rows() != this->layers.front().getinNodes())
+        if(Math::featureCount(X, this->layout) != this->layers.front().getinNodes())
             throw std::logic_error("Input data does not match first layer shape");
 
-        auto A = this->layers[0].forward(X);
+        if(this->precision == Math::Precision::BFloat16) { // X is narrowed once, the layers pass bfloat16 activations on
+            Math::narrowInto<T>(this->X16, X);
+            Math::MatrixView<const Math::bfloat16> A16 = this->X16;
+            for(auto& layer : this->layers)
+                A16 = layer.forward(A16);
+
+            Math::widenInto(this->Yhat16, A16);
+            return this->Yhat16;
+        }
+
+        if(!this->checkpoints.empty())
+            return this->forwardCheckpointed(X);
+
+        // Every layer reads the A buffer of the one before, nothing gets copied
+        const Math::Matrix<T>* A = nullptr;
+        Math::MatrixView<const T> Aprev = X;
+        for(auto& layer : this->layers) {
+            A = &layer.forward(Aprev);
+            Aprev = *A;
+        }
+
+        return *A; // Y-Hat from last layer shape (n_L x m)
+    }
+
+    template<Math::floatTypes T>
+    const Math::Matrix<T>& NeuralNetwork<T>::forward(const Math::SparseMatrix<T>& X) {
+        if(this->layers.size() < 1)
+            throw std::logic_error("Not enough layers in the Network");
+
+        if(Math::featureCount(X, this->layout) != this->layers.front().getinNodes())
+            throw std::logic_error("Input data does not match first layer shape");
+
+        if(this->precision != Math::Precision::Full)
+            throw std::logic_error("A sparse input needs Full precision");
+
+        if(!this->checkpoints.empty())
+            return this->forwardCheckpointed(X);
+
+        // Only the first layer sees the sparse X, its A is dense
+        const Math::Matrix<T>* A = &this->layers.front().forward(X);
+        for(std::size_t i = 1; i < this->layers.size(); i++)
+            A = &this->layers[i].forward(*A);
+
+        return *A;
+    }
+
+    template<Math::floatTypes T>
+    std::size_t NeuralNetwork<T>::segmentBegin(std::size_t layer) const noexcept {
+        if(this->checkpoints.empty())
+            return layer;
+        const auto next = std::ranges::lower_bound(this->checkpoints, layer);
+        return next == this->checkpoints.begin() ? 0 : *std::prev(next) + 1;
+    }
+
+    template<Math::floatTypes T>
+    std::size_t NeuralNetwork<T>::segmentEnd(std::size_t layer) const noexcept {
+        if(this->checkpoints.empty())
+            return layer + 1;
+        const auto next = std::ranges::lower_bound(this->checkpoints, layer);
+        return next == this->checkpoints.end() ? this->layers.size() : *next + 1;
+    }
+
+    // Segment by segment, every layer but the checkpoint at the end borrows the caches of its place. They go back right
+    // after forward, the ones of the last segment only after backward: nothing runs after them, no need to recompute
+    template<Math::floatTypes T>
+    template<class In>
+    const Math::Matrix<T>& NeuralNetwork<T>::forwardCheckpointed(const In& X) {
+        this->returnCaches();
+        // The views of A point at the buffers wherever they are owned, the last layer keeps its A
+        const std::size_t L = this->layers.size();
+        const Math::Matrix<T>* A = nullptr;
+        Math::MatrixView<const T> Aprev;
+        for(std::size_t begin = 0, end; begin < L; begin = end) {
+            end = this->segmentEnd(begin);
+            for(std::size_t i = begin; i < end; i++) {
+                const bool lent = i + 1 < end;
+                if(lent)
+                    this->layers[i].exchangeCache(this->recomputeCaches[this->cacheSlots[i]]);
+                A = i == 0 ? &this->layers[i].forward(X) : &this->layers[i].forward(Aprev);
+                Aprev = *A;
+                if(lent && end < L)
+                    this->layers[i].exchangeCache(this->recomputeCaches[this->cacheSlots[i]]);
+            }
+        }
+        this->cachesLent = true;
+        return *A;
+    }
+
+    // forward once more through the lent layers of [begin, end) from the checkpoint before them, the caches get lent
+    // again until backward. The checkpoint at end - 1 kept its Z and A, it only gets its input view pointed at the
+    // recomputed A (the buffer may be another one than in forward)
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::recomputeSegment(std::size_t begin, std::size_t end) {
+        Math::MatrixView<const T> A;
+        for(std::size_t i = begin; i + 1 < end; i++) {
+            this->layers[i].exchangeCache(this->recomputeCaches[this->cacheSlots[i]]);
+            A = i == begin ? this->layers[i].recompute() : this->layers[i].forward(A);
+        }
+        this->layers[end - 1].rebindInput(A);
+    }
+
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::returnCaches() noexcept {
+        if(!this->cachesLent)
+            return;
+        const std::size_t last = this->layers.size() - 1, begin = this->segmentBegin(last);
+        for(std::size_t i = begin; i < last; i++)
+            this->layers[i].exchangeCache(this->recomputeCaches[this->cacheSlots[i]]);
+        this->cachesLent = false;
+    }
+
+    // Greedy: every lent layer takes the first slot of its width that no layer before it in the segment took. The layers
+    // that borrow from now on drop what they kept so far (after a new policy, or the old last layer after AddDenseLayer)
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::assignCacheSlots() {
+        this->returnCaches();
+        const std::size_t L = this->layers.size();
+        std::vector<std::size_t> widths; // per slot
+        this->cacheSlots.assign(L, 0);
+        for(std::size_t begin = 0, end; begin < L; begin = end) {
+            end = this->segmentEnd(begin);
+            std::vector<bool> taken(widths.size(), false);
+            for(std::size_t i = begin; i + 1 < end; i++) {
+                const std::size_t width = this->layers[i].getoutNodes();
+                std::size_t slot = 0;
+                while(slot < widths.size() && (taken[slot] || widths[slot] != width))
+                    slot++;
+                if(slot == widths.size()) {
+                    widths.push_back(width);
+                    taken.push_back(false);
+                }
+                taken[slot] = true;
+                this->cacheSlots[i] = slot;
+                ActivationCache<T> released;
+                this->layers[i].exchangeCache(released);
+            }
+        }
+        this->recomputeCaches.resize(widths.size());
+    }
+
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::checkpointEvery(std::size_t k) {
+        const std::size_t L = this->layers.size();
+        if(k == 0)
+            k = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(L)))));
+
+        std::vector<std::size_t> layerIndices;
+        if(k > 1)
+            for(std::size_t i = k - 1; i < L; i += k)
+                layerIndices.push_back(i);
+        this->checkpointAt(std::move(layerIndices));
+    }
+
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::checkpointAt(std::vector<std::size_t> layerIndices) {
+        if(this->precision != Math::Precision::Full)
+            throw std::logic_error("Checkpointing needs Full precision");
+
+        std::ranges::sort(layerIndices);
+        const auto [first, last] = std::ranges::unique(layerIndices);
+        layerIndices.erase(first, last);
+        if(!layerIndices.empty() && layerIndices.back() >= this->layers.size())
+            throw std::logic_error("Checkpoint after the last layer");
+
+        if(!layerIndices.empty() && layerIndices.back() + 1 == this->layers.size())
+            layerIndices.pop_back(); // the last layer always is one
+        if(layerIndices.size() + 1 == this->layers.size())
+            layerIndices.clear(); // every layer keeps its caches anyway
+
+        this->returnCaches();
+        this->checkpoints = std::move(layerIndices);
+        this->assignCacheSlots();
+    }
+
+    template<Math::floatTypes T>
+    const std::vector<std::size_t>& NeuralNetwork<T>::getCheckpoints() const noexcept {
+        return this->checkpoints;
+    }
+
+    // A lent cache is as big as the biggest layer that borrows it; the recomputed work is the lent layers of every
+    // segment but the last. Both ways backward runs through the two dAprev buffers
+    template<Math::floatTypes T>
+    typename NeuralNetwork<T>::CheckpointEstimate NeuralNetwork<T>::estimateCheckpointing(std::size_t samples) const {
+        const std::size_t L = this->layers.size();
+        std::vector<std::size_t> lentBytes(this->recomputeCaches.size(), 0);
+        std::size_t keptBytes = 0, fullBytes = 0, widest = 0;
+        double forwardWork = 0.0, recomputedWork = 0.0;
+        for(std::size_t begin = 0, end; begin < L; begin = end) {
+            end = this->segmentEnd(begin);
+            for(std::size_t i = begin; i < end; i++) {
+                const auto& layer = this->layers[i];
+                const std::size_t bytes = layer.cacheBytes(samples);
+                const double work = static_cast<double>(layer.getinNodes()) * static_cast<double>(layer.getoutNodes());
+                fullBytes += bytes;
+                forwardWork += work;
+                if(i + 1 < end)
+                    lentBytes[this->cacheSlots[i]] = std::max(lentBytes[this->cacheSlots[i]], bytes);
+                else
+                    keptBytes += bytes;
+                if(end < L && i + 1 < end)
+                    recomputedWork += work;
+                if(i > 0)
+                    widest = std::max(widest, layer.getinNodes());
+            }
+        }
+        for(const std::size_t bytes : lentBytes)
+            keptBytes += bytes;
+        const std::size_t gradientBytes = 2 * widest * samples * sizeof(T);
+
+        const double extraForward = forwardWork > 0.0 ? recomputedWork / forwardWork : 0.0;
+        return {keptBytes + gradientBytes, fullBytes + gradientBytes, extraForward, extraForward / 3.0};
+    }
+
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::predictInto(Math::Matrix<T>& Yhat, Math::MatrixView<const T> X, PredictBuffers& buffers) const {
+        if(this->layers.size() < 1)
+            throw std::logic_error("Not enough layers in the Network");
+
+        if(Math::featureCount(X, this->layout) != this->layers.front().getinNodes())
+            throw std::logic_error("Input data does not match first layer shape");
 
-        for(std::size_t i = 1; i < this->layers.size(); i++) {
-            A = this->layers[i].forward(A);
+        const std::size_t m = Math::sampleCount(X, this->layout);
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+        const auto rowsOf = [&](std::size_t features) { return featureMajor ? features : m; };
+        const auto colsOf = [&](std::size_t features) { return featureMajor ? m : features; };
+
+        // An activation with n features is the top n rows (sample-major: the left n columns) of a buffer
+        std::size_t widest = 0;
+        for(std::size_t i = 0; i + 1 < this->layers.size(); i++)
+            widest = std::max(widest, this->layers[i].getoutNodes());
+        if(widest > 0) {
+            for(Math::Matrix<T>* buffer : {&buffers.ping, &buffers.pong})
+                if(buffer->rows() < rowsOf(widest) || buffer->cols() < colsOf(widest))
+                    *buffer = Math::Matrix<T>(rowsOf(widest), colsOf(widest), Math::uninitialized, 0, buffer->resource());
         }
+        const std::size_t outputs = this->layers.back().getoutNodes();
+        if(Yhat.rows() != rowsOf(outputs) || Yhat.cols() != colsOf(outputs))
+            Yhat = Math::Matrix<T>(rowsOf(outputs), colsOf(outputs), Math::uninitialized, 0, Yhat.resource());
+
+        Math::MatrixView<const T> Aprev = X;
+        for(std::size_t i = 0; i < this->layers.size(); i++) {
+            Math::MatrixView<T> A = Yhat;
+            if(i + 1 < this->layers.size()) {
+                Math::Matrix<T>& buffer = i % 2 == 0 ? buffers.ping : buffers.pong;
+                const std::size_t features = this->layers[i].getoutNodes();
+                A = Math::MatrixView<T>(buffer.data().data(), rowsOf(features), colsOf(features), buffer.stride());
+            }
+            this->layers[i].infer(Aprev, A);
+            Aprev = A;
+        }
+    }
 
-        return A; // Y-Hat from last layer shape (n_L x m)
+    template<Math::floatTypes T>
+    Math::Matrix<T> NeuralNetwork<T>::predict(Math::MatrixView<const T> X) const {
+        Math::Matrix<T> Yhat;
+        PredictBuffers buffers;
+        this->predictInto(Yhat, X, buffers);
+        return Yhat;
     }
 
     template<Math::floatTypes T>
-    void NeuralNetwork<T>::backward(const Math::Matrix<T> &Y, const Math::Matrix<T> &Yhat) {
+    void NeuralNetwork<T>::backward(Math::MatrixView<const T> Y, Math::MatrixView<const T> Yhat) {
         if(Y.rows() != Yhat.rows() || Y.cols() != Yhat.cols())
             throw std::logic_error("Y and Yhat shapes are not matching");
 
         if(this->layers.size() == 0)
             throw std::logic_error("Layer count is zero");
 
-        if(Y.cols() == 0)
-            throw std::logic_error("Y columns can't be zero");
+        if(Math::sampleCount(Y, this->layout) == 0)
+            throw std::logic_error("Y can't have zero samples");
 
         // auto m = static_cast<T>(Y.cols());
-        Math::Matrix<T> dALast;
+        // dALast and the two dAprev buffers get overwritten in place, dA only views them
+        const auto y = Math::lazy(Y);
 
-        if(this->loss == LossType::MSE) {
-            dALast = (Yhat.sub(Y)).scalarMul(T{2}); // TODO: Check if it was correct to remove /m (reason being layer does also /m so it would become m^2)
-        } else { //BCE
-            auto onesSizeY = Y;
-            onesSizeY.fill(T{1});
-            auto p = Yhat.clip(1e-7);
-            auto onesSizep = p;
-            onesSizep.fill(T{1});
-
-            auto term1 = Y.scalarMul(-1).divide(p);
-            auto term2 = onesSizeY.sub(Y).divide(onesSizep.sub(p));
-
-            dALast = (term1.add(term2)).scalarMul((T{1})); //TODO: Same check for /m as in MSE
+        const bool lastTakesdZ = this->loss == LossType::BCE && this->layers.back().getActivation() == ActivationTypes::Sigmoid;
+        if(lastTakesdZ) {
+            // BCE + Sigmoid trick, dZ = A - Y
+            this->dALast = Math::lazy(Yhat) - y;
+        } else {
+            if(this->loss == LossType::MSE) {
+                this->dALast = (Math::lazy(Yhat) - y) * T{2}; // TODO: Check if it was correct to remove /m (reason being layer does also /m so it would become m^2)
+            } else { //BCE
+                // -Y / p + (1 - Y) / (1 - p), fused into a single pass
+                const auto p = Math::Expr::clip(Math::lazy(Yhat), T{1e-7});
+                this->dALast = Math::Expr::divide(-y, p) + Math::Expr::divide(T{1} - y, T{1} - p); //TODO: Same check for /m as in MSE
+            }
         }
 
-        Math::Matrix<T> dA;
-
-        if(this->loss == LossType::BCE && this->layers.back().getActivation() == ActivationTypes::Sigmoid) {
-            Math::Matrix<T> dZLast = layers.back().getA().sub(Y);
-            dA = layers.back().backward(dZLast, true);
-        } else {
-            dA = layers.back().backward(dALast);
+        // dAprev of layer i is the top rows (sample-major: the left columns) of one of the two buffers, the next layer
+        // down reads it as dA while it writes into the other one. The first layer computes none
+        const std::size_t L = this->layers.size(), m = Math::sampleCount(Y, this->layout);
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+        const auto rowsOf = [&](std::size_t features) { return featureMajor ? features : m; };
+        const auto colsOf = [&](std::size_t features) { return featureMajor ? m : features; };
+        std::size_t widest = 0;
+        for(std::size_t i = 1; i < L; i++)
+            widest = std::max(widest, this->layers[i].getinNodes());
+        if(widest > 0) {
+            for(Math::Matrix<T>* buffer : {&this->dAprevPing, &this->dAprevPong})
+                if(buffer->rows() < rowsOf(widest) || buffer->cols() < colsOf(widest))
+                    *buffer = Math::Matrix<T>(rowsOf(widest), colsOf(widest), Math::uninitialized, 0, buffer->resource());
         }
 
-        for(int i =this->layers.size()-2; i >= 0; i--) {
-            dA = layers[i].backward(dA);
+        // Segment by segment from the back, every layer is one of its own without checkpointing. The segments before
+        // the last get their caches back by a second forward from the checkpoint before them, then return them
+        Math::MatrixView<const T> dA = this->dALast;
+        for(std::size_t end = L, begin; end > 0; end = begin) {
+            begin = this->segmentBegin(end - 1);
+            if(end < L && end - begin > 1)
+                this->recomputeSegment(begin, end);
+            for(std::size_t i = end; i-- > begin;) {
+                Math::MatrixView<T> dAprev;
+                if(i > 0) {
+                    Math::Matrix<T>& buffer = i % 2 == 0 ? this->dAprevPing : this->dAprevPong;
+                    const std::size_t features = this->layers[i].getinNodes();
+                    dAprev = Math::MatrixView<T>(buffer.data().data(), rowsOf(features), colsOf(features), buffer.stride());
+                }
+                this->layers[i].backward(dA, dAprev, i + 1 == L && lastTakesdZ);
+                dA = dAprev;
+                if(i + 1 < end)
+                    this->layers[i].exchangeCache(this->recomputeCaches[this->cacheSlots[i]]);
+            }
         }
+        this->cachesLent = false;
     }
 
     // TODO: Implement batching
     template<Math::floatTypes T>
-    T NeuralNetwork<T>::train(const Math::Matrix<T> &X, const Math::Matrix<T> &Y, bool timeExecution, bool printLoss, std::size_t printLossEveryXEpoch, bool exportLoss, std::size_t exportLossEveryXEpoch) {
+    template<class In>
+    T NeuralNetwork<T>::trainOn(const In& X, Math::MatrixView<const T> Y, bool timeExecution, bool printLoss, std::size_t printLossEveryXEpoch) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
         // std::vector<size_t> idx(X.rows());
         // std::iota(std::begin(idx), std::end(idx), 0);
 
         for(std::size_t epoch = 0; epoch < this->epochs; epoch++) {
-            auto Yhat = this->forward(X);
+            const auto& Yhat = this->forward(X);
             if(printLoss)
                 if(epoch % printLossEveryXEpoch == 0)
                     std::printf("Loss: %lf \n", this->compute_loss(Y, Yhat));
@@ -103,94 +472,112 @@ namespace NeuralNetworks {
         if(timeExecution)
             std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime) << std::endl;
 
-        auto Yhat = this->forward(X);
+        const auto& Yhat = this->forward(X);
         return this->compute_loss(Y, Yhat);
     }
 
+    template<Math::floatTypes T>
+    T NeuralNetwork<T>::train(Math::MatrixView<const T> X, Math::MatrixView<const T> Y, bool timeExecution, bool printLoss, std::size_t printLossEveryXEpoch, bool, std::size_t) {
+        return this->trainOn(X, Y, timeExecution, printLoss, printLossEveryXEpoch);
+    }
+
+    template<Math::floatTypes T>
+    T NeuralNetwork<T>::train(const Math::SparseMatrix<T>& X, Math::MatrixView<const T> Y, bool timeExecution, bool printLoss, std::size_t printLossEveryXEpoch) {
+        return this->trainOn(X, Y, timeExecution, printLoss, printLossEveryXEpoch);
+    }
+
     // TODO: Should I shuffle the Data first before splitting?
     template<Math::floatTypes T>
     std::tuple<Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>> NeuralNetwork<T>::trainTestSplit(
-        const Math::Matrix<T> &X, const Math::Matrix<T> &Y, const float trainSizeFloat) {
+        Math::MatrixView<const T> X, Math::MatrixView<const T> Y, const float trainSizeFloat) {
 
-        const std::size_t N = X.cols();
+        const std::size_t N = Math::sampleCount(X, this->layout);
+        if(Math::sampleCount(Y, this->layout) != N)
+            throw std::logic_error("X and Y don't have the same amount of samples");
 
-        auto endTrain = std::floor(trainSizeFloat * static_cast<float>(N));
+        const auto endTrain = static_cast<std::size_t>(std::floor(trainSizeFloat * static_cast<float>(N)));
 
-        auto startTest = endTrain + 1;
-        auto endTest = N;
+        const auto startTest = endTrain + 1;
+        const auto endTest = N;
+        if(endTrain == 0 || startTest >= endTest)
+            throw std::logic_error("trainSizeFloat leaves the train or test set empty");
 
-        Math::Matrix<T> XTrain(X.rows(), endTrain, 0);
-        Math::Matrix<T> YTrain(Y.rows(), endTrain, 0);
-
-        Math::Matrix<T> XTest(X.rows(), endTest - startTest, 0);
-        Math::Matrix<T> YTest(Y.rows(), endTest - startTest, 0);
+        // Both sets are sample ranges (columns or rows); copied once here because the scalers modify them
+        const std::size_t testSize = endTest - startTest;
+        return {Math::Matrix<T>(Math::sampleRange(X, this->layout, 0, endTrain)), Math::Matrix<T>(Math::sampleRange(Y, this->layout, 0, endTrain)),
+                Math::Matrix<T>(Math::sampleRange(X, this->layout, startTest, testSize)), Math::Matrix<T>(Math::sampleRange(Y, this->layout, startTest, testSize))};
+    }
 
-        for(int i = 0; i < endTrain; i++) {
-            for(int j = 0; j < X.rows(); j++) {
-                XTrain(j, i) = X(j, i);
+    namespace {
+        // x -> (x - center) * invScale for every feature of X (rows feature-major, columns sample-major), from one
+        // statistics pass and one pass to apply. A constant feature only gets centered
+        template<Math::floatTypes T>
+        void scaleFeatures(Math::MatrixView<T> X, ScalerType scaler, Math::Layout layout) {
+            const bool featureMajor = layout == Math::Layout::FeatureMajor;
+            const std::size_t features = Math::featureCount(X, layout);
+            std::vector<T> center(features), invScale(features);
+            auto setScale = [&](std::size_t f, T c, T scale) {
+                center[f] = c;
+                invScale[f] = scale > T{0} ? T{1} / scale : T{1};
+            };
+
+            if(scaler == ScalerType::robust) { // median and interquartile range
+                const T q[] = {T{0.25}, T{0.5}, T{0.75}};
+                const auto quantiles = featureMajor ? Math::rowQuantiles<T>(X, q) : Math::rowQuantiles<T>(Math::Matrix<T>(X).transpose(), q);
+                for(std::size_t f = 0; f < features; f++)
+                    setScale(f, quantiles(f, 1), quantiles(f, 2) - quantiles(f, 0));
+            } else if(scaler == ScalerType::zScore || scaler == ScalerType::minMax) {
+                const auto stats = featureMajor ? Math::rowStatistics<T>(X) : Math::columnStatistics<T>(X);
+                for(std::size_t f = 0; f < features; f++) {
+                    if(scaler == ScalerType::zScore)
+                        setScale(f, stats[f].mean, stats[f].stdDev());
+                    else
+                        setScale(f, stats[f].min, stats[f].max - stats[f].min); // to [0, 1]
+                }
+            } else {
+                throw std::logic_error("Scaler type unkown");
             }
-            for(int j = 0; j < Y.rows(); j++) {
-                YTrain(j, i) = Y(j, i);
-            }
-        }
 
-        for(int i = startTest; i < endTest; i++) {
-            for(int j = 0; j < X.rows(); j++) {
-                XTest(j, i - startTest) = X(j, i);
-            }
-            for(int j = 0; j < Y.rows(); j++) {
-                YTest(j, i - startTest) = Y(j, i);
+            for(std::size_t r = 0; r < X.rows(); r++) {
+                T* row = X.data() + r * X.stride();
+                for(std::size_t c = 0; c < X.cols(); c++) {
+                    const std::size_t f = featureMajor ? r : c;
+                    row[c] = (row[c] - center[f]) * invScale[f];
+                }
             }
         }
-
-        return {XTrain, YTrain, XTest, YTest};
-    }
+    } // namespace
 
     template <Math::floatTypes T>
-    void NeuralNetwork<T>::inplaceScaleFeature(std::size_t featureIndex, Math::Matrix<T> &X, ScalerType scaler) {
-        if(featureIndex >= X.rows())
+    void NeuralNetwork<T>::inplaceScaleFeature(std::size_t featureIndex, Math::Matrix<T> &X, ScalerType scaler, Math::Layout layout) {
+        if(featureIndex >= Math::featureCount(X, layout))
             throw std::logic_error("Feature index out of bounds");
 
-        if(scaler == ScalerType::minMax) {
-            // TODO: Implement
-            throw std::logic_error("MinMax Scaler is not implemented");
-        } else if(scaler == ScalerType::robust) {
-            // TODO: Implement
-            throw std::logic_error("Robust Scaler is not implemented");
-        } else if(scaler == ScalerType::zScore) {
-            T meanVal = X.meanOfRow(featureIndex);
-            T stdDevVal = X.stdDevOfRow(featureIndex);
-
-            for(std::size_t i = 0; i < X.cols(); i++) {
-                X(featureIndex, i) = (X(featureIndex, i) - meanVal) / stdDevVal;
-            }
-        } else {
-            throw std::logic_error("Scaler type unkown");
-        }
+        const auto feature = layout == Math::Layout::FeatureMajor ? X.view().rowRange(featureIndex, 1) : X.view().colRange(featureIndex, 1);
+        scaleFeatures(feature, scaler, layout);
+    }
+
+    template <Math::floatTypes T>
+    void NeuralNetwork<T>::inplaceScaleFeatures(Math::Matrix<T> &X, ScalerType scaler, Math::Layout layout) {
+        scaleFeatures(X.view(), scaler, layout);
     }
 
     template<Math::floatTypes T>
-    T NeuralNetwork<T>::compute_loss(const Math::Matrix<T> &Y, const Math::Matrix<T> &Yhat) {
+    T NeuralNetwork<T>::compute_loss(Math::MatrixView<const T> Y, Math::MatrixView<const T> Yhat) {
         if(Y.rows() != Yhat.rows() || Y.cols() != Yhat.cols())
             throw std::logic_error("Y and Yhat shapes do not match");
 
         T lossVal;
+        const auto y = Math::lazy(Y);
         if(this->loss == LossType::MSE) {
-            auto tempMatrix = Yhat.sub(Y);
-            lossVal = tempMatrix.hadamard(tempMatrix).mean(); // mean((yhat-Y)^2)
+            const auto diff = Math::lazy(Yhat) - y;
+            lossVal = Math::Expr::mean(Math::Expr::hadamard(diff, diff)); // mean((yhat-Y)^2)
         } else if(this->loss == LossType::BCE) {
-            auto p = Yhat.clip(T{1e-7}); // 1e-7 from chatgpt
-            auto part1 = Y.hadamard(p.log(std::exp(1.0)));
-
-            auto onesSizeY = Y;
-            onesSizeY.fill((T{1}));
-
-            auto onesSizep = p;
-            onesSizep.fill((T{1}));
+            const auto p = Math::Expr::clip(Math::lazy(Yhat), T{1e-7}); // 1e-7 from chatgpt
+            const auto part1 = Math::Expr::hadamard(y, Math::Expr::log(p, std::exp(1.0)));
+            const auto part2 = Math::Expr::hadamard(T{1} - y, Math::Expr::log(T{1} - p, std::exp(1.0)));
 
-            auto part2 = (onesSizeY.sub(Y)).hadamard((onesSizep.sub(p)).log(std::exp(1.0)));
-
-            lossVal = -(part1.add(part2).mean());
+            lossVal = -Math::Expr::mean(part1 + part2);
         } else {
             lossVal = -std::numeric_limits<T>::infinity(); // Might be UB based on compiler flags :(
         }
@@ -198,11 +585,65 @@ namespace NeuralNetworks {
         return lossVal;
     }
 
+    // W -= lr * dW and b -= lr * db of every layer as one loop over the arenas; 0 - lr * 0 keeps the padding and the
+    // gaps at 0
     template<Math::floatTypes T>
     void NeuralNetwork<T>::update() {
-        for(auto& layer : this->layers) {
-            layer.update(this->learningRate);
-        }
+        if(this->layers.empty())
+            return;
+
+        this->checkArenas();
+        const T lr = static_cast<T>(this->learningRate);
+        Math::mapInto(this->parameters.block, [lr](T w, T g) { return w - g * lr; }, this->parameters.block, this->gradients.block);
+        for(auto& layer : this->layers)
+            layer.syncWeights();
+    }
+
+    template<Math::floatTypes T>
+    Math::MatrixView<const T> NeuralNetwork<T>::getParameters() const {
+        this->checkArenas();
+        return this->parameters.block;
+    }
+
+    template<Math::floatTypes T>
+    Math::MatrixView<const T> NeuralNetwork<T>::getGradients() const {
+        this->checkArenas();
+        return this->gradients.block;
+    }
+
+    template<Math::floatTypes T>
+    void NeuralNetwork<T>::setParameters(Math::MatrixView<const T> values) {
+        if(values.rows() != this->parameters.block.rows() || values.cols() != this->parameters.block.cols())
+            throw std::invalid_argument("values don't have the layout of the parameters");
+
+        this->checkArenas();
+        std::copy_n(values.data(), values.cols(), this->parameters.block.data().data());
+        for(auto& layer : this->layers)
+            layer.syncWeights();
+    }
+
+    template<Math::floatTypes T>
+    T NeuralNetwork<T>::gradientNorm() const {
+        if(this->layers.empty())
+            return T{0};
+
+        const auto g = Math::lazy(this->gradients.block);
+        return std::sqrt(Math::Expr::sum(Math::Expr::hadamard(g, g)));
+    }
+
+    template<Math::floatTypes T>
+    const std::vector<DenseLayer<T>>& NeuralNetwork<T>::getLayers() const noexcept {
+        return this->layers;
+    }
+
+    template<Math::floatTypes T>
+    Math::Layout NeuralNetwork<T>::getLayout() const noexcept {
+        return this->layout;
+    }
+
+    template<Math::floatTypes T>
+    LossType NeuralNetwork<T>::getLoss() const noexcept {
+        return this->loss;
     }
 
     template class NeuralNetworks::NeuralNetwork<float>;
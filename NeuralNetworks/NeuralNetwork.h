@@ -5,7 +5,12 @@
 #ifndef NEUROINFORMATICS_NEURALNETWORK_H
 #define NEUROINFORMATICS_NEURALNETWORK_H
 
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
 #include "../Math/Matrix.h"
+#include "../Math/SparseMatrix.h"
 #include "ActivationTypes.h"
 #include "DenseLayer.h"
 #include "LossType.h"
@@ -15,31 +20,137 @@ namespace NeuralNetworks {
     template<Math::floatTypes T>
     class NeuralNetwork {
     private:
+        // One aligned block (1 x n) handed out in order by a monotonic resource, rebuilt when a layer is added. Declared
+        // before the layers, whose matrices give their memory back to it
+        struct Arena {
+            Math::Matrix<T> block;
+            std::unique_ptr<std::pmr::monotonic_buffer_resource> resource;
+        };
+        Arena parameters; // W and b of every layer, layer by layer
+        Arena gradients; // dW and db, at the same offsets
+
         std::vector<DenseLayer<T>> layers;
         LossType loss;
         double learningRate;
         std::size_t epochs;
         std::size_t batchSize;
+        Math::Layout layout; // of X, Y and every activation
+        Math::Precision precision; // of the layers, BFloat16 narrows X into X16 and chains the bfloat16 activations
+        Math::Matrix<Math::bfloat16> X16; // input of the first layer in BFloat16 mode, kept until backward
+        Math::Matrix<T> Yhat16; // widened output in BFloat16 mode, the Full output is the A of the last layer
+        Math::Matrix<T> dALast; // loss gradient fed into the last layer; like every layer cache it keeps its buffer between steps
+        // dAprev of the layers in turn during backward (like the activations of predictInto), both sized to the widest
+        // hidden layer: the gradients between the layers take two buffers whatever the depth
+        Math::Matrix<T> dAprevPing, dAprevPong;
+
+        // Checkpointing: the layers that keep their caches from forward to backward, sorted. They end the segments, the
+        // last layer ends the last one (it's never in the list); empty when every layer keeps its own (no checkpointing)
+        std::vector<std::size_t> checkpoints;
+        std::vector<ActivationCache<T>> recomputeCaches; // lent to the other layers, see cacheSlots
+        // Per layer the index of the caches it borrows, only used for the layers between checkpoints. Layers of one
+        // segment get different ones, layers of different segments share one if they have the same width, so the
+        // buffers keep their shapes from segment to segment
+        std::vector<std::size_t> cacheSlots;
+        bool cachesLent = false; // the layers of the last segment hold theirs from forward until backward
 
         std::mt19937 gen;
 
+        template<class In>
+        T trainOn(const In& X, Math::MatrixView<const T> Y, bool timeExecution, bool printLoss, std::size_t printLossEveryXEpoch);
+
+        [[nodiscard]] std::size_t segmentBegin(std::size_t layer) const noexcept;
+        [[nodiscard]] std::size_t segmentEnd(std::size_t layer) const noexcept; // one past its checkpoint
+        template<class In>
+        const Math::Matrix<T>& forwardCheckpointed(const In& X);
+        void recomputeSegment(std::size_t begin, std::size_t end);
+        void returnCaches() noexcept;
+        void assignCacheSlots();
+        void placeParameters();
+        void checkArenas() const; // throws std::logic_error if a W, b, dW or db is not inside its arena (DenseLayer.h)
+
     public:
+        // The activations of predictInto: the layers write into the two in turn, both sized to the widest hidden layer
+        struct PredictBuffers {
+            Math::Matrix<T> ping, pong;
+        };
+
+        // What a checkpointing policy costs and saves for a batch of m samples
+        struct CheckpointEstimate {
+            // activation caches (A, Z) kept by the checkpoints plus the ones lent for recomputing, plus the two dAprev
+            // buffers of backward
+            std::size_t cacheBytes;
+            std::size_t fullCacheBytes; // the same without checkpointing, every layer keeps its own
+            double extraForward; // recomputed forward work as a share of a forward pass, counted in multiply-adds
+            double extraStepTime; // the same as a share of a training step, backward counted as two forward passes
+        };
+
         explicit NeuralNetwork(LossType _loss, double _learningRate, std::size_t _epochs, std::size_t _batchSize,
-                               std::size_t rngSeed);
+                               std::size_t rngSeed, Math::Layout _layout = Math::Layout::FeatureMajor,
+                               Math::Precision _precision = Math::Precision::Full);
+        // A copy places its layers into arenas of its own. The caches come along, but a layer only views its input, so
+        // a copy runs forward before its first backward
+        NeuralNetwork(const NeuralNetwork& other);
+        NeuralNetwork(NeuralNetwork&&) = default;
+        NeuralNetwork& operator=(const NeuralNetwork& other);
+        // The old layers go first, the member order would free the arenas they give their memory back to before them
+        NeuralNetwork& operator=(NeuralNetwork&& other) noexcept;
+        ~NeuralNetwork() = default;
 
         void AddDenseLayer(std::size_t inNodes, std::size_t outNodes, ActivationTypes act,
                            bool initializeConstructor = true);
 
-        Math::Matrix<T> forward(const Math::Matrix<T> &X); // X -> shape (n_0 x m)
+        // X, Y can be any view, e.g. a column range of samples; the layers keep views of their inputs between forward
+        // and backward, so X has to stay alive until then. Yhat is a buffer of the network, valid until the next forward
+        // or backward (which reuses the caches for the gradients); once the batch shape is steady a training step
+        // (forward, backward, update) doesn't allocate
+        const Math::Matrix<T>& forward(Math::MatrixView<const T> X); // X -> shape (n_0 x m), (m x n_0) sample-major; Yhat is T in both precisions
+        const Math::Matrix<T>& forward(const Math::SparseMatrix<T>& X); // same shapes, Full precision; the first layer costs n_1 * nonZeros
+
+        // Inference only: Yhat of X without the caches forward keeps for backward. const, so several threads can predict
+        // with the same network at once, each with its own Yhat and buffers. Both keep their memory, another batch that
+        // isn't bigger doesn't allocate. BFloat16 mode multiplies with the bfloat16 weights, the activations stay T
+        void predictInto(Math::Matrix<T>& Yhat, Math::MatrixView<const T> X, PredictBuffers& buffers) const;
+        [[nodiscard]] Math::Matrix<T> predict(Math::MatrixView<const T> X) const;
+
+        T compute_loss(Math::MatrixView<const T> Y, Math::MatrixView<const T> Yhat);
+        void backward(Math::MatrixView<const T> Y, Math::MatrixView<const T> Yhat);
+        T train(Math::MatrixView<const T> X, Math::MatrixView<const T> Y, bool timeExecution = false, bool printLoss = false, std::size_t printLossEveryXEpoch = 50, bool exportLoss = false, std::size_t exportLossEveryXEpoch = 50);
+        T train(const Math::SparseMatrix<T>& X, Math::MatrixView<const T> Y, bool timeExecution = false, bool printLoss = false, std::size_t printLossEveryXEpoch = 50);
+        std::tuple<Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>> trainTestSplit(Math::MatrixView<const T> X, Math::MatrixView<const T> Y, float trainSizeFloat);
+
+        // zScore: (x - mean) / stdDev, minMax: to [0, 1], robust: (x - median) / interquartile range
+        static void inplaceScaleFeature(std::size_t featureIndex, Math::Matrix<T> &X, ScalerType scaler = ScalerType::zScore,
+                                        Math::Layout layout = Math::Layout::FeatureMajor);
+        // Every feature, one statistics pass over X instead of one per feature
+        static void inplaceScaleFeatures(Math::Matrix<T> &X, ScalerType scaler = ScalerType::zScore,
+                                         Math::Layout layout = Math::Layout::FeatureMajor);
+
+        void update(); // one sweep over the parameter and gradient arenas
 
-        T compute_loss(const Math::Matrix<T>& Y, const Math::Matrix<T>& Yhat);
-        void backward(const Math::Matrix<T>& Y, const Math::Matrix<T>& Yhat);
-        T train(const Math::Matrix<T>& X, const Math::Matrix<T>& Y, bool timeExecution = false, bool printLoss = false, std::size_t printLossEveryXEpoch = 50, bool exportLoss = false, std::size_t exportLossEveryXEpoch = 50);
-        std::tuple<Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>, Math::Matrix<T>> trainTestSplit(const Math::Matrix<T>& X, const Math::Matrix<T>& Y, float trainSizeFloat);
+        // Every W and b of the layers, one after the other in one aligned block (1 x n); the padding and the gaps between
+        // the matrices are 0. The gradients (dW, db) have the same layout, so a step, a norm or a sum over threads is
+        // one loop over the block and saving or loading the model is one copy
+        [[nodiscard]] Math::MatrixView<const T> getParameters() const;
+        [[nodiscard]] Math::MatrixView<const T> getGradients() const;
+        void setParameters(Math::MatrixView<const T> values); // in the layout of getParameters, e.g. an average of several networks
+        [[nodiscard]] T gradientNorm() const; // L2 norm over every dW and db
 
-        static void inplaceScaleFeature(std::size_t featureIndex, Math::Matrix<T> &X, ScalerType scaler = ScalerType::zScore);
+        // Checkpointing (gradient checkpointing, Full precision): only the checkpoint layers (and the last one) keep their
+        // A and Z from forward to backward. The layers between two checkpoints share a set of caches lent by the
+        // network, backward recomputes their forward from the checkpoint before them, segment by segment from the back.
+        // The gradients stay bitwise the same. Every k-th layer with k = sqrt(L) trades less than one extra forward
+        // pass for O(sqrt(L)) activation caches (dAprev takes two buffers in any case). Layers of the same width in
+        // different segments share the lent buffers, so the steps stay free of allocations. Set between training steps.
+        // AddDenseLayer keeps the checkpoints, a layer added later extends the last segment (checkpointEvery isn't
+        // derived again for the new depth, call it once more)
+        void checkpointEvery(std::size_t k); // layers k-1, 2k-1, ...; k = 0 picks ceil(sqrt(L)), k = 1 turns it off
+        void checkpointAt(std::vector<std::size_t> layerIndices); // any layers, none but the last turns it off
+        [[nodiscard]] const std::vector<std::size_t>& getCheckpoints() const noexcept;
+        [[nodiscard]] CheckpointEstimate estimateCheckpointing(std::size_t samples) const;
 
-        void update();
+        [[nodiscard]] const std::vector<DenseLayer<T>>& getLayers() const noexcept;
+        [[nodiscard]] Math::Layout getLayout() const noexcept;
+        [[nodiscard]] LossType getLoss() const noexcept;
 
     };
 
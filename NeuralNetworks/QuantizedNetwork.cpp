@@ -0,0 +1,207 @@
+//
+// Created by timwe on 11/24/2025.
+//
+
+#include "QuantizedNetwork.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "../Math/Gemm.h"
+#include "../Math/ThreadPool.h"
+
+namespace NeuralNetworks {
+    namespace {
+        constexpr std::size_t gemmDepth = 64; // K of the int8 gemm
+
+        template<Math::floatTypes T>
+        T absMax(Math::MatrixView<const T> M) {
+            T result = T{0};
+            for (std::size_t r = 0; r < M.rows(); ++r)
+                for (std::size_t c = 0; c < M.cols(); ++c)
+                    result = std::max(result, std::abs(M.unchecked(r, c)));
+            return result;
+        }
+
+        // Steps of scale from max |x|, 1 for an all zero range so nothing divides by 0
+        template<Math::floatTypes T>
+        T scaleOf(T absMax) {
+            return absMax > T{0} ? absMax / T{127} : T{1};
+        }
+
+        // Symmetric int8 q, saturated to [-127, 127]
+        template<Math::floatTypes T>
+        int quantizeValue(T x, T invScale) {
+            return static_cast<int>(std::nearbyint(std::clamp(x * invScale, T{-127}, T{127})));
+        }
+
+        // f(begin, end) on ranges of rows with about grainSize elements each
+        template<class F>
+        void forRows(std::size_t rows, std::size_t cols, F&& f) {
+            Math::Parallel::forChunks(rows, std::max<std::size_t>(1, Math::Parallel::grainSize() / std::max<std::size_t>(1, cols)), f);
+        }
+    } // namespace
+
+    template<Math::floatTypes T>
+    QuantizedNetwork<T> QuantizedNetwork<T>::quantize(const NeuralNetwork<T>& network, Math::MatrixView<const T> calibration) {
+        const auto& source = network.getLayers();
+        if (source.empty())
+            throw std::logic_error("In QuantizedNetwork::quantize() the network has no layers");
+        if (Math::sampleCount(calibration, network.getLayout()) == 0)
+            throw std::invalid_argument("In QuantizedNetwork::quantize() the calibration set is empty");
+
+        // The input range of layer l is the range of the output of layer l - 1. One float pass layer by layer through
+        // infer, like predictInto: forward would leave the activations between checkpoints in the lent caches
+        const std::size_t m = Math::sampleCount(calibration, network.getLayout());
+        const bool featureMajor = network.getLayout() == Math::Layout::FeatureMajor;
+        std::vector<T> inputMax(source.size());
+        Math::Matrix<T> ping, pong;
+        Math::MatrixView<const T> Aprev = calibration;
+        for (std::size_t l = 0; l < source.size(); ++l) {
+            inputMax[l] = absMax(Aprev);
+            if (l + 1 == source.size())
+                break;
+            Math::Matrix<T>& A = l % 2 == 0 ? ping : pong;
+            const std::size_t features = source[l].getoutNodes();
+            A = Math::Matrix<T>(featureMajor ? features : m, featureMajor ? m : features, Math::uninitialized);
+            source[l].infer(Aprev, A);
+            Aprev = A;
+        }
+
+        QuantizedNetwork result;
+        result.layout = network.getLayout();
+        for (std::size_t l = 0; l < source.size(); ++l) {
+            const auto& dense = source[l];
+            Layer layer;
+            layer.inNodes = dense.getinNodes();
+            layer.outNodes = dense.getoutNodes();
+            layer.k = (layer.inNodes + gemmDepth - 1) / gemmDepth * gemmDepth;
+            layer.act = dense.getActivation();
+            layer.inputScale = scaleOf(inputMax[l]);
+
+            const auto& W = dense.getW();
+            const auto& b = dense.getB();
+            layer.W.assign(layer.outNodes * layer.k, std::int8_t{0});
+            layer.scales.resize(layer.outNodes);
+            layer.corrections.resize(layer.outNodes);
+            layer.bias.resize(layer.outNodes);
+            for (std::size_t j = 0; j < layer.outNodes; ++j) {
+                const T weightScale = scaleOf(absMax<T>(W.view().rowRange(j, 1)));
+                std::int32_t sum = 0;
+                for (std::size_t i = 0; i < layer.inNodes; ++i) {
+                    const int q = quantizeValue(W.unchecked(j, i), T{1} / weightScale);
+                    layer.W[j * layer.k + i] = static_cast<std::int8_t>(q);
+                    sum += q;
+                }
+                layer.scales[j] = layer.inputScale * weightScale;
+                layer.corrections[j] = 128 * sum;
+                layer.bias[j] = b.data()[b.rows() == 1 ? j : j * b.stride()]; // (out x 1) or (1 x out)
+            }
+            result.layers.push_back(std::move(layer));
+        }
+        return result;
+    }
+
+    template<Math::floatTypes T>
+    Math::Matrix<T> QuantizedNetwork<T>::forward(Math::MatrixView<const T> X) {
+        const Layer& first = this->layers.front();
+        if (Math::featureCount(X, this->layout) != first.inNodes)
+            throw std::invalid_argument("In QuantizedNetwork::forward() X does not match the first layer");
+
+        const std::size_t m = Math::sampleCount(X, this->layout);
+        const bool featureMajor = this->layout == Math::Layout::FeatureMajor;
+
+        // Sample i of X as a row of input, the padding up to k stays at the zero point (its weights are 0 anyway)
+        this->input.assign(m * first.k, std::uint8_t{128});
+        const std::size_t rs = featureMajor ? 1 : X.stride(), cs = featureMajor ? X.stride() : 1; // X(sample, feature)
+        forRows(m, first.inNodes, [&](std::size_t begin, std::size_t end) {
+            const T inv = T{1} / first.inputScale;
+            for (std::size_t i = begin; i < end; ++i)
+                for (std::size_t f = 0; f < first.inNodes; ++f)
+                    this->input[i * first.k + f] = static_cast<std::uint8_t>(quantizeValue(X.data()[i * rs + f * cs], inv) + 128);
+        });
+
+        for (std::size_t l = 0; l < this->layers.size(); ++l) {
+            const Layer& layer = this->layers[l];
+            const std::size_t out = layer.outNodes;
+
+            this->sums.resize(m * out);
+            Math::Gemm::gemmU8S8(m, out, layer.k, this->input.data(), layer.k, layer.W.data(), layer.k, this->sums.data(), out);
+
+            if (this->Z.rows() != m || this->Z.cols() != out)
+                this->Z = Math::Matrix<T>(m, out, Math::uninitialized);
+            T* z = this->Z.data().data();
+            const std::size_t stride = this->Z.stride();
+            forRows(m, out, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    for (std::size_t j = 0; j < out; ++j)
+                        z[i * stride + j] = layer.scales[j] * static_cast<T>(this->sums[i * out + j] - layer.corrections[j]) + layer.bias[j];
+            });
+            activate(layer.act, this->Z, this->Z);
+
+            if (l + 1 == this->layers.size())
+                break;
+
+            const Layer& next = this->layers[l + 1];
+            this->input.assign(m * next.k, std::uint8_t{128});
+            forRows(m, out, [&](std::size_t begin, std::size_t end) {
+                const T inv = T{1} / next.inputScale;
+                for (std::size_t i = begin; i < end; ++i)
+                    for (std::size_t j = 0; j < out; ++j)
+                        this->input[i * next.k + j] = static_cast<std::uint8_t>(quantizeValue(z[i * stride + j], inv) + 128);
+            });
+        }
+
+        return featureMajor ? this->Z.transpose() : this->Z;
+    }
+
+    template<Math::floatTypes T>
+    std::size_t QuantizedNetwork<T>::layerCount() const noexcept {
+        return this->layers.size();
+    }
+
+    template<Math::floatTypes T>
+    QuantizationReport compareQuantized(NeuralNetwork<T>& network, QuantizedNetwork<T>& quantized,
+                                        std::type_identity_t<Math::MatrixView<const T>> X, std::type_identity_t<Math::MatrixView<const T>> Y) {
+        const Math::Matrix<T> floatPrediction = network.predict(X);
+        const Math::Matrix<T> quantizedPrediction = quantized.forward(X);
+
+        QuantizationReport report{};
+        report.samples = Math::sampleCount(X, network.getLayout());
+        report.floatLoss = network.compute_loss(Y, floatPrediction);
+        report.quantizedLoss = network.compute_loss(Y, quantizedPrediction);
+
+        std::size_t same = 0;
+        double errorSum = 0.0;
+        for (std::size_t r = 0; r < floatPrediction.rows(); ++r) {
+            for (std::size_t c = 0; c < floatPrediction.cols(); ++c) {
+                const T f = floatPrediction.unchecked(r, c), q = quantizedPrediction.unchecked(r, c);
+                const double error = std::abs(static_cast<double>(q) - static_cast<double>(f));
+                report.maxAbsError = std::max(report.maxAbsError, error);
+                errorSum += error;
+                same += (f >= T{0.5}) == (q >= T{0.5});
+            }
+        }
+
+        const std::size_t outputs = floatPrediction.elementCount();
+        report.meanAbsError = outputs == 0 ? 0.0 : errorSum / static_cast<double>(outputs);
+        if (network.getLoss() == LossType::BCE && outputs > 0)
+            report.agreement = static_cast<double>(same) / static_cast<double>(outputs);
+        return report;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const QuantizationReport& report) {
+        os << "int8 vs float on " << report.samples << " samples\n"
+           << "  loss float / int8:        " << report.floatLoss << " / " << report.quantizedLoss << "\n"
+           << "  |int8 - float| max, mean: " << report.maxAbsError << ", " << report.meanAbsError << "\n";
+        if (report.agreement)
+            os << "  same decision (0.5):      " << *report.agreement * 100.0 << " %\n";
+        return os;
+    }
+
+    template class QuantizedNetwork<float>;
+    template class QuantizedNetwork<double>;
+    template QuantizationReport compareQuantized<float>(NeuralNetwork<float>&, QuantizedNetwork<float>&, Math::MatrixView<const float>, Math::MatrixView<const float>);
+    template QuantizationReport compareQuantized<double>(NeuralNetwork<double>&, QuantizedNetwork<double>&, Math::MatrixView<const double>, Math::MatrixView<const double>);
+} // NeuralNetworks
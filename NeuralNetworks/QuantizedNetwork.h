@@ -0,0 +1,93 @@
+//
+// Created by timwe on 11/24/2025.
+//
+
+#ifndef NEUROINFORMATICS_QUANTIZEDNETWORK_H
+#define NEUROINFORMATICS_QUANTIZEDNETWORK_H
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include "../Math/Allocator.h"
+#include "../Math/Matrix.h"
+#include "NeuralNetwork.h"
+
+/*
+ * Post-training int8 model of a trained NeuralNetwork, inference only: no Z / A / Aprev caches, no gradients.
+ *
+ *      auto [XTrain, YTrain, XTest, YTest] = nn.trainTestSplit(X, Y, 0.8f);
+ *      nn.train(XTrain, YTrain);
+ *      auto q = NeuralNetworks::QuantizedNetwork<float>::quantize(nn, XTrain);   // calibrates on the training split
+ *      std::cout << NeuralNetworks::compareQuantized(nn, q, XTest, YTest);
+ *
+ * Weights are symmetric int8 per output channel (scale_j = max |W_j| / 127). The input of every layer is symmetric
+ * int8 with one scale per layer, max |a| / 127 over the calibration samples; values outside that range saturate.
+ * Activations are stored as uint8 (q + 128) so the product is u8 x s8 (Gemm::gemmU8S8, VNNI where available), the
+ * +128 comes back out through a per channel correction 128 * sum_k W_jk. The int32 sums are scaled back to T, the bias
+ * and activation run in T and the result is quantized again for the next layer.
+ * Internally sample-major (every dot product runs over contiguous features), X and the result are in the layout of
+ * the network.
+ */
+
+namespace NeuralNetworks {
+    template<Math::floatTypes T>
+    class QuantizedNetwork {
+    private:
+        template<class I>
+        using Buffer = std::vector<I, Math::Memory::AlignedAllocator<I>>;
+
+        struct Layer {
+            std::size_t inNodes, outNodes, k; // k = inNodes rounded up to 64, the weights are zero past inNodes
+            ActivationTypes act;
+            T inputScale; // value of one step of the quantized input
+            Buffer<std::int8_t> W; // (outNodes x k)
+            std::vector<T> scales; // inputScale * weight scale of channel j
+            std::vector<std::int32_t> corrections; // 128 * sum_k W_jk
+            std::vector<T> bias;
+        };
+
+        std::vector<Layer> layers;
+        Math::Layout layout;
+
+        // Scratch, keeps its buffers between calls
+        Buffer<std::uint8_t> input; // (m x k) of the current layer
+        Buffer<std::int32_t> sums; // (m x outNodes)
+        Math::Matrix<T> Z; // (m x outNodes)
+
+        QuantizedNetwork() = default;
+
+    public:
+        // Runs the network's inference path on calibration (layout of the network, representative samples, e.g. the
+        // training split) to find the activation ranges. Leaves the network and its caches alone, so a checkpointed
+        // network calibrates the same as any other
+        [[nodiscard]] static QuantizedNetwork quantize(const NeuralNetwork<T>& network, Math::MatrixView<const T> calibration);
+
+        [[nodiscard]] Math::Matrix<T> forward(Math::MatrixView<const T> X); // same layout and shape as NeuralNetwork::forward
+        [[nodiscard]] std::size_t layerCount() const noexcept;
+    };
+
+    struct QuantizationReport {
+        std::size_t samples;
+        double floatLoss, quantizedLoss; // loss of the network on both predictions
+        double maxAbsError, meanAbsError; // |quantized - float| over every output
+        std::optional<double> agreement; // BCE only: fraction of outputs on the same side of 0.5 in both
+    };
+
+    // Float vs quantized predictions on a held-out set (e.g. XTest, YTest of trainTestSplit)
+    template<Math::floatTypes T>
+    [[nodiscard]] QuantizationReport compareQuantized(NeuralNetwork<T>& network, QuantizedNetwork<T>& quantized,
+                                                      std::type_identity_t<Math::MatrixView<const T>> X,
+                                                      std::type_identity_t<Math::MatrixView<const T>> Y);
+
+    std::ostream& operator<<(std::ostream& os, const QuantizationReport& report);
+
+    extern template class QuantizedNetwork<float>;
+    extern template class QuantizedNetwork<double>;
+    extern template QuantizationReport compareQuantized<float>(NeuralNetwork<float>&, QuantizedNetwork<float>&, Math::MatrixView<const float>, Math::MatrixView<const float>);
+    extern template QuantizationReport compareQuantized<double>(NeuralNetwork<double>&, QuantizedNetwork<double>&, Math::MatrixView<const double>, Math::MatrixView<const double>);
+} // NeuralNetworks
+
+#endif //NEUROINFORMATICS_QUANTIZEDNETWORK_H
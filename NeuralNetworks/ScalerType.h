@@ -8,8 +8,8 @@
 namespace NeuralNetworks {
     enum class ScalerType {
         zScore,
-        minMax, // TODO: Implement
-        robust // TODO: Implement
+        minMax,
+        robust
     };
 }
 
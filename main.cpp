@@ -1,10 +1,14 @@
 #include <iostream>
 #include <cmath>
 #include <chrono>
+#include <cstdio>
 
 #include "NeuralNetworks/NeuralNetwork.h"
+#include "NeuralNetworks/QuantizedNetwork.h"
 #include "NeuralNetworks/LossType.h"
 #include "Math/Matrix.h"
+#include "Math/Gemm.h"
+#include "Math/ThreadPool.h"
 #include "Misc/generateNNDataLogicCurcit.h"
 #include "Data/readHousingData.h"
 #include "NeuralNetworks/ScalerType.h"
@@ -27,7 +31,7 @@ void sinPOC() {
 
     auto finalLoss = sinNN.train(XTrain, YTrain, true, true, 1000);
 
-    auto test_loss = sinNN.forward(XTest);
+    auto test_loss = sinNN.predict(XTest);
 
     std::cout << "Test Loss: " << sinNN.compute_loss(YTest, test_loss) << "\n";
 
@@ -122,10 +126,8 @@ void housingPOC() {
         XTest.log1pInplaceOfRow(i);
     }
 
-    for(int i = 0; i < X.rows(); i++) {
-        NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeature(i, XTrain, NeuralNetworks::ScalerType::zScore);
-        NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeature(i, XTest, NeuralNetworks::ScalerType::zScore);
-    }
+    NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeatures(XTrain, NeuralNetworks::ScalerType::zScore);
+    NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeatures(XTest, NeuralNetworks::ScalerType::zScore);
 
     YTrain.log1pInplaceOfRow(0);
     NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeature(0, YTrain, NeuralNetworks::ScalerType::zScore);
@@ -139,18 +141,73 @@ void housingPOC() {
 
     auto finalLoss = housingNN.train(XTrain, YTrain, true, true, 100);
 
-    auto test_loss = housingNN.forward(XTest);
+    auto test_loss = housingNN.predict(XTest);
 
     std::cout << "Test Loss: " << housingNN.compute_loss(YTest, test_loss) << "\n";
 
+    // int8 inference model, calibrated on the training split and checked on the held-out one
+    auto quantizedNN = NeuralNetworks::QuantizedNetwork<float>::quantize(housingNN, XTrain);
+    std::cout << NeuralNetworks::compareQuantized(housingNN, quantizedNN, XTest, YTest);
+
     std::cout << "final loss " << finalLoss << "\n";
 }
 
+// GFLOP/s of the blocked gemm against the old i-j-k loop and of the parallel one against the serial one, for the
+// housingPOC layer shapes (m = 16512 training samples)
+void gemmBenchmark() {
+    using Math::Gemm::Transpose;
+    struct Shape { const char* name; std::size_t M, N, K; Transpose transA = Transpose::No, transB = Transpose::No; };
+    const Shape shapes[] = {
+        {"forward  W1 * X      (128x12 * 12xm)",    128, 16512, 12},
+        {"forward  W2 * A1     (64x128 * 128xm)",   64,  16512, 128},
+        {"forward  W3 * A2     (1x64 * 64xm)",      1,   16512, 64},
+        {"backward dZ2 * A1^T  (64xm * mx128)",     64,  128,   16512, Transpose::No,  Transpose::Yes},
+        {"backward W2^T * dZ2  (128x64 * 64xm)",    128, 16512, 64,    Transpose::Yes, Transpose::No},
+    };
+
+    auto gflops = [](const Shape& s, auto&& kernel) {
+        constexpr int repetitions = 5;
+        kernel(); // warm up caches and packing buffers
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; i++)
+            kernel();
+        const std::chrono::duration<double> seconds = std::chrono::high_resolution_clock::now() - startTime;
+        return 2.0 * s.M * s.N * s.K * repetitions / seconds.count() / 1e9;
+    };
+
+    for (const auto& s : shapes) {
+        // A and B are stored the way the layer stores them, the transposes are done by the gemm
+        Math::Matrix<float> A(s.transA == Transpose::No ? s.M : s.K, s.transA == Transpose::No ? s.K : s.M);
+        Math::Matrix<float> B(s.transB == Transpose::No ? s.K : s.N, s.transB == Transpose::No ? s.N : s.K);
+        Math::Matrix<float> C(s.M, s.N);
+        A.fill(0.5f);
+        B.fill(0.25f);
+
+        auto blockedGemm = [&] {
+            Math::Gemm::gemm(s.transA, s.transB, s.M, s.N, s.K, 1.0f, A.data().data(), A.stride(),
+                             B.data().data(), B.stride(), 0.0f, C.data().data(), C.stride());
+        };
+        const std::size_t threads = Math::Parallel::threadCount();
+        Math::Parallel::setThreadCount(1);
+        const double blocked = gflops(s, blockedGemm);
+        Math::Parallel::setThreadCount(threads);
+        const double parallel = gflops(s, blockedGemm);
+        const double reference = gflops(s, [&] {
+            Math::Gemm::referenceGemm(s.transA, s.transB, s.M, s.N, s.K, 1.0f, A.data().data(), A.stride(),
+                                      B.data().data(), B.stride(), 0.0f, C.data().data(), C.stride());
+        });
+
+        std::printf("%s: blocked %7.2f GFLOP/s, reference %6.2f GFLOP/s (x%.1f), %zu threads %7.2f GFLOP/s (x%.1f)\n",
+                    s.name, blocked, reference, blocked / reference, threads, parallel, parallel / blocked);
+    }
+}
+
 int main() {
     // sinPOC();
     // xorPOC();
     // logicPOC();
     housingPOC();
+    // gemmBenchmark();
 
     return 0;
 }
\ No newline at end of file
@@ -16,7 +16,7 @@
 using Catch::Approx;
 
 TEST_CASE("FUNCTIONS") {
-    const double EPS = 1e-12;
+    using namespace Math::Functions;
 
     SECTION("log base-change correctness") {
         // log base e should match natural log (identity)
@@ -32,8 +32,8 @@ TEST_CASE("FUNCTIONS") {
 
     SECTION("tanh matches std::tanh and is odd") {
         for (double x : { -3.0, -1.0, -0.1, 0.0, 0.1, 1.0, 3.0 }) {
-            REQUIRE( Math::Function::tanh(x) == Approx(std::tanh(x)).epsilon(1e-12) );
-            REQUIRE( Math::Function::tanh(-x) == Approx(-tanh(x)).epsilon(1e-12) );
+            REQUIRE( Math::Functions::tanh(x) == Approx(std::tanh(x)).epsilon(1e-12) );
+            REQUIRE( Math::Functions::tanh(-x) == Approx(-tanh(x)).epsilon(1e-12) );
         }
     }
 
@@ -42,8 +42,8 @@ TEST_CASE("FUNCTIONS") {
 
         // midpoint and bounds-ish
         REQUIRE( sigma(0.0) == Approx(0.5).epsilon(1e-12) );
-        REQUIRE( sigma(8.0)  == Approx(1.0).margin(1e-7) );
-        REQUIRE( sigma(-8.0) == Approx(0.0).margin(1e-7) );
+        REQUIRE( sigma(20.0)  == Approx(1.0).margin(1e-7) ); // sigma(8) is still 1 - 3.4e-4
+        REQUIRE( sigma(-20.0) == Approx(0.0).margin(1e-7) );
 
         // symmetry: σ(-x) = 1 - σ(x)
         for (double x : {0.1, 0.5, 1.0, 2.0}) {
@@ -53,12 +53,12 @@ TEST_CASE("FUNCTIONS") {
 
     SECTION("relu piecewise") {
         REQUIRE( Math::Functions::relu(-3.5) == Approx(0.0).margin(0.0) );
-        REQUIRE( Math::Function::relu(0.0)  == Approx(0.0).margin(0.0) );
-        REQUIRE( Math::Function::relu(2.25) == Approx(2.25).epsilon(1e-12) );
+        REQUIRE( Math::Functions::relu(0.0)  == Approx(0.0).margin(0.0) );
+        REQUIRE( Math::Functions::relu(2.25) == Approx(2.25).epsilon(1e-12) );
 
         // float as well
-        REQUIRE( Math::Function::relu(-1.0f) == Approx(0.0f).margin(0.0f) );
-        REQUIRE( Math::Function::relu(5.0f)  == Approx(5.0f).epsilon(1e-6f) );
+        REQUIRE( Math::Functions::relu(-1.0f) == Approx(0.0f).margin(0.0f) );
+        REQUIRE( Math::Functions::relu(5.0f)  == Approx(5.0f).epsilon(1e-6f) );
     }
 
     SECTION("softplus equals log(1+exp(x))") {
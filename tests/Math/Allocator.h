@@ -0,0 +1,43 @@
+//
+// Created by timwe on 11/19/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <memory_resource>
+
+#include "../../Math/Matrix.h"
+
+TEST_CASE("MATRIX STORAGE") {
+    SECTION("buffers are cache line aligned, uninitialised ones still have zero padding") {
+        for (std::size_t cols = 1; cols < 20; ++cols) {
+            Math::Matrix<float> A(3, cols, Math::uninitialized);
+            REQUIRE( reinterpret_cast<std::uintptr_t>(A.data().data()) % Math::Memory::alignment == 0 );
+            for (std::size_t r = 0; r < A.rows(); ++r)
+                for (std::size_t c = A.cols(); c < A.stride(); ++c)
+                    REQUIRE( A.data()[r * A.stride() + c] == 0.0f );
+        }
+    }
+
+    SECTION("arena resource, copies go back to the default resource") {
+        std::pmr::monotonic_buffer_resource arena(1 << 16);
+        Math::Matrix<double> A(4, 5, 0, &arena);
+        A.fill(2.0);
+        REQUIRE( A.resource() == &arena );
+        REQUIRE( reinterpret_cast<std::uintptr_t>(A.data().data()) % Math::Memory::alignment == 0 );
+
+        Math::Matrix<double> B(A);
+        REQUIRE( B.resource() == Math::Memory::defaultResource() );
+        REQUIRE( B(3, 4) == 2.0 );
+
+        Math::Matrix<double> C(4, 5, 0, &arena);
+        C = B; // copy assignment keeps C's memory
+        REQUIRE( C.resource() == &arena );
+        REQUIRE( C(0, 0) == 2.0 );
+
+        auto* previous = Math::Memory::setDefaultResource(&arena);
+        REQUIRE( Math::Matrix<double>(2, 2).resource() == &arena );
+        Math::Memory::setDefaultResource(previous);
+    }
+}
@@ -0,0 +1,165 @@
+//
+// Created by timwe on 11/23/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "../../Math/Precision.h"
+#include "../../Math/ThreadPool.h"
+#include "../../NeuralNetworks/NeuralNetwork.h"
+
+TEST_CASE("BFLOAT16") {
+    using Math::bfloat16;
+
+    SECTION("conversion rounds to nearest even and keeps inf / nan") {
+        REQUIRE( static_cast<float>(bfloat16(1.0f)) == 1.0f );
+        REQUIRE( static_cast<float>(bfloat16(-2.5f)) == -2.5f );
+        REQUIRE( static_cast<float>(bfloat16(1.0f + 0x1p-8f)) == 1.0f ); // tie, to even
+        REQUIRE( static_cast<float>(bfloat16(1.0f + 0x1p-8f + 0x1p-20f)) == 1.0f + 0x1p-7f );
+        REQUIRE( static_cast<float>(bfloat16(1.0f + 3 * 0x1p-8f)) == 1.0f + 0x1p-6f ); // tie, to even (up)
+        // bit patterns, -ffast-math folds std::isinf / std::isnan to false
+        REQUIRE( bfloat16::fromFloat(std::numeric_limits<float>::infinity()) == 0x7f80u );
+        REQUIRE( bfloat16::fromFloat(-std::numeric_limits<float>::infinity()) == 0xff80u );
+        REQUIRE( bfloat16::fromFloat(std::numeric_limits<float>::max()) == 0x7f80u ); // rounds past the last finite
+        REQUIRE( bfloat16::fromFloat(std::numeric_limits<float>::quiet_NaN()) != bfloat16::fromFloat(std::numeric_limits<float>::infinity()) );
+        REQUIRE( (bfloat16::fromFloat(std::numeric_limits<float>::quiet_NaN()) & 0x7f80u) == 0x7f80u );
+        REQUIRE( static_cast<float>(bfloat16(1e30f)) == Catch::Approx(1e30f).epsilon(1e-2) ); // float range
+    }
+
+    SECTION("Matrix<bfloat16> stores with zeroed padding") {
+        Math::Matrix<bfloat16> M(3, 5);
+        REQUIRE( M.stride() == 16 );
+        REQUIRE( reinterpret_cast<std::uintptr_t>(M.data().data()) % 64 == 0 );
+
+        Math::Matrix<float> F(3, 5);
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 5; ++c)
+                F(r, c) = static_cast<float>(r) - 0.25f * static_cast<float>(c);
+
+        Math::narrowInto<float>(M, F);
+        for (std::size_t r = 0; r < 3; ++r) {
+            for (std::size_t c = 0; c < 5; ++c)
+                REQUIRE( static_cast<float>(M(r, c)) == F(r, c) ); // exactly representable
+            for (std::size_t c = 5; c < M.stride(); ++c)
+                REQUIRE( M.data()[r * M.stride() + c].bits == 0 );
+        }
+
+        Math::Matrix<double> D;
+        Math::widenInto(D, M.view().block(1, 2, 2, 3));
+        REQUIRE( D.rows() == 2 );
+        REQUIRE( D(1, 2) == static_cast<double>(F(2, 4)) );
+
+        const auto T = M.transpose();
+        REQUIRE( static_cast<float>(T(4, 2)) == F(2, 4) );
+    }
+
+    SECTION("mixed gemm accumulates in T") {
+        using Math::Gemm::Transpose;
+        std::mt19937 gen(5);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        for (const auto& [m, n, k] : {std::tuple<std::size_t, std::size_t, std::size_t>{7, 5, 3}, {37, 29, 300}, {130, 70, 257}}) {
+            Math::Matrix<float> A(m, k), B(k, n);
+            for (auto& x : A.data()) x = dist(gen);
+            for (auto& x : B.data()) x = dist(gen);
+            Math::Matrix<bfloat16> A16, B16;
+            Math::narrowInto<float>(A16, A);
+            Math::narrowInto<float>(B16, B);
+
+            // The reference runs on the widened values, so only the summation order differs
+            Math::Matrix<float> Aw, Bw;
+            Math::widenInto(Aw, A16);
+            Math::widenInto(Bw, B16);
+            Math::Matrix<float> expected(m, n);
+            Math::Gemm::referenceGemm(m, n, k, Aw.data().data(), Aw.stride(), Bw.data().data(), Bw.stride(), expected.data().data(), expected.stride());
+
+            Math::Matrix<float> BB, BT, TB, transposed;
+            Math::matMulInto(BB, A16, B16);
+            Math::matMulInto(BT, A16, Bw);
+            Math::matMulInto(TB, Aw, B16);
+            const auto At16 = A16.transpose();
+            Math::matMulInto(transposed, At16, B16, Transpose::Yes, Transpose::No);
+            REQUIRE( BB.rows() == m );
+            REQUIRE( BB.cols() == n );
+            for (std::size_t r = 0; r < m; ++r) {
+                for (std::size_t c = 0; c < n; ++c) {
+                    REQUIRE( BB(r, c) == Catch::Approx(expected(r, c)).margin(1e-5 * k) );
+                    REQUIRE( BT(r, c) == BB(r, c) );
+                    REQUIRE( TB(r, c) == BB(r, c) );
+                    REQUIRE( transposed(r, c) == BB(r, c) );
+                }
+            }
+        }
+    }
+
+    SECTION("reductions accumulate in T") {
+        // 1 + 2^-8 isn't a bfloat16, a bfloat16 accumulator would stop growing at 256
+        Math::Matrix<float> ones(300, 301);
+        ones.fill(1.0f);
+        Math::Matrix<bfloat16> ones16;
+        Math::narrowInto<float>(ones16, ones);
+        REQUIRE( Math::sum<float>(ones16) == 300.0f * 301.0f );
+        REQUIRE( Math::mean<double>(ones16.view().colRange(1, 7)) == 1.0 );
+
+        const std::size_t previous = Math::Parallel::setGrainSize(256);
+        const auto threads = Math::Parallel::threadCount();
+        Math::Matrix<float> X(64, 1000);
+        for (std::size_t r = 0; r < X.rows(); ++r)
+            for (std::size_t c = 0; c < X.cols(); ++c)
+                X(r, c) = std::sin(static_cast<float>(r * 1000 + c));
+        Math::Matrix<bfloat16> X16;
+        Math::narrowInto<float>(X16, X);
+        Math::Parallel::setThreadCount(1);
+        const float serial = Math::sum<float>(X16);
+        Math::Parallel::setThreadCount(4);
+        REQUIRE( Math::sum<float>(X16) == serial ); // same blocks, same order
+        Math::Parallel::setThreadCount(threads);
+        Math::Parallel::setGrainSize(previous);
+    }
+
+    SECTION("a network in BFloat16 mode trains close to the float one") {
+        using NeuralNetworks::ActivationTypes;
+        constexpr std::size_t samples = 200;
+        Math::Matrix<float> X(2, samples), Y(1, samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            X(0, i) = std::sin(0.37f * static_cast<float>(i));
+            X(1, i) = std::cos(0.11f * static_cast<float>(i));
+            Y(0, i) = X(0, i) * X(1, i) > 0 ? 1.0f : 0.0f;
+        }
+
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor}) {
+            auto build = [layout](Math::Precision precision) {
+                NeuralNetworks::NeuralNetwork<float> nn(NeuralNetworks::LossType::BCE, 0.5, 300, 32, 3, layout, precision);
+                nn.AddDenseLayer(2, 16, ActivationTypes::ReLU);
+                nn.AddDenseLayer(16, 8, ActivationTypes::Tanh);
+                nn.AddDenseLayer(8, 1, ActivationTypes::Sigmoid);
+                return nn;
+            };
+            auto full = build(Math::Precision::Full);
+            auto half = build(Math::Precision::BFloat16);
+
+            Math::Matrix<float> Xl = X, Yl = Y;
+            if (layout == Math::Layout::SampleMajor) {
+                Xl.transposeSelf();
+                Yl.transposeSelf();
+            }
+            const float fullLoss = full.train(Xl, Yl);
+            const float halfLoss = half.train(Xl, Yl);
+            REQUIRE( halfLoss < 1.0f );
+            REQUIRE( halfLoss == Catch::Approx(fullLoss).margin(0.05) );
+
+            const auto Yhat = half.forward(Xl);
+            REQUIRE( Yhat.rows() == Yl.rows() );
+            REQUIRE( Yhat.cols() == Yl.cols() );
+        }
+
+        std::mt19937 gen(1);
+        NeuralNetworks::DenseLayer<float> layer(2, 3, ActivationTypes::Tanh, gen, true, Math::Layout::FeatureMajor, Math::Precision::BFloat16);
+        REQUIRE_THROWS_AS( (void)layer.forward(X.view()), std::logic_error );
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by timwe on 11/16/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <stdexcept>
+
+#include "../../Math/Matrix.h"
+
+using Catch::Approx;
+
+TEST_CASE("ELEMENTWISE KERNELS") {
+    Math::Matrix<double> A(4, 3), B(4, 3);
+    for (std::size_t r = 0; r < 4; ++r) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            A(r, c) = 0.25 * static_cast<double>(r) - 0.5 * static_cast<double>(c);
+            B(r, c) = 1.0 + 0.1 * static_cast<double>(r + c);
+        }
+    }
+
+    SECTION("mapInto reuses the output buffer and matches the eager map") {
+        Math::Matrix<double> out(4, 3);
+        const double* buffer = out.data().data();
+        Math::mapInto(out, [](double a, double b){ return a * b + 1.0; }, A, B);
+
+        REQUIRE( out.data().data() == buffer );
+        for (std::size_t r = 0; r < 4; ++r)
+            for (std::size_t c = 0; c < 3; ++c)
+                REQUIRE( out(r, c) == Approx(A(r, c) * B(r, c) + 1.0) );
+
+        Math::mapInto(out, [](double a){ return Math::Functions::sigmoid(a); }, A);
+        const auto sig = A.sigmoid();
+        for (std::size_t r = 0; r < 4; ++r)
+            for (std::size_t c = 0; c < 3; ++c)
+                REQUIRE( sig(r, c) == Approx(out(r, c)).epsilon(1e-14) );
+    }
+
+    SECTION("output may alias an input and padding stays zero") {
+        const auto before = A;
+        Math::mapInto(A, [](double a, double b, double c){ return a + b * c; }, A, B, B);
+        Math::apply(A, [](double a){ return a + 3.0; });
+
+        for (std::size_t r = 0; r < 4; ++r) {
+            for (std::size_t c = 0; c < 3; ++c)
+                REQUIRE( A(r, c) == Approx(before(r, c) + B(r, c) * B(r, c) + 3.0) );
+            for (std::size_t c = A.cols(); c < A.stride(); ++c)
+                REQUIRE( A.data()[r * A.stride() + c] == 0.0 );
+        }
+    }
+
+    SECTION("mapSumInto sums what it writes, over the columns or the rows") {
+        Math::Matrix<double> out(4, 3), rowSums(4, 1), colSums;
+        const double* buffer = out.data().data();
+        const double* sums = rowSums.data().data();
+        Math::mapSumInto(out, rowSums, Math::SumOver::Columns, 0.5, [](double a, double b){ return a * b; }, A, B);
+        Math::mapSumInto(A, colSums, Math::SumOver::Rows, 2.0, [](double a){ return a - 1.0; }, A); // in place
+
+        REQUIRE( out.data().data() == buffer );
+        REQUIRE( rowSums.data().data() == sums );
+        REQUIRE( colSums.rows() == 1 );
+        REQUIRE( colSums.cols() == 3 );
+        for (std::size_t r = 0; r < 4; ++r) {
+            double expected = 0.0;
+            for (std::size_t c = 0; c < 3; ++c) {
+                expected += out(r, c);
+                REQUIRE( out(r, c) == Approx((A(r, c) + 1.0) * B(r, c)) );
+            }
+            REQUIRE( rowSums(r, 0) == Approx(0.5 * expected) );
+        }
+        for (std::size_t c = 0; c < 3; ++c) {
+            double expected = 0.0;
+            for (std::size_t r = 0; r < 4; ++r)
+                expected += A(r, c);
+            REQUIRE( colSums(0, c) == Approx(2.0 * expected) );
+        }
+
+        REQUIRE_THROWS_AS( Math::mapSumInto(out, out, Math::SumOver::Rows, 1.0, [](double a){ return a; }, A), std::invalid_argument );
+    }
+
+    SECTION("mismatched operands throw") {
+        Math::Matrix<double> C(3, 4);
+        Math::Matrix<double> out;
+        REQUIRE_THROWS_AS( Math::mapInto(out, [](double a, double b){ return a + b; }, A, C), std::invalid_argument );
+        REQUIRE_THROWS_AS( Math::mapSumInto(out, C, Math::SumOver::Columns, 1.0, [](double a, double b){ return a + b; }, A, C), std::invalid_argument );
+        REQUIRE_THROWS_AS( Math::zip([](double a, double b){ return a - b; }, A, C), std::invalid_argument );
+    }
+}
@@ -0,0 +1,231 @@
+//
+// Created by timwe on 11/14/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../Math/Dispatch.h"
+#include "../../Math/Gemm.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/ThreadPool.h"
+
+using Catch::Approx;
+
+template<typename T>
+static void checkGemmAgainstReference(std::size_t M, std::size_t N, std::size_t K,
+                                      Math::Gemm::Transpose transA = Math::Gemm::Transpose::No,
+                                      Math::Gemm::Transpose transB = Math::Gemm::Transpose::No,
+                                      T alpha = T{1}, T beta = T{0}) {
+    using Math::Gemm::Transpose;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<T> dist(-1, 1);
+
+    // Stored shapes of A and B depend on the transpose flags, strides are bigger than the column count like the padded Matrix buffers
+    const std::size_t rowsA = transA == Transpose::No ? M : K, colsA = transA == Transpose::No ? K : M;
+    const std::size_t rowsB = transB == Transpose::No ? K : N, colsB = transB == Transpose::No ? N : K;
+    const std::size_t lda = colsA + 3, ldb = colsB + 5, ldc = N + 7;
+    std::vector<T> A(rowsA * lda), B(rowsB * ldb), C(M * ldc);
+    for (auto& a : A) a = dist(gen);
+    for (auto& b : B) b = dist(gen);
+    for (auto& c : C) c = dist(gen);
+    auto CRef = C;
+
+    Math::Gemm::gemm<T>(transA, transB, M, N, K, alpha, A.data(), lda, B.data(), ldb, beta, C.data(), ldc);
+    Math::Gemm::referenceGemm<T>(transA, transB, M, N, K, alpha, A.data(), lda, B.data(), ldb, beta, CRef.data(), ldc);
+
+    for (std::size_t r = 0; r < M; ++r)
+        for (std::size_t c = 0; c < N; ++c)
+            REQUIRE( C[r * ldc + c] == Approx(CRef[r * ldc + c]).margin(1e-4 * K) );
+}
+
+// affineInto against the three passes it replaces (gemm, bias, activation): the epilogue runs the same register ops
+// on the same sums, so the results have to be the same bits, on every ISA level and thread count
+template<typename T>
+static void checkEpilogueAgainstPasses(std::size_t M, std::size_t N, std::size_t K,
+                                       Math::Gemm::Transpose transA = Math::Gemm::Transpose::No,
+                                       Math::Gemm::Transpose transB = Math::Gemm::Transpose::No) {
+    using Math::Gemm::Activation;
+    using Math::Gemm::Transpose;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<T> dist(-1, 1);
+    auto random = [&](std::size_t rows, std::size_t cols) {
+        Math::Matrix<T> R(rows, cols);
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = 0; c < cols; ++c)
+                R(r, c) = dist(gen);
+        return R;
+    };
+    auto requireSame = [](const Math::Matrix<T>& X, const Math::Matrix<T>& Y) {
+        REQUIRE( X.rows() == Y.rows() );
+        REQUIRE( X.cols() == Y.cols() );
+        std::size_t different = 0;
+        for (std::size_t r = 0; r < X.rows(); ++r)
+            for (std::size_t c = 0; c < X.cols(); ++c)
+                different += X(r, c) != Y(r, c);
+        REQUIRE( different == 0 );
+    };
+
+    const Math::Matrix<T> A = transA == Transpose::No ? random(M, K) : random(K, M);
+    const Math::Matrix<T> B = transB == Transpose::No ? random(K, N) : random(N, K);
+    const Math::Matrix<T> rowBias = random(M, 1), colBias = random(1, N);
+
+    const auto previous = Math::Dispatch::activeIsa();
+    const auto threadsBefore = Math::Parallel::threadCount();
+    for (const auto level : {Math::Dispatch::IsaLevel::Generic, Math::Dispatch::IsaLevel::AVX2, Math::Dispatch::IsaLevel::AVX512}) {
+        if (Math::Dispatch::setIsa(level) != level)
+            continue;
+        for (const std::size_t threads : {std::size_t{1}, std::size_t{4}}) {
+            Math::Parallel::setThreadCount(threads);
+            for (const auto f : {Activation::Identity, Activation::ReLU, Activation::Sigmoid, Activation::Tanh,
+                                 Activation::Softplus, Activation::Elu, Activation::Delu, Activation::Mish,
+                                 Activation::Selu, Activation::LeakyReLU}) {
+                for (const bool perRow : {true, false}) {
+                    const Math::Matrix<T>& bias = perRow ? rowBias : colBias;
+                    Math::Matrix<T> Zref, Aref;
+                    Math::matMulInto(Zref, A, B, transA, transB);
+                    if (perRow)
+                        Zref = Math::Expr::addBias(Math::lazy(Zref), bias);
+                    else
+                        Zref = Math::Expr::addColumnBias(Math::lazy(Zref), bias);
+                    Math::activationInto(Aref, Zref, f, T{0.5});
+
+                    Math::Matrix<T> Z, Act;
+                    Math::affineInto<T>(Z, A, B, transA, transB, bias, f, &Act, T{0.5});
+                    requireSame(Z, Zref);
+                    requireSame(Act, Aref);
+
+                    Math::Matrix<T> inPlace; // only f(Z) is kept
+                    Math::affineInto<T>(inPlace, A, B, transA, transB, bias, f, nullptr, T{0.5});
+                    requireSame(inPlace, Aref);
+
+                    Math::Matrix<T> separate; // the epilogue as a pass of its own
+                    Math::matMulInto(separate, A, B, transA, transB);
+                    Math::biasActivationInto(separate, bias, f, &Act, T{0.5});
+                    requireSame(separate, Zref);
+                    requireSame(Act, Aref);
+                }
+            }
+        }
+    }
+    Math::Dispatch::setIsa(previous);
+    Math::Parallel::setThreadCount(threadsBefore);
+}
+
+TEST_CASE("GEMM") {
+    using Math::Gemm::Transpose;
+
+    SECTION("blocked gemm matches the reference loop (float)") {
+        checkGemmAgainstReference<float>(128, 300, 12);  // housing layer 1
+        checkGemmAgainstReference<float>(64, 257, 128);  // housing layer 2
+        checkGemmAgainstReference<float>(1, 130, 64);    // housing output layer
+        checkGemmAgainstReference<float>(37, 4100, 300); // multiple k and n blocks, edge tiles everywhere
+    }
+
+    SECTION("blocked gemm matches the reference loop (double)") {
+        checkGemmAgainstReference<double>(128, 300, 12);
+        checkGemmAgainstReference<double>(13, 2100, 513);
+        checkGemmAgainstReference<double>(1, 1, 1);
+    }
+
+    SECTION("transposed operands") {
+        checkGemmAgainstReference<float>(64, 12, 1000, Transpose::No, Transpose::Yes);  // dW = dZ * Aprev^T
+        checkGemmAgainstReference<float>(128, 301, 64, Transpose::Yes, Transpose::No);  // dAprev = W^T * dZ
+        checkGemmAgainstReference<float>(1, 129, 64, Transpose::Yes, Transpose::No);
+        checkGemmAgainstReference<double>(33, 70, 400, Transpose::Yes, Transpose::Yes);
+    }
+
+    SECTION("alpha and beta scaling") {
+        checkGemmAgainstReference<float>(64, 12, 500, Transpose::No, Transpose::Yes, 1.0f / 500.0f);
+        checkGemmAgainstReference<float>(40, 90, 300, Transpose::No, Transpose::No, 0.5f, -2.0f);
+        checkGemmAgainstReference<double>(3, 90, 20, Transpose::No, Transpose::No, 2.0, 1.0);
+        checkGemmAgainstReference<double>(20, 20, 0, Transpose::No, Transpose::No, 1.0, 0.5);
+    }
+
+    SECTION("batch-1 dot product paths") {
+        checkGemmAgainstReference<float>(1, 128, 67, Transpose::No, Transpose::Yes);              // x * W^T, sample-major
+        checkGemmAgainstReference<float>(128, 1, 67, Transpose::No, Transpose::No, 1.0f, 0.5f);  // W * x, feature-major
+        checkGemmAgainstReference<double>(3, 5, 1000, Transpose::No, Transpose::Yes, 0.25, -1.0);
+        checkGemmAgainstReference<double>(9, 1, 3, Transpose::No, Transpose::Yes);
+    }
+
+    SECTION("bias and activation fused into the epilogue") {
+        checkEpilogueAgainstPasses<float>(24, 300, 12);                                  // housing layer 1, feature-major
+        checkEpilogueAgainstPasses<float>(300, 24, 12, Transpose::No, Transpose::Yes);   // same layer sample-major
+        checkEpilogueAgainstPasses<float>(37, 4100, 300);                                // k and n blocks, edge tiles, parallel
+        checkEpilogueAgainstPasses<float>(1, 130, 64);                                   // row streaming path
+        checkEpilogueAgainstPasses<float>(1, 33, 67, Transpose::No, Transpose::Yes);     // dot product paths
+        checkEpilogueAgainstPasses<float>(40, 1, 67);
+        checkEpilogueAgainstPasses<double>(13, 700, 513, Transpose::Yes, Transpose::No);
+        checkEpilogueAgainstPasses<double>(9, 5, 3, Transpose::Yes, Transpose::Yes);
+
+        Math::Matrix<float> A(4, 3), B(3, 5), Z;
+        REQUIRE_THROWS_AS( Math::affineInto<float>(Z, A, B, Transpose::No, Transpose::No, Math::Matrix<float>(5, 1), Math::Gemm::Activation::Tanh),
+                           std::invalid_argument );
+        const auto previous = Math::Dispatch::activeIsa();
+        for (int level = 0; level <= static_cast<int>(Math::Dispatch::detectedIsa()); ++level) {
+            INFO( "ISA level " << level );
+            Math::Dispatch::setIsa(static_cast<Math::Dispatch::IsaLevel>(level));
+            Math::affineInto<float>(Z, A, B, Transpose::No, Transpose::No, Math::MatrixView<const float>{}, Math::Gemm::Activation::Sigmoid);
+            REQUIRE( Z(3, 4) == 0.5f ); // no bias, sigmoid(0)
+        }
+        Math::Dispatch::setIsa(previous);
+
+        // An empty sample-major batch into a view: nothing to write, no end of Z to take the overlap bounds from
+        Math::Matrix<float> W(5, 3), buffer(8, 5);
+        const Math::MatrixView<float> empty(buffer.data().data(), 0, 5, buffer.stride());
+        Math::affineInto<float, float, float>(empty, Math::MatrixView<const float>(A.data().data(), 0, 3, A.stride()), W,
+                                              Transpose::No, Transpose::Yes, Math::MatrixView<const float>{}, Math::Gemm::Activation::Tanh);
+        REQUIRE( std::ranges::all_of(buffer.data(), [](float x) { return x == 0.0f; }) );
+
+        // K = 0 leaves only beta * C, the epilogue still runs on it
+        std::vector<double> C(6, 1.0), rowBias{1.0, -3.0}, out(6);
+        Math::Gemm::Epilogue<double> epilogue{.rowBias = rowBias.data(), .activation = Math::Gemm::Activation::ReLU, .out = out.data(), .ldo = 3};
+        Math::Gemm::gemm<double, double, double>(Transpose::No, Transpose::No, 2, 3, 0, 1.0, nullptr, 1, nullptr, 3, 0.5, C.data(), 3, epilogue);
+        REQUIRE( C == std::vector<double>{1.5, 1.5, 1.5, -2.5, -2.5, -2.5} );
+        REQUIRE( out == std::vector<double>{1.5, 1.5, 1.5, 0.0, 0.0, 0.0} );
+    }
+
+    SECTION("int8 gemm is exact on every ISA level") {
+        using Math::Dispatch::IsaLevel;
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<int> u8(0, 255), s8(-127, 127);
+        const auto previous = Math::Dispatch::activeIsa();
+        const auto threadsBefore = Math::Parallel::threadCount();
+        for (const auto& [M, N, K] : {std::tuple<std::size_t, std::size_t, std::size_t>{1, 1, 64}, {7, 5, 128}, {33, 70, 320}, {131, 9, 64}, {257, 128, 512}}) {
+            const std::size_t lda = K + 64, ldb = K, ldc = N + 3;
+            std::vector<std::uint8_t> A(M * lda);
+            std::vector<std::int8_t> B(N * ldb);
+            for (auto& a : A) a = static_cast<std::uint8_t>(u8(gen));
+            for (auto& b : B) b = static_cast<std::int8_t>(s8(gen));
+
+            std::vector<std::int32_t> expected(M * ldc, 0);
+            for (std::size_t i = 0; i < M; ++i)
+                for (std::size_t j = 0; j < N; ++j)
+                    for (std::size_t k = 0; k < K; ++k)
+                        expected[i * ldc + j] += static_cast<std::int32_t>(A[i * lda + k]) * B[j * ldb + k];
+
+            for (const auto level : {IsaLevel::Generic, IsaLevel::AVX2, IsaLevel::AVX512}) {
+                if (Math::Dispatch::setIsa(level) != level)
+                    continue;
+                for (const std::size_t threads : {std::size_t{1}, std::size_t{4}}) {
+                    Math::Parallel::setThreadCount(threads);
+                    std::vector<std::int32_t> C(M * ldc, 0);
+                    Math::Gemm::gemmU8S8(M, N, K, A.data(), lda, B.data(), ldb, C.data(), ldc);
+                    REQUIRE( C == expected );
+                }
+            }
+        }
+        Math::Dispatch::setIsa(previous);
+        Math::Parallel::setThreadCount(threadsBefore);
+
+        std::vector<std::uint8_t> A(64);
+        std::vector<std::int8_t> B(64);
+        std::vector<std::int32_t> C(1);
+        REQUIRE_THROWS_AS( Math::Gemm::gemmU8S8(1, 1, 63, A.data(), 64, B.data(), 64, C.data(), 1), std::invalid_argument );
+    }
+}
@@ -0,0 +1,59 @@
+//
+// Created by timwe on 11/15/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <stdexcept>
+
+#include "../../Math/Matrix.h"
+
+using Catch::Approx;
+
+TEST_CASE("MATRIX EXPRESSIONS") {
+    Math::Matrix<float> A(3, 5), B(3, 5), bias(3, 1);
+    for (std::size_t r = 0; r < 3; ++r) {
+        bias(r, 0) = static_cast<float>(r);
+        for (std::size_t c = 0; c < 5; ++c) {
+            A(r, c) = 0.1f * static_cast<float>(r * 5 + c) + 0.05f;
+            B(r, c) = 1.0f - 0.03f * static_cast<float>(r + c);
+        }
+    }
+
+    SECTION("fused expression matches the eager operations") {
+        const Math::Matrix<float> eager = A.hadamard(B).sub(A.scalarMul(2.0f)).divide(B).addBias(bias).tanh();
+        const Math::Matrix<float> fused(Math::Expr::tanh(Math::Expr::addBias(
+            Math::Expr::divide(Math::Expr::hadamard(Math::lazy(A), Math::lazy(B)) - Math::lazy(A) * 2.0f, Math::lazy(B)), bias)));
+
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 5; ++c)
+                REQUIRE( fused(r, c) == Approx(eager(r, c)).epsilon(1e-6) );
+    }
+
+    SECTION("assigning to an operand updates in place") {
+        const auto before = A;
+        const float* buffer = A.data().data();
+        A = Math::lazy(A) - Math::lazy(B) * 0.5f;
+
+        REQUIRE( A.data().data() == buffer );
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 5; ++c)
+                REQUIRE( A(r, c) == Approx(before(r, c) - 0.5f * B(r, c)) );
+    }
+
+    SECTION("padding stays zero and mean ignores it") {
+        const Math::Matrix<float> s = A.sigmoid(); // sigmoid(0) = 0.5 must not leak into the padding
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = s.cols(); c < s.stride(); ++c)
+                REQUIRE( s.data()[r * s.stride() + c] == 0.0f );
+
+        REQUIRE( Math::Expr::mean(Math::lazy(A) + 1.0f) == Approx(A.mean() + 1.0f) );
+    }
+
+    SECTION("shape mismatch throws") {
+        Math::Matrix<float> C(3, 4);
+        REQUIRE_THROWS_AS( Math::lazy(A) + Math::lazy(C), std::invalid_argument );
+        REQUIRE_THROWS_AS( Math::Expr::addBias(Math::lazy(A), C), std::invalid_argument );
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created by timwe on 11/20/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <stdexcept>
+
+#include "../../Math/Matrix.h"
+
+TEST_CASE("MATRIX VIEWS") {
+    Math::Matrix<float> X(4, 10); // stride 16
+    for (std::size_t r = 0; r < 4; ++r)
+        for (std::size_t c = 0; c < 10; ++c)
+            X(r, c) = static_cast<float>(r * 10 + c);
+
+    SECTION("slices point into the parent") {
+        const auto batch = X.view().colRange(3, 5);
+        REQUIRE( batch.rows() == 4 );
+        REQUIRE( batch.cols() == 5 );
+        REQUIRE( batch.stride() == X.stride() );
+        REQUIRE( &batch(2, 1) == &X(2, 4) );
+
+        const auto block = batch.rowRange(1, 2).colRange(1, 2);
+        REQUIRE( block(1, 1) == X(2, 5) );
+        REQUIRE_THROWS_AS( batch.colRange(4, 2), std::out_of_range );
+
+        const Math::Matrix<float> copy(batch);
+        REQUIRE( copy.stride() == 8 );
+        REQUIRE( copy(3, 4) == X(3, 7) );
+        REQUIRE( copy.data()[5] == 0.0f ); // padding of the copy
+    }
+
+    SECTION("kernels take views like matrices") {
+        const auto batch = X.view().colRange(2, 7);
+        const Math::Matrix<float> copy(batch);
+
+        Math::Matrix<float> W(3, 4);
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 4; ++c)
+                W(r, c) = 0.5f * static_cast<float>(r) - 0.25f * static_cast<float>(c);
+
+        const auto fromView = W.matMul(batch);
+        const auto fromCopy = W.matMul(copy);
+        Math::Matrix<float> mapped, fused(Math::lazy(batch) * 2.0f + Math::lazy(copy));
+        Math::mapInto(mapped, [](float a, float b){ return a - b; }, batch, copy);
+
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 7; ++c)
+                REQUIRE( fromView(r, c) == fromCopy(r, c) );
+        for (std::size_t r = 0; r < 4; ++r) {
+            for (std::size_t c = 0; c < 7; ++c) {
+                REQUIRE( mapped(r, c) == 0.0f );
+                REQUIRE( fused(r, c) == Catch::Approx(3.0f * X(r, c + 2)) );
+            }
+            REQUIRE( mapped.data()[r * mapped.stride() + 7] == 0.0f );
+        }
+    }
+
+    SECTION("element access follows the bounds check policy, unchecked() never checks") {
+        const auto batch = X.view().colRange(3, 5);
+        REQUIRE( &X.unchecked(2, 4) == &X(2, 4) );
+        REQUIRE( &batch.unchecked(1, 2) == &batch(1, 2) );
+        REQUIRE( noexcept(X.unchecked(0, 0)) );
+        REQUIRE( noexcept(X(0, 0)) == !Math::boundsChecked );
+
+        if constexpr (Math::boundsChecked) {
+            REQUIRE_THROWS_AS( X(4, 0), std::out_of_range );
+            REQUIRE_THROWS_AS( X(0, 10), std::out_of_range );
+            REQUIRE_THROWS_AS( batch(0, 5), std::out_of_range );
+        }
+    }
+}
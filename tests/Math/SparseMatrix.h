@@ -0,0 +1,126 @@
+//
+// Created by timwe on 11/27/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "../../Math/SparseMatrix.h"
+#include "../../Math/ThreadPool.h"
+#include "../../NeuralNetworks/NeuralNetwork.h"
+
+namespace {
+    // About density of the elements nonzero
+    template<class T>
+    Math::Matrix<T> sparseDense(std::size_t rows, std::size_t cols, double density, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<T> value(T{-1}, T{1});
+        std::bernoulli_distribution keep(density);
+        Math::Matrix<T> M(rows, cols);
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = 0; c < cols; ++c)
+                M(r, c) = keep(gen) ? value(gen) : T{0};
+        return M;
+    }
+
+    template<class T>
+    void requireSameMatrix(const Math::Matrix<T>& A, const Math::Matrix<T>& B) {
+        REQUIRE( A.rows() == B.rows() );
+        REQUIRE( A.cols() == B.cols() );
+        for (std::size_t r = 0; r < A.rows(); ++r)
+            for (std::size_t c = 0; c < A.cols(); ++c)
+                REQUIRE( A(r, c) == Catch::Approx(B(r, c)).margin(1e-10) );
+    }
+}
+
+TEST_CASE("SPARSE") {
+    using Math::Gemm::Transpose;
+
+    SECTION("CSR from dense, triplets and back") {
+        const auto D = sparseDense<double>(13, 40, 0.1, 1);
+        const Math::SparseMatrix<double> S(D.view());
+        requireSameMatrix(S.toDense(), D);
+        requireSameMatrix(S.transpose().toDense(), D.transpose());
+        requireSameMatrix(S.rowRange(3, 5).toDense(), Math::Matrix<double>(D.view().rowRange(3, 5)));
+
+        const std::vector<Math::Triplet<float>> triplets = {{2, 5, 1.0f}, {0, 1, 2.0f}, {2, 0, 3.0f}, {2, 5, 0.5f}};
+        const auto T = Math::SparseMatrix<float>::fromTriplets(3, 6, triplets);
+        REQUIRE( T.nonZeros() == 3 ); // the two (2, 5) are added
+        REQUIRE( T.rowStart()[1] == 1 );
+        REQUIRE( T.rowStart()[2] == 1 );
+        REQUIRE( T.colIndex()[1] == 0 ); // sorted within the row
+        REQUIRE( T.toDense()(2, 5) == 1.5f );
+
+        REQUIRE_THROWS_AS( Math::SparseMatrix<float>(2, 3, {0, 2, 1}, {0, 1}, {1.0f, 1.0f}), std::invalid_argument );
+        REQUIRE_THROWS_AS( Math::SparseMatrix<float>(1, 3, {0, 2}, {1, 1}, {1.0f, 1.0f}), std::invalid_argument );
+        REQUIRE_THROWS_AS( Math::SparseMatrix<float>(1, 3, {0, 1}, {3}, {1.0f}), std::invalid_argument );
+    }
+
+    SECTION("sparse gemms match the dense gemm for every transpose, serial and parallel") {
+        const auto threadsBefore = Math::Parallel::threadCount();
+        const auto grainBefore = Math::Parallel::setGrainSize(64);
+        for (const std::size_t threads : {std::size_t{1}, std::size_t{4}}) {
+            Math::Parallel::setThreadCount(threads);
+            for (const auto& [tA, tB] : {std::pair{Transpose::No, Transpose::No}, {Transpose::No, Transpose::Yes},
+                                         {Transpose::Yes, Transpose::No}, {Transpose::Yes, Transpose::Yes}}) {
+                constexpr std::size_t m = 23, k = 57, n = 19;
+                const auto sparseA = sparseDense<double>(tA == Transpose::No ? m : k, tA == Transpose::No ? k : m, 0.05, 2);
+                const auto denseB = sparseDense<double>(tB == Transpose::No ? k : n, tB == Transpose::No ? n : k, 1.0, 3);
+                const auto denseA = sparseDense<double>(tA == Transpose::No ? m : k, tA == Transpose::No ? k : m, 1.0, 4);
+                const auto sparseB = sparseDense<double>(tB == Transpose::No ? k : n, tB == Transpose::No ? n : k, 0.05, 5);
+                const auto C0 = sparseDense<double>(m, n, 1.0, 6);
+
+                Math::Matrix<double> expected = C0, result = C0;
+                Math::matMulInto(expected, sparseA, denseB, tA, tB, 0.5, 2.0);
+                Math::matMulInto(result, Math::SparseMatrix<double>(sparseA.view()), denseB, tA, tB, 0.5, 2.0);
+                requireSameMatrix(result, expected);
+
+                Math::Matrix<double> expected2, result2(1, 1);
+                Math::matMulInto(expected2, denseA, sparseB, tA, tB);
+                Math::matMulInto(result2, denseA, Math::SparseMatrix<double>(sparseB.view()), tA, tB);
+                requireSameMatrix(result2, expected2);
+            }
+        }
+        Math::Parallel::setThreadCount(threadsBefore);
+        Math::Parallel::setGrainSize(grainBefore);
+
+        Math::Matrix<float> C(2, 2);
+        const Math::SparseMatrix<float> S(3, 4);
+        REQUIRE_THROWS_AS( Math::matMulInto(C, S, C.view()), std::invalid_argument );
+    }
+
+    SECTION("a sparse input trains the same network as its dense copy in both layouts") {
+        using NeuralNetworks::ActivationTypes;
+        constexpr std::size_t features = 300, samples = 64;
+        auto X = sparseDense<double>(features, samples, 0.02, 7);
+        Math::Matrix<double> Y(1, samples);
+        for (std::size_t i = 0; i < samples; ++i)
+            Y(0, i) = i % 3 == 0 ? 1.0 : 0.0;
+
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor}) {
+            Math::Matrix<double> Xl = X, Yl = Y;
+            if (layout == Math::Layout::SampleMajor) {
+                Xl.transposeSelf();
+                Yl.transposeSelf();
+            }
+            const Math::SparseMatrix<double> Xs(Xl.view());
+
+            auto build = [layout] {
+                NeuralNetworks::NeuralNetwork<double> nn(NeuralNetworks::LossType::BCE, 0.1, 15, 32, 11, layout);
+                nn.AddDenseLayer(features, 8, ActivationTypes::ReLU);
+                nn.AddDenseLayer(8, 1, ActivationTypes::Sigmoid);
+                return nn;
+            };
+            auto dense = build();
+            auto sparse = build();
+            REQUIRE( sparse.train(Xs, Yl) == Catch::Approx(dense.train(Xl, Yl)).epsilon(1e-10) );
+            requireSameMatrix(sparse.getLayers().front().getW(), dense.getLayers().front().getW());
+            requireSameMatrix(sparse.forward(Xs), dense.forward(Xl));
+        }
+    }
+}
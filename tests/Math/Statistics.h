@@ -0,0 +1,171 @@
+//
+// Created by timwe on 11/25/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../../Math/Statistics.h"
+#include "../../Math/ThreadPool.h"
+#include "../../NeuralNetworks/NeuralNetwork.h"
+
+namespace {
+    template<class T>
+    Math::Matrix<T> randomStatisticsMatrix(std::size_t rows, std::size_t cols, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<T> dist(T{3}, T{2});
+        Math::Matrix<T> M(rows, cols);
+        for (std::size_t r = 0; r < rows; r++)
+            for (std::size_t c = 0; c < cols; c++)
+                M(r, c) = dist(gen);
+        return M;
+    }
+
+    // naive two pass reference in double
+    template<class T>
+    void requireMatchesTwoPass(const Math::RowStatistics<T>& s, const std::vector<double>& values) {
+        double mean = 0;
+        for (double v : values) mean += v;
+        mean /= static_cast<double>(values.size());
+        double m2 = 0;
+        for (double v : values) m2 += (v - mean) * (v - mean);
+        const double variance = values.size() > 1 ? m2 / static_cast<double>(values.size() - 1) : 0.0;
+
+        REQUIRE( s.count == values.size() );
+        REQUIRE( s.mean == Catch::Approx(mean).margin(1e-4) );
+        REQUIRE( s.variance == Catch::Approx(variance).epsilon(1e-4).margin(1e-6) );
+        REQUIRE( s.min == static_cast<T>(*std::min_element(values.begin(), values.end())) );
+        REQUIRE( s.max == static_cast<T>(*std::max_element(values.begin(), values.end())) );
+    }
+}
+
+TEST_CASE("STATISTICS") {
+    SECTION("row statistics match a two pass computation") {
+        for (std::size_t cols : {1, 2, 7, 16, 1000, 1024, 1031, 5000}) {
+            const auto M = randomStatisticsMatrix<float>(5, cols, static_cast<unsigned>(cols));
+            const auto D = randomStatisticsMatrix<double>(3, cols, static_cast<unsigned>(cols) + 1);
+            const auto stats = Math::rowStatistics(M);
+            const auto statsD = Math::rowStatistics(D);
+            REQUIRE( stats.size() == 5 );
+            for (std::size_t r = 0; r < M.rows(); r++) {
+                std::vector<double> row;
+                for (std::size_t c = 0; c < cols; c++) row.push_back(M(r, c));
+                requireMatchesTwoPass(stats[r], row);
+                REQUIRE( M.stdDevOfRow(r) == Catch::Approx(stats[r].stdDev()).epsilon(1e-5).margin(1e-6) );
+            }
+            for (std::size_t r = 0; r < D.rows(); r++) {
+                std::vector<double> row;
+                for (std::size_t c = 0; c < cols; c++) row.push_back(D(r, c));
+                requireMatchesTwoPass(statsD[r], row);
+            }
+        }
+    }
+
+    SECTION("a large offset doesn't cancel the variance") {
+        Math::Matrix<float> M(1, 3000);
+        for (std::size_t c = 0; c < M.cols(); c++)
+            M(0, c) = 1e4f + static_cast<float>(c % 3); // variance ~2/3
+        REQUIRE( Math::rowStatistics(M)[0].variance == Catch::Approx(2.0 / 3.0).epsilon(1e-2) );
+    }
+
+    SECTION("column statistics are the row statistics of the transpose") {
+        const auto M = randomStatisticsMatrix<double>(1500, 19, 7);
+        const auto columns = Math::columnStatistics(M);
+        const auto rows = Math::rowStatistics(Math::Matrix<double>(M).transpose());
+        REQUIRE( columns.size() == 19 );
+        for (std::size_t c = 0; c < columns.size(); c++) {
+            REQUIRE( columns[c].count == 1500 );
+            REQUIRE( columns[c].mean == Catch::Approx(rows[c].mean) );
+            REQUIRE( columns[c].variance == Catch::Approx(rows[c].variance) );
+            REQUIRE( columns[c].min == rows[c].min );
+            REQUIRE( columns[c].max == rows[c].max );
+        }
+    }
+
+    SECTION("quantiles interpolate between the order statistics") {
+        Math::Matrix<float> M(2, 5);
+        const float values[2][5] = {{5, 1, 4, 2, 3}, {10, 10, 10, 10, 10}};
+        for (std::size_t r = 0; r < 2; r++)
+            for (std::size_t c = 0; c < 5; c++)
+                M(r, c) = values[r][c];
+        const float q[] = {0.0f, 0.25f, 0.5f, 0.6f, 1.0f};
+        const auto Q = Math::rowQuantiles(M, std::span<const float>(q));
+        REQUIRE( Q.rows() == 2 );
+        REQUIRE( Q.cols() == 5 );
+        REQUIRE( Q(0, 0) == 1.0f );
+        REQUIRE( Q(0, 1) == 2.0f );
+        REQUIRE( Q(0, 2) == 3.0f );
+        REQUIRE( Q(0, 3) == Catch::Approx(3.4f) );
+        REQUIRE( Q(0, 4) == 5.0f );
+        for (std::size_t i = 0; i < 5; i++)
+            REQUIRE( Q(1, i) == 10.0f );
+        REQUIRE( M(0, 0) == 5.0f ); // input is untouched
+    }
+
+    SECTION("results don't depend on the thread count") {
+        const auto M = randomStatisticsMatrix<float>(64, 3000, 11);
+        const auto before = Math::Parallel::threadCount();
+        Math::Parallel::setThreadCount(1);
+        const auto serial = Math::rowStatistics(M);
+        const auto serialColumns = Math::columnStatistics(M);
+        Math::Parallel::setThreadCount(4);
+        const auto parallel = Math::rowStatistics(M);
+        const auto parallelColumns = Math::columnStatistics(M);
+        Math::Parallel::setThreadCount(before);
+        for (std::size_t r = 0; r < serial.size(); r++) {
+            REQUIRE( serial[r].mean == parallel[r].mean );
+            REQUIRE( serial[r].variance == parallel[r].variance );
+        }
+        for (std::size_t c = 0; c < serialColumns.size(); c++) {
+            REQUIRE( serialColumns[c].mean == parallelColumns[c].mean );
+            REQUIRE( serialColumns[c].variance == parallelColumns[c].variance );
+        }
+    }
+
+    SECTION("scalers agree between the layouts and with their definitions") {
+        using Net = NeuralNetworks::NeuralNetwork<double>;
+        const auto X = randomStatisticsMatrix<double>(4, 101, 3); // feature-major
+        for (auto scaler : {NeuralNetworks::ScalerType::zScore, NeuralNetworks::ScalerType::minMax, NeuralNetworks::ScalerType::robust}) {
+            Math::Matrix<double> featureMajor(X), sampleMajor(Math::Matrix<double>(X).transpose()), single(X);
+            Net::inplaceScaleFeatures(featureMajor, scaler);
+            Net::inplaceScaleFeatures(sampleMajor, scaler, Math::Layout::SampleMajor);
+            for (std::size_t f = 0; f < X.rows(); f++)
+                Net::inplaceScaleFeature(f, single, scaler);
+
+            for (std::size_t f = 0; f < X.rows(); f++)
+                for (std::size_t s = 0; s < X.cols(); s++) {
+                    REQUIRE( featureMajor(f, s) == Catch::Approx(sampleMajor(s, f)) );
+                    REQUIRE( featureMajor(f, s) == single(f, s) );
+                }
+
+            const auto stats = Math::rowStatistics(featureMajor);
+            const double q[] = {0.25, 0.5, 0.75};
+            const auto Q = Math::rowQuantiles(featureMajor, std::span<const double>(q));
+            for (std::size_t f = 0; f < X.rows(); f++) {
+                if (scaler == NeuralNetworks::ScalerType::zScore) {
+                    REQUIRE( stats[f].mean == Catch::Approx(0.0).margin(1e-12) );
+                    REQUIRE( stats[f].variance == Catch::Approx(1.0) );
+                } else if (scaler == NeuralNetworks::ScalerType::minMax) {
+                    REQUIRE( stats[f].min == Catch::Approx(0.0).margin(1e-12) );
+                    REQUIRE( stats[f].max == Catch::Approx(1.0) );
+                } else {
+                    REQUIRE( Q(f, 1) == Catch::Approx(0.0).margin(1e-12) );
+                    REQUIRE( Q(f, 2) - Q(f, 0) == Catch::Approx(1.0) );
+                }
+            }
+        }
+    }
+
+    SECTION("a constant feature is only centered") {
+        Math::Matrix<float> X(1, 10);
+        X.fill(2.0f);
+        NeuralNetworks::NeuralNetwork<float>::inplaceScaleFeatures(X, NeuralNetworks::ScalerType::zScore);
+        for (std::size_t c = 0; c < X.cols(); c++)
+            REQUIRE( X(0, c) == 0.0f );
+    }
+}
@@ -0,0 +1,142 @@
+//
+// Created by timwe on 11/22/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "../../Math/Gemm.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/ThreadPool.h"
+
+TEST_CASE("THREAD POOL") {
+    const std::size_t previous = Math::Parallel::threadCount();
+
+    SECTION("every task runs exactly once") {
+        Math::Parallel::setThreadCount(4);
+        std::vector<std::atomic<int>> hits(1000);
+        Math::Parallel::parallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); });
+        for (const auto& h : hits)
+            REQUIRE( h.load() == 1 );
+    }
+
+    SECTION("nested jobs run serially on the task's thread") {
+        Math::Parallel::setThreadCount(4);
+        std::atomic<int> inner{0}, wrongThread{0}, outsideRegion{0}; // no REQUIRE on the workers, Catch isn't thread safe
+        Math::Parallel::parallelFor(8, [&](std::size_t) {
+            if (!Math::Parallel::inParallelRegion())
+                outsideRegion.fetch_add(1);
+            const auto id = std::this_thread::get_id();
+            Math::Parallel::parallelFor(16, [&](std::size_t) {
+                inner.fetch_add(1);
+                if (std::this_thread::get_id() != id)
+                    wrongThread.fetch_add(1);
+            });
+        });
+        REQUIRE( inner.load() == 8 * 16 );
+        REQUIRE( wrongThread.load() == 0 );
+        REQUIRE( outsideRegion.load() == 0 );
+        REQUIRE_FALSE( Math::Parallel::inParallelRegion() );
+    }
+
+    SECTION("parallel gemm gives the same bits for every thread count") {
+        using Math::Gemm::Transpose;
+        struct Shape { std::size_t M, N, K; Transpose transA, transB; };
+        for (const auto& s : {Shape{128, 3000, 12, Transpose::No, Transpose::No}, Shape{64, 128, 3000, Transpose::No, Transpose::Yes},
+                              Shape{128, 2001, 64, Transpose::Yes, Transpose::No}, Shape{1, 20000, 64, Transpose::No, Transpose::No}}) {
+            const std::size_t lda = s.transA == Transpose::No ? s.K : s.M, ldb = s.transB == Transpose::No ? s.N : s.K;
+            std::vector<float> A(s.M * s.K), B(s.K * s.N);
+            for (std::size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 17) * 0.25f - 2.0f;
+            for (std::size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 13) * 0.125f - 0.75f;
+
+            auto run = [&](std::size_t threads) {
+                Math::Parallel::setThreadCount(threads);
+                std::vector<float> C(s.M * s.N);
+                Math::Gemm::gemm<float>(s.transA, s.transB, s.M, s.N, s.K, 0.5f, A.data(), lda, B.data(), ldb, 0.0f, C.data(), s.N);
+                return C;
+            };
+
+            const auto serial = run(1);
+            REQUIRE( run(3) == serial );
+            REQUIRE( run(8) == serial );
+        }
+    }
+
+    Math::Parallel::setThreadCount(previous);
+}
+
+TEST_CASE("PARALLEL ELEMENT-WISE AND REDUCTIONS") {
+    const std::size_t threads = Math::Parallel::threadCount();
+    const std::size_t grain = Math::Parallel::setGrainSize(64); // many chunks even for small matrices
+
+    Math::Matrix<float> A(37, 300), B(37, 300), bias(37, 1);
+    for (std::size_t r = 0; r < A.rows(); ++r) {
+        bias(r, 0) = static_cast<float>(r) * 0.01f;
+        for (std::size_t c = 0; c < A.cols(); ++c) {
+            A(r, c) = std::sin(static_cast<float>(r * 300 + c));
+            B(r, c) = std::cos(static_cast<float>(r + c));
+        }
+    }
+
+    struct Results {
+        Math::Matrix<float> sum, product, tanh, biased, rowSums, colSums;
+        float mean, exprMean, rowMean;
+        Math::Matrix<float> fused, fusedRowSums, fusedColSums;
+    };
+    auto compute = [&](std::size_t count) {
+        Math::Parallel::setThreadCount(count);
+        Results res{A.add(B), A.hadamard(B), A.tanh(), A.addBias(bias), A.sumOverColumns(), A.sumOverRows(),
+                    A.mean(), Math::Expr::mean(Math::Expr::hadamard(Math::lazy(A), Math::lazy(B))), A.meanOfRow(5),
+                    Math::Matrix<float>(), Math::Matrix<float>(), Math::Matrix<float>()};
+        Math::apply(res.sum, [](float x) { return 2.0f * x; });
+        Math::Matrix<float> discard;
+        Math::mapSumInto(res.fused, res.fusedRowSums, Math::SumOver::Columns, 0.5f, [](float a, float b) { return a * b; }, A, B);
+        Math::mapSumInto(discard, res.fusedColSums, Math::SumOver::Rows, 0.5f, [](float a, float b) { return a * b; }, A, B);
+        return res;
+    };
+
+    const Results serial = compute(1);
+    const Results parallel = compute(4);
+    for (const auto& [s, p] : {std::pair{&serial.sum, &parallel.sum}, {&serial.product, &parallel.product}, {&serial.tanh, &parallel.tanh},
+                               {&serial.biased, &parallel.biased}, {&serial.rowSums, &parallel.rowSums}, {&serial.colSums, &parallel.colSums},
+                               {&serial.fused, &parallel.fused}, {&serial.fusedRowSums, &parallel.fusedRowSums}, {&serial.fusedColSums, &parallel.fusedColSums}})
+        REQUIRE( std::ranges::equal(s->data(), p->data()) ); // padding included
+    REQUIRE( serial.mean == parallel.mean ); // same blocks, same order of the partials
+    REQUIRE( serial.exprMean == parallel.exprMean );
+    REQUIRE( serial.rowMean == parallel.rowMean );
+
+    for (std::size_t r = 0; r < A.rows(); ++r) {
+        double rowSum = 0;
+        for (std::size_t c = 0; c < A.cols(); ++c) {
+            rowSum += A(r, c);
+            REQUIRE( parallel.sum(r, c) == Approx(2.0f * (A(r, c) + B(r, c))) );
+            REQUIRE( parallel.biased(r, c) == Approx(A(r, c) + bias(r, 0)) );
+        }
+        REQUIRE( parallel.rowSums(r, 0) == Approx(rowSum).margin(1e-4) );
+    }
+    double colSum = 0, total = 0;
+    for (std::size_t r = 0; r < A.rows(); ++r) {
+        colSum += A(r, 7);
+        for (std::size_t c = 0; c < A.cols(); ++c)
+            total += A(r, c);
+    }
+    REQUIRE( parallel.colSums(0, 7) == Approx(colSum).margin(1e-4) );
+    REQUIRE( parallel.mean == Approx(total / A.elementCount()).margin(1e-5) );
+
+    // mapSumInto: the map and half its sums in the same sweep
+    REQUIRE( std::ranges::equal(parallel.fused.data(), parallel.product.data()) );
+    const auto halfRowSums = parallel.product.sumOverColumns(), halfColSums = parallel.product.sumOverRows();
+    for (std::size_t r = 0; r < A.rows(); ++r)
+        REQUIRE( parallel.fusedRowSums(r, 0) == Approx(0.5f * halfRowSums(r, 0)).margin(1e-4) );
+    for (std::size_t c = 0; c < A.cols(); ++c)
+        REQUIRE( parallel.fusedColSums(0, c) == Approx(0.5f * halfColSums(0, c)).margin(1e-4) );
+
+    Math::Parallel::setGrainSize(grain);
+    Math::Parallel::setThreadCount(threads);
+}
@@ -0,0 +1,96 @@
+//
+// Created by timwe on 11/26/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <utility>
+
+#include "../../Math/Dispatch.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/ThreadPool.h"
+
+namespace {
+    template<class T>
+    Math::Matrix<T> numberedMatrix(std::size_t rows, std::size_t cols) {
+        Math::Matrix<T> A(rows, cols);
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = 0; c < cols; ++c)
+                A(r, c) = static_cast<T>(static_cast<float>(r * 256 + c % 256));
+        return A;
+    }
+
+    template<class T>
+    void requireTransposed(const Math::Matrix<T>& B, const Math::Matrix<T>& A) {
+        REQUIRE( B.rows() == A.cols() );
+        REQUIRE( B.cols() == A.rows() );
+        bool same = true, paddingZero = true;
+        for (std::size_t r = 0; r < A.rows(); ++r)
+            for (std::size_t c = 0; c < A.cols(); ++c)
+                same = same && static_cast<float>(B(c, r)) == static_cast<float>(A(r, c));
+        for (std::size_t r = 0; r < B.rows(); ++r)
+            for (std::size_t c = B.cols(); c < B.stride(); ++c)
+                paddingZero = paddingZero && static_cast<float>(B.data()[r * B.stride() + c]) == 0.0f;
+        REQUIRE( same );
+        REQUIRE( paddingZero );
+    }
+
+    template<class T>
+    void requireTransposesOnAllShapes() {
+        for (const auto& [rows, cols] : {std::pair<std::size_t, std::size_t>{1, 1}, {7, 9}, {8, 8}, {4, 33}, {33, 65}, {200, 3}, {3, 200}, {513, 257}}) {
+            const auto A = numberedMatrix<T>(rows, cols);
+            requireTransposed(A.transpose(), A);
+
+            auto B = A;
+            B.transposeSelf();
+            requireTransposed(B, A);
+        }
+        for (const std::size_t n : {1, 4, 8, 31, 32, 33, 100, 257}) {
+            const auto A = numberedMatrix<T>(n, n);
+            auto B = A;
+            B.transposeSelf();
+            requireTransposed(B, A);
+        }
+    }
+}
+
+TEST_CASE("TRANSPOSE") {
+    SECTION("out of place and in place on every ISA level, serial and parallel") {
+        using Math::Dispatch::IsaLevel;
+        const auto previous = Math::Dispatch::activeIsa();
+        const auto threadsBefore = Math::Parallel::threadCount();
+        const auto grainBefore = Math::Parallel::setGrainSize(1024); // the larger shapes get split into panels
+        for (const auto level : {IsaLevel::Generic, IsaLevel::AVX2, IsaLevel::AVX512}) {
+            if (Math::Dispatch::setIsa(level) != level)
+                continue;
+            for (const std::size_t threads : {std::size_t{1}, std::size_t{4}}) {
+                Math::Parallel::setThreadCount(threads);
+                requireTransposesOnAllShapes<float>();
+                requireTransposesOnAllShapes<double>();
+            }
+        }
+        requireTransposesOnAllShapes<Math::bfloat16>();
+        Math::Dispatch::setIsa(previous);
+        Math::Parallel::setThreadCount(threadsBefore);
+        Math::Parallel::setGrainSize(grainBefore);
+    }
+
+    SECTION("transposeInto a view, reusing the result") {
+        const auto A = numberedMatrix<float>(50, 70);
+        Math::Matrix<float> result(3, 3);
+        Math::transposeInto(result, A.view().block(5, 10, 20, 41));
+        REQUIRE( result.rows() == 41 );
+        REQUIRE( result.cols() == 20 );
+        for (std::size_t r = 0; r < 20; ++r)
+            for (std::size_t c = 0; c < 41; ++c)
+                REQUIRE( result(c, r) == A(r + 5, c + 10) );
+
+        const float* buffer = result.data().data();
+        Math::transposeInto(result, A.view().block(0, 0, 20, 41));
+        REQUIRE( result.data().data() == buffer ); // same shape, no new buffer
+        REQUIRE( result(40, 19) == A(19, 40) );
+
+        REQUIRE_THROWS_AS( Math::transposeInto(result, result.view()), std::invalid_argument );
+    }
+}
@@ -0,0 +1,131 @@
+//
+// Created by timwe on 11/17/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "../../Math/Dispatch.h"
+#include "../../Math/Matrix.h"
+
+namespace VectorMathTest {
+    // Distance of a and b in representable numbers (ulp)
+    template<class T>
+    std::int64_t ulpDistance(T a, T b) {
+        using I = std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>;
+        auto ordered = [](T x) {
+            I i;
+            std::memcpy(&i, &x, sizeof(T));
+            return i < 0 ? static_cast<std::int64_t>(std::numeric_limits<I>::min()) - i : static_cast<std::int64_t>(i);
+        };
+        const std::int64_t d = ordered(a) - ordered(b);
+        return d < 0 ? -d : d;
+    }
+
+    // Runs on the active Dispatch level
+    template<class T, class Op, class Ref>
+    std::int64_t maxUlp(const Op& op, Ref reference, long double lo, long double hi, std::size_t n = 20001) {
+        std::vector<T> x(n), y(n);
+        for (std::size_t i = 0; i < n; ++i)
+            x[i] = static_cast<T>(lo + (hi - lo) * static_cast<long double>(i) / static_cast<long double>(n - 1));
+
+        Math::Dispatch::transform(x.data(), y.data(), n, op);
+
+        std::int64_t result = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            result = std::max(result, ulpDistance(y[i], static_cast<T>(reference(static_cast<long double>(x[i])))));
+        return result;
+    }
+
+    // Checks the bounds documented in VectorMath.h (float / double)
+    template<class T>
+    void checkBounds() {
+        using namespace Math::Simd;
+        INFO( "ISA level " << Math::Dispatch::isaName(Math::Dispatch::activeIsa()) );
+        constexpr bool f = std::is_same_v<T, float>;
+
+        CHECK( maxUlp<T>(Exp{}, [](long double v){ return std::exp(v); }, f ? -87 : -708, f ? 88 : 709) <= 1 );
+        CHECK( maxUlp<T>(Expm1{}, [](long double v){ return std::expm1(v); }, -30, 80) <= 2 );
+        CHECK( maxUlp<T>(Expm1{}, [](long double v){ return std::expm1(v); }, -1, 1) <= 2 );
+        CHECK( maxUlp<T>(Log{}, [](long double v){ return std::log(v); }, 1e-30, 1e6) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Log{}, [](long double v){ return std::log(v); }, 0.2, 3) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Log{10.0}, [](long double v){ return std::log10(v); }, 0.2, 300) <= (f ? 5 : 4) ); // one more rounding for the base
+        CHECK( maxUlp<T>(Log1p{}, [](long double v){ return std::log1p(v); }, -0.99, 5) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Log1p{}, [](long double v){ return std::log1p(v); }, -1e-3, 1e-3) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Tanh{}, [](long double v){ return std::tanh(v); }, -20, 20) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Tanh{}, [](long double v){ return std::tanh(v); }, -1e-2, 1e-2) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Sigmoid{}, [](long double v){ return 1 / (1 + std::exp(-v)); }, -80, 80) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Softplus{}, [](long double v){ return std::log1p(std::exp(v)); }, -80, 80) <= (f ? 4 : 3) );
+        CHECK( maxUlp<T>(Mish{}, [](long double v){ return v * std::tanh(std::log1p(std::exp(v))); }, -60, 60) <= (f ? 7 : 6) );
+        CHECK( maxUlp<T>(Selu{}, [](long double v){ return Selu::lambda * (v > 0 ? v : Selu::alpha * std::expm1(v)); }, -30, 30) <= 4 );
+        CHECK( maxUlp<T>(LeakyRelu(0.1), [](long double v){ return v > 0 ? v : static_cast<T>(0.1) * static_cast<T>(v); }, -30, 30) == 0 );
+    }
+
+    template<class Op>
+    float single(const Op& op, float x) {
+        float y;
+        Math::Dispatch::transform(&x, &y, 1, op);
+        return y;
+    }
+}
+
+TEST_CASE("VECTOR MATH ULP BOUNDS") {
+    using Math::Dispatch::IsaLevel;
+    const auto previous = Math::Dispatch::activeIsa();
+
+    // every level this CPU can run, not only the one dispatch would pick
+    for (int level = 0; level <= static_cast<int>(Math::Dispatch::detectedIsa()); ++level) {
+        REQUIRE( Math::Dispatch::setIsa(static_cast<IsaLevel>(level)) == static_cast<IsaLevel>(level) );
+        VectorMathTest::checkBounds<float>();
+        VectorMathTest::checkBounds<double>();
+    }
+
+    Math::Dispatch::setIsa(previous);
+}
+
+TEST_CASE("VECTOR MATH EDGES") {
+    using namespace Math::Simd;
+    using VectorMathTest::single;
+
+    const auto previous = Math::Dispatch::activeIsa();
+    for (int level = 0; level <= static_cast<int>(Math::Dispatch::detectedIsa()); ++level) {
+        INFO( "ISA level " << level );
+        Math::Dispatch::setIsa(static_cast<Math::Dispatch::IsaLevel>(level));
+        REQUIRE( single(Exp{}, -200.0f) == 0.0f );
+        REQUIRE( single(Sigmoid{}, -200.0f) == 0.0f );
+        REQUIRE( single(Sigmoid{}, 200.0f) == 1.0f );
+        REQUIRE( single(Sigmoid{}, 0.0f) == 0.5f );
+        REQUIRE( single(Tanh{}, -50.0f) == -1.0f );
+        REQUIRE( single(Softplus{}, 100.0f) == 100.0f );
+    }
+    Math::Dispatch::setIsa(previous);
+
+    SECTION("forcing a level is clamped to what the CPU has") {
+        const auto previous = Math::Dispatch::activeIsa();
+        REQUIRE( Math::Dispatch::setIsa(Math::Dispatch::IsaLevel::AVX512) == Math::Dispatch::detectedIsa() );
+        REQUIRE( Math::Dispatch::setIsa(Math::Dispatch::IsaLevel::Generic) == Math::Dispatch::IsaLevel::Generic );
+        Math::Dispatch::setIsa(previous);
+    }
+
+    SECTION("matrix activations keep the padding at zero and handle the tail") {
+        Math::Matrix<float> A(3, 5, 5); // no padding, 15 elements so the last register is partial
+        for (std::size_t i = 0; i < A.bufferSize(); ++i)
+            A.data()[i] = -3.0f + 0.4f * static_cast<float>(i);
+
+        const auto T = A.tanh();
+        for (std::size_t r = 0; r < 3; ++r)
+            for (std::size_t c = 0; c < 5; ++c)
+                REQUIRE( VectorMathTest::ulpDistance(T(r, c), std::tanh(A(r, c))) <= 4 );
+
+        Math::Matrix<float> P(2, 3); // stride 8
+        P.fill(0.5f);
+        const auto S = P.sigmoid();
+        for (std::size_t c = S.cols(); c < S.stride(); ++c)
+            REQUIRE( S.data()[c] == 0.0f );
+    }
+}
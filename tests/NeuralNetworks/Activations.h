@@ -0,0 +1,124 @@
+//
+// Created by timwe on 12/2/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "../../NeuralNetworks/Activations.h"
+#include "../../NeuralNetworks/DenseLayer.h"
+
+TEST_CASE("ACTIVATION POLICIES") {
+    using NeuralNetworks::ActivationTypes;
+    using NeuralNetworks::DerivativeCache;
+    constexpr std::size_t n = 60;
+    constexpr double h = 1e-5;
+
+    // z from -2.95 to 2.95, none of them within h of a kink (0, the xc of Delu)
+    Math::Matrix<double> Z(1, n), Zplus(1, n), Zminus(1, n), dA(1, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Z(0, i) = -2.95 + 0.1 * static_cast<double>(i);
+        Zplus(0, i) = Z(0, i) + h;
+        Zminus(0, i) = Z(0, i) - h;
+        dA(0, i) = 0.5 + 0.01 * static_cast<double>(i);
+    }
+
+    SECTION("every derivative matches the difference quotient of its forward op") {
+        for (const auto type : {ActivationTypes::ReLU, ActivationTypes::Sigmoid, ActivationTypes::Softplus, ActivationTypes::Delu,
+                                ActivationTypes::Elu, ActivationTypes::Tanh, ActivationTypes::SELU, ActivationTypes::LeakyReLU,
+                                ActivationTypes::Mish, ActivationTypes::Linear}) {
+            INFO( "activation " << static_cast<int>(type) );
+            const auto kernels = NeuralNetworks::activationKernels<double>(type);
+            REQUIRE( kernels.type == type );
+
+            Math::Matrix<double> A, Aplus, Aminus, dZ, db;
+            Math::activationInto(A, Z, kernels.forward, kernels.parameter);
+            Math::activationInto(Aplus, Zplus, kernels.forward, kernels.parameter);
+            Math::activationInto(Aminus, Zminus, kernels.forward, kernels.parameter);
+
+            const Math::MatrixView<const double> cache = kernels.cache == DerivativeCache::Z ? Z.view()
+                                                       : kernels.cache == DerivativeCache::A ? A.view() : Math::MatrixView<const double>{};
+            kernels.derivative(Math::Layout::FeatureMajor, dA, cache, kernels.parameter, dZ, db);
+
+            double sum = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const double slope = (Aplus(0, i) - Aminus(0, i)) / (2 * h);
+                REQUIRE( dZ(0, i) == Catch::Approx(dA(0, i) * slope).margin(1e-6) );
+                sum += dZ(0, i);
+            }
+            REQUIRE( db.rows() == 1 );
+            REQUIRE( db.cols() == 1 );
+            REQUIRE( db(0, 0) == Catch::Approx(sum / n) );
+        }
+    }
+
+    SECTION("SELU and LeakyReLU have ops of their own") {
+        Math::Matrix<double> out;
+        NeuralNetworks::activate(ActivationTypes::SELU, Z, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double z = Z(0, i);
+            REQUIRE( out(0, i) == Catch::Approx(1.0507009873554805 * (z > 0 ? z : 1.6732632423543772 * std::expm1(z))) );
+        }
+        NeuralNetworks::activate(ActivationTypes::LeakyReLU, Z, out);
+        for (std::size_t i = 0; i < n; ++i)
+            REQUIRE( out(0, i) == Catch::Approx(Z(0, i) > 0 ? Z(0, i) : 0.01 * Z(0, i)) );
+    }
+
+    SECTION("a layer's backward matches the difference quotient of its forward, with dZ over its cache") {
+        // L = sum(D * A), so dL/dA = D and backward(D) has to be dL/dAprev
+        constexpr std::size_t in = 4, out = 5, m = 7;
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor})
+            for (const auto type : {ActivationTypes::ReLU, ActivationTypes::Sigmoid, ActivationTypes::Softplus, ActivationTypes::Delu,
+                                    ActivationTypes::Elu, ActivationTypes::Tanh, ActivationTypes::SELU, ActivationTypes::LeakyReLU,
+                                    ActivationTypes::Mish, ActivationTypes::Linear}) {
+                INFO( "activation " << static_cast<int>(type) << ", layout " << static_cast<int>(layout) );
+                std::mt19937 gen(5);
+                std::uniform_real_distribution<double> uniform(-1.5, 1.5);
+                NeuralNetworks::DenseLayer<double> layer(in, out, type, gen, true, layout);
+                const bool featureMajor = layout == Math::Layout::FeatureMajor;
+                Math::Matrix<double> X(featureMajor ? in : m, featureMajor ? m : in), D(featureMajor ? out : m, featureMajor ? m : out);
+                for (std::size_t i = 0; i < X.rows(); ++i)
+                    for (std::size_t j = 0; j < X.cols(); ++j)
+                        X(i, j) = uniform(gen);
+                for (std::size_t i = 0; i < D.rows(); ++i)
+                    for (std::size_t j = 0; j < D.cols(); ++j)
+                        D(i, j) = uniform(gen);
+
+                auto loss = [&] {
+                    const auto& A = layer.forward(X);
+                    double sum = 0.0;
+                    for (std::size_t i = 0; i < A.rows(); ++i)
+                        for (std::size_t j = 0; j < A.cols(); ++j)
+                            sum += D(i, j) * A(i, j);
+                    return sum;
+                };
+
+                Math::Matrix<double> dX(X.rows(), X.cols());
+                for (int repeat = 0; repeat < 2; ++repeat) { // the second step runs on the buffers dZ went over
+                    (void)layer.forward(X);
+                    layer.backward(D, dX);
+                }
+                for (std::size_t i = 0; i < X.rows(); ++i)
+                    for (std::size_t j = 0; j < X.cols(); ++j) {
+                        const double x = X(i, j);
+                        X(i, j) = x + h;
+                        const double plus = loss();
+                        X(i, j) = x - h;
+                        const double minus = loss();
+                        X(i, j) = x;
+                        REQUIRE( dX(i, j) == Catch::Approx((plus - minus) / (2 * h)).margin(1e-6) );
+                    }
+            }
+    }
+
+    SECTION("an unknown activation throws instead of running as tanh") {
+        const auto unknown = static_cast<ActivationTypes>(99);
+        std::mt19937 gen(3);
+        REQUIRE_THROWS_AS( NeuralNetworks::activationKernels<float>(unknown), std::invalid_argument );
+        REQUIRE_THROWS_AS( NeuralNetworks::DenseLayer<float>(2, 3, unknown, gen), std::invalid_argument );
+    }
+}
@@ -0,0 +1,142 @@
+//
+// Created by timwe on 11/29/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "../../Math/SparseMatrix.h"
+#include "Fixtures.h"
+
+// Replaces the global allocation functions of the test binary with counting ones. Every heap allocation ends up
+// here: the matrices through the default memory resource (aligned new), std::vector and the rest through plain new
+namespace AllocationCounter {
+    inline std::atomic<std::size_t> count{0};
+
+    inline void* allocate(std::size_t size, std::size_t alignment) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t bytes = (size + alignment - 1) / alignment * alignment; // aligned_alloc wants a multiple
+        if (void* p = std::aligned_alloc(alignment, bytes == 0 ? alignment : bytes))
+            return p;
+        throw std::bad_alloc();
+    }
+} // AllocationCounter
+
+void* operator new(std::size_t size) { return AllocationCounter::allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return AllocationCounter::allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return AllocationCounter::allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return AllocationCounter::allocate(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+TEST_CASE("ALLOCATIONS") {
+    using NeuralNetworks::ActivationTypes;
+    using NeuralNetworks::LossType;
+
+    // Heap allocations of f(), REQUIREs stay outside so Catch doesn't count
+    auto allocationsOf = [](auto&& f) {
+        const std::size_t before = AllocationCounter::count.load();
+        f();
+        return AllocationCounter::count.load() - before;
+    };
+
+    auto data = [](std::size_t samples, Math::Layout layout) { return NetworkFixtures::dataset<float>(3, samples, layout); };
+
+    auto build = [](LossType loss, std::size_t epochs, Math::Layout layout, Math::Precision precision) {
+        return NetworkFixtures::network<float>({{3, 24, ActivationTypes::ReLU},
+                                                {24, 12, ActivationTypes::Tanh},
+                                                {12, 1, loss == LossType::BCE ? ActivationTypes::Sigmoid : ActivationTypes::Linear}},
+                                               loss, 0.05, epochs, 32, 11, layout, precision);
+    };
+
+    SECTION("the counter sees matrices and vectors") {
+        REQUIRE( allocationsOf([] { Math::Matrix<float> M(4, 4); }) == 1 );
+        REQUIRE( allocationsOf([] { std::vector<int> v(3); }) == 1 );
+    }
+
+    SECTION("epochs after the first don't allocate") {
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor})
+            for (const auto precision : {Math::Precision::Full, Math::Precision::BFloat16})
+                for (const auto loss : {LossType::MSE, LossType::BCE})
+                    for (const std::size_t samples : {std::size_t{64}, std::size_t{3000}}) {
+                        const auto [X, Y] = data(samples, layout);
+                        auto nn = build(loss, 3, layout, precision);
+
+                        (void)nn.train(X, Y); // sizes every buffer for this batch shape
+                        const std::size_t steady = allocationsOf([&] { (void)nn.train(X, Y); });
+                        const std::size_t manual = allocationsOf([&] {
+                            const auto& Yhat = nn.forward(X);
+                            (void)nn.compute_loss(Y, Yhat);
+                            nn.backward(Y, Yhat);
+                            nn.update();
+                        });
+                        REQUIRE( steady == 0 );
+                        REQUIRE( manual == 0 );
+                    }
+    }
+
+    SECTION("a sparse first layer doesn't allocate either") {
+        const auto [X, Y] = data(200, Math::Layout::FeatureMajor);
+        const Math::SparseMatrix<float> Xs(X.view());
+        NeuralNetworks::NeuralNetwork<float> nn(LossType::BCE, 0.05, 3, 32, 11);
+        nn.AddDenseLayer(3, 16, ActivationTypes::Elu);
+        nn.AddDenseLayer(16, 1, ActivationTypes::Sigmoid);
+
+        (void)nn.train(Xs, Y);
+        REQUIRE( allocationsOf([&] { (void)nn.train(Xs, Y); }) == 0 );
+    }
+
+    SECTION("predicting into kept buffers doesn't allocate") {
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor})
+            for (const auto precision : {Math::Precision::Full, Math::Precision::BFloat16}) {
+                const auto [X, Y] = data(3000, layout);
+                auto nn = build(LossType::BCE, 2, layout, precision);
+                (void)nn.train(X, Y);
+
+                Math::Matrix<float> Yhat;
+                NeuralNetworks::NeuralNetwork<float>::PredictBuffers buffers;
+                nn.predictInto(Yhat, X, buffers);
+                REQUIRE( allocationsOf([&] { nn.predictInto(Yhat, X, buffers); }) == 0 );
+            }
+    }
+
+    SECTION("checkpointed steps don't allocate") {
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor}) {
+            const auto [X, Y] = data(500, layout);
+            // the segments [0, 3) and [3, 6) have their widths in another order, the lent caches go by width
+            auto nn = NetworkFixtures::network<float>({{3, 16, ActivationTypes::ReLU},
+                                                       {16, 24, ActivationTypes::Tanh},
+                                                       {24, 16, ActivationTypes::Elu},
+                                                       {16, 24, ActivationTypes::Tanh},
+                                                       {24, 16, ActivationTypes::Elu},
+                                                       {16, 8, ActivationTypes::Tanh},
+                                                       {8, 1, ActivationTypes::Sigmoid}},
+                                                      LossType::BCE, 0.05, 2, 32, 11, layout);
+            nn.checkpointEvery(3);
+
+            (void)nn.train(X, Y);
+            REQUIRE( allocationsOf([&] { (void)nn.train(X, Y); }) == 0 );
+        }
+    }
+
+    SECTION("a new batch shape sizes the buffers once more") {
+        const auto [X, Y] = data(64, Math::Layout::FeatureMajor);
+        NeuralNetworks::NeuralNetwork<float> nn(LossType::MSE, 0.05, 2, 32, 11);
+        nn.AddDenseLayer(3, 8, ActivationTypes::Tanh);
+        nn.AddDenseLayer(8, 1, ActivationTypes::Linear);
+
+        (void)nn.train(X, Y);
+        const auto half = X.view().colRange(0, 32), halfY = Y.view().colRange(0, 32);
+        REQUIRE( allocationsOf([&] { (void)nn.train(half, halfY); }) > 0 );
+        REQUIRE( allocationsOf([&] { (void)nn.train(half, halfY); }) == 0 );
+    }
+}
@@ -0,0 +1,144 @@
+//
+// Created by timwe on 12/4/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "../../Math/SparseMatrix.h"
+#include "Fixtures.h"
+
+TEST_CASE("CHECKPOINTING") {
+    using NeuralNetworks::ActivationTypes;
+    using NeuralNetworks::LossType;
+    constexpr std::size_t samples = 200;
+
+    auto data = [](Math::Layout layout) { return NetworkFixtures::dataset<double>(3, samples, layout); };
+
+    // Z-based, A-based and cache-free derivatives in the segments, the BCE + Sigmoid trick at the end
+    auto build = [](Math::Layout layout) {
+        return NetworkFixtures::network<double>({{3, 16, ActivationTypes::ReLU},
+                                                 {16, 16, ActivationTypes::Tanh},
+                                                 {16, 12, ActivationTypes::Elu},
+                                                 {12, 16, ActivationTypes::Linear},
+                                                 {16, 16, ActivationTypes::Sigmoid},
+                                                 {16, 8, ActivationTypes::Mish},
+                                                 {8, 1, ActivationTypes::Sigmoid}},
+                                                LossType::BCE, 0.1, 12, 64, 9, layout);
+    };
+
+    auto sameWeights = [](const NeuralNetworks::NeuralNetwork<double>& a, const NeuralNetworks::NeuralNetwork<double>& b) {
+        for (std::size_t l = 0; l < a.getLayers().size(); ++l) {
+            const auto& la = a.getLayers()[l];
+            const auto& lb = b.getLayers()[l];
+            if (!std::ranges::equal(la.getW().data(), lb.getW().data()) || !std::ranges::equal(la.getB().data(), lb.getB().data()))
+                return false;
+        }
+        return true;
+    };
+
+    SECTION("checkpointed training takes bitwise the same steps") {
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor}) {
+            const auto [X, Y] = data(layout);
+            auto reference = build(layout);
+            const double loss = reference.train(X, Y);
+
+            for (const auto& policy : {std::vector<std::size_t>{1, 4}, std::vector<std::size_t>{0}, std::vector<std::size_t>{5},
+                                       std::vector<std::size_t>{2, 3, 6}}) {
+                INFO( "layout " << static_cast<int>(layout) << ", first checkpoint " << policy.front() );
+                auto nn = build(layout);
+                nn.checkpointAt(policy);
+                REQUIRE( nn.train(X, Y) == loss );
+                REQUIRE( sameWeights(nn, reference) );
+            }
+            for (const std::size_t k : {std::size_t{0}, std::size_t{2}, std::size_t{3}}) {
+                auto nn = build(layout);
+                nn.checkpointEvery(k);
+                REQUIRE( nn.train(X, Y) == loss );
+                REQUIRE( sameWeights(nn, reference) );
+            }
+        }
+    }
+
+    SECTION("a sparse input is recomputed from the sparse matrix") {
+        const auto [X, Y] = data(Math::Layout::FeatureMajor);
+        const Math::SparseMatrix<double> Xs(X.view());
+        auto reference = build(Math::Layout::FeatureMajor);
+        const double loss = reference.train(Xs, Y);
+
+        auto nn = build(Math::Layout::FeatureMajor);
+        nn.checkpointEvery(3);
+        REQUIRE( nn.train(Xs, Y) == loss );
+        REQUIRE( sameWeights(nn, reference) );
+        for (const std::size_t l : {0, 1, 3, 4}) // between the checkpoints 2 and 5, the lent caches went back
+            REQUIRE( nn.getLayers()[l].getA().rows() == 0 );
+        for (const std::size_t l : {2, 5, 6})
+            REQUIRE( nn.getLayers()[l].getA().cols() == samples );
+    }
+
+    SECTION("policies can change between steps") {
+        const auto [X, Y] = data(Math::Layout::FeatureMajor);
+        auto reference = build(Math::Layout::FeatureMajor);
+        auto nn = build(Math::Layout::FeatureMajor);
+        for (const std::size_t k : {std::size_t{2}, std::size_t{1}, std::size_t{4}, std::size_t{0}}) {
+            nn.checkpointEvery(k);
+            (void)nn.forward(X); // a forward without backward leaves the last segment holding the lent caches
+            const double loss = reference.train(X, Y);
+            REQUIRE( nn.train(X, Y) == loss );
+        }
+        REQUIRE( sameWeights(nn, reference) );
+    }
+
+    SECTION("a layer added after the policy extends the last segment") {
+        const auto [X, Y] = data(Math::Layout::FeatureMajor);
+        auto reference = build(Math::Layout::FeatureMajor);
+        reference.AddDenseLayer(1, 1, ActivationTypes::Sigmoid);
+        const double loss = reference.train(X, Y);
+
+        auto nn = build(Math::Layout::FeatureMajor);
+        nn.checkpointEvery(3);
+        (void)nn.forward(X);
+        REQUIRE( nn.getLayers()[6].getA().cols() == samples );
+        nn.AddDenseLayer(1, 1, ActivationTypes::Sigmoid);
+        REQUIRE( nn.getCheckpoints() == std::vector<std::size_t>{2, 5} );
+        REQUIRE( nn.getLayers()[6].getA().rows() == 0 ); // borrows from now on
+        REQUIRE( nn.train(X, Y) == loss );
+        REQUIRE( sameWeights(nn, reference) );
+    }
+
+    SECTION("the policies and what they cost") {
+        NeuralNetworks::NeuralNetwork<float> nn(LossType::MSE, 0.1, 1, 32, 1);
+        for (int l = 0; l < 9; ++l)
+            nn.AddDenseLayer(16, 16, ActivationTypes::Tanh); // A only
+
+        const auto none = nn.estimateCheckpointing(100);
+        REQUIRE( none.fullCacheBytes == (9 + 2) * 16 * 100 * sizeof(float) ); // every A, the two dAprev buffers
+        REQUIRE( none.cacheBytes == none.fullCacheBytes );
+        REQUIRE( none.extraForward == 0.0 );
+
+        nn.checkpointEvery(0); // ceil(sqrt(9))
+        REQUIRE( nn.getCheckpoints() == std::vector<std::size_t>{2, 5} );
+        const auto sqrtL = nn.estimateCheckpointing(100);
+        REQUIRE( sqrtL.fullCacheBytes == none.fullCacheBytes );
+        REQUIRE( sqrtL.cacheBytes == (3 + 2 + 2) * 16 * 100 * sizeof(float) ); // 3 checkpoints, 2 lent, 2 dAprev
+        REQUIRE( sqrtL.extraForward == Catch::Approx(4.0 / 9.0) ); // layers 0, 1, 3 and 4, the checkpoints keep theirs
+        REQUIRE( sqrtL.extraStepTime == Catch::Approx(4.0 / 27.0) );
+
+        nn.checkpointAt({8, 1, 1, 4});
+        REQUIRE( nn.getCheckpoints() == std::vector<std::size_t>{1, 4} );
+        nn.checkpointEvery(1);
+        REQUIRE( nn.getCheckpoints().empty() );
+        nn.checkpointAt({0, 1, 2, 3, 4, 5, 6, 7});
+        REQUIRE( nn.getCheckpoints().empty() );
+
+        REQUIRE_THROWS_AS( nn.checkpointAt({9}), std::logic_error );
+        NeuralNetworks::NeuralNetwork<float> bf16(LossType::MSE, 0.1, 1, 32, 1, Math::Layout::FeatureMajor, Math::Precision::BFloat16);
+        bf16.AddDenseLayer(4, 4, ActivationTypes::Tanh);
+        bf16.AddDenseLayer(4, 1, ActivationTypes::Linear);
+        REQUIRE_THROWS_AS( bf16.checkpointEvery(2), std::logic_error );
+    }
+}
@@ -0,0 +1,51 @@
+//
+// Created by timwe on 12/6/2025.
+//
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "../../Math/Layout.h"
+#include "../../Math/Matrix.h"
+#include "../../NeuralNetworks/NeuralNetwork.h"
+
+// Dataset and network builders shared by the network tests
+namespace NetworkFixtures {
+    struct Dense {
+        std::size_t in, out;
+        NeuralNetworks::ActivationTypes activation;
+    };
+
+    // features x samples (samples x features for SampleMajor): a fast sine, a slow cosine, then sawtooths with growing
+    // periods. The label is 1 where the first two features have the same sign, features must be >= 2
+    template<Math::floatTypes T>
+    std::pair<Math::Matrix<T>, Math::Matrix<T>> dataset(std::size_t features, std::size_t samples,
+                                                        Math::Layout layout = Math::Layout::FeatureMajor) {
+        Math::Matrix<T> X(features, samples), Y(1, samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            const T t = static_cast<T>(i);
+            X(0, i) = std::sin(T{0.3} * t);
+            X(1, i) = std::cos(T{0.07} * t);
+            for (std::size_t f = 2; f < features; ++f)
+                X(f, i) = static_cast<T>(i % (f + 3)) / static_cast<T>(f + 3) - T{0.4};
+            Y(0, i) = X(0, i) * X(1, i) > 0 ? T{1} : T{0};
+        }
+        if (layout == Math::Layout::SampleMajor) {
+            X.transposeSelf();
+            Y.transposeSelf();
+        }
+        return std::pair{std::move(X), std::move(Y)};
+    }
+
+    // NeuralNetwork<T>(args...) with the dense layers added in order
+    template<Math::floatTypes T, class... Args>
+    NeuralNetworks::NeuralNetwork<T> network(std::initializer_list<Dense> layers, Args&&... args) {
+        NeuralNetworks::NeuralNetwork<T> nn(std::forward<Args>(args)...);
+        for (const Dense& layer : layers)
+            nn.AddDenseLayer(layer.in, layer.out, layer.activation);
+        return nn;
+    }
+} // NetworkFixtures
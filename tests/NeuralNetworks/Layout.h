@@ -0,0 +1,65 @@
+//
+// Created by timwe on 11/21/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+
+#include "../../Math/Layout.h"
+#include "../../NeuralNetworks/NeuralNetwork.h"
+
+TEST_CASE("LAYOUTS") {
+    SECTION("transposeSelf for square and rectangular matrices") {
+        for (const auto& [rows, cols] : {std::pair<std::size_t, std::size_t>{37, 37}, {5, 70}, {70, 3}}) {
+            Math::Matrix<float> A(rows, cols);
+            for (std::size_t r = 0; r < rows; ++r)
+                for (std::size_t c = 0; c < cols; ++c)
+                    A(r, c) = static_cast<float>(r * 1000 + c);
+
+            Math::Matrix<float> B = A;
+            const float* buffer = B.data().data();
+            B.transposeSelf();
+            REQUIRE( (B.data().data() == buffer) == (rows == cols) ); // only square matrices stay in their buffer
+            REQUIRE( B.rows() == cols );
+            REQUIRE( B.cols() == rows );
+            for (std::size_t r = 0; r < rows; ++r)
+                for (std::size_t c = 0; c < cols; ++c)
+                    REQUIRE( B(c, r) == A(r, c) );
+            for (std::size_t r = 0; r < B.rows(); ++r)
+                for (std::size_t c = B.cols(); c < B.stride(); ++c)
+                    REQUIRE( B.data()[r * B.stride() + c] == 0.0f );
+        }
+    }
+
+    SECTION("both layouts train the same network") {
+        using NeuralNetworks::ActivationTypes;
+        constexpr std::size_t samples = 50;
+        Math::Matrix<double> X(2, samples), Y(1, samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            X(0, i) = static_cast<double>(i) / samples - 0.5;
+            X(1, i) = std::sin(static_cast<double>(i));
+            Y(0, i) = X(0, i) * X(1, i) > 0 ? 1.0 : 0.0;
+        }
+
+        auto build = [](Math::Layout layout) {
+            NeuralNetworks::NeuralNetwork<double> nn(NeuralNetworks::LossType::BCE, 0.1, 20, 32, 7, layout);
+            nn.AddDenseLayer(2, 9, ActivationTypes::Tanh);
+            nn.AddDenseLayer(9, 1, ActivationTypes::Sigmoid);
+            return nn;
+        };
+        auto featureMajor = build(Math::Layout::FeatureMajor);
+        auto sampleMajor = build(Math::Layout::SampleMajor);
+
+        Math::Matrix<double> Xs = X, Ys = Y;
+        Xs.transposeSelf();
+        Ys.transposeSelf();
+
+        REQUIRE( featureMajor.train(X, Y) == Catch::Approx(sampleMajor.train(Xs, Ys)).epsilon(1e-10) );
+
+        auto Yf = featureMajor.forward(X);
+        const auto Ysm = sampleMajor.forward(Xs.view().rowRange(3, 1)); // batch-1 inference on one sample
+        REQUIRE( Ysm(0, 0) == Catch::Approx(Yf(0, 3)).epsilon(1e-10) );
+    }
+}
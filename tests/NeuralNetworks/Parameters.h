@@ -0,0 +1,135 @@
+//
+// Created by timwe on 12/5/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "Fixtures.h"
+
+TEST_CASE("PARAMETER ARENA") {
+    using NeuralNetworks::ActivationTypes;
+    using NeuralNetworks::LossType;
+    constexpr std::size_t samples = 150;
+
+    const auto [X, Y] = NetworkFixtures::dataset<double>(2, samples);
+
+    auto build = [](std::size_t seed, Math::Precision precision = Math::Precision::Full) {
+        return NetworkFixtures::network<double>({{2, 9, ActivationTypes::Tanh}, // odd widths, so the matrices have padding and gaps between them
+                                                 {9, 5, ActivationTypes::ReLU},
+                                                 {5, 1, ActivationTypes::Sigmoid}},
+                                                LossType::BCE, 0.2, 5, 64, seed, Math::Layout::FeatureMajor, precision);
+    };
+
+    SECTION("every W and b is a part of the one block, in layer order") {
+        const auto nn = build(4);
+        const auto parameters = nn.getParameters();
+        REQUIRE( parameters.rows() == 1 );
+        REQUIRE( nn.getGradients().cols() == parameters.cols() );
+
+        const double* next = parameters.data();
+        for (const auto& layer : nn.getLayers())
+            for (const Math::Matrix<double>* M : {&layer.getW(), &layer.getB()}) {
+                REQUIRE( M->data().data() >= next );
+                next = M->data().data() + M->bufferSize();
+                REQUIRE( next <= parameters.data() + parameters.cols() );
+            }
+        const auto other = build(5);
+        for (const auto& layer : nn.getLayers()) {
+            REQUIRE( layer.placedIn(parameters, nn.getGradients()) );
+            REQUIRE_FALSE( layer.placedIn(other.getParameters(), nn.getGradients()) );
+        }
+        // Not a copy: the values of the layers are the ones in the block
+        const auto& W = nn.getLayers()[1].getW();
+        const auto offset = W.data().data() - parameters.data();
+        REQUIRE( parameters.data()[offset + W.stride() + 2] == W(1, 2) );
+    }
+
+    SECTION("the update is one sweep of W - lr * dW over the block") {
+        auto nn = build(4);
+        const auto& Yhat = nn.forward(X);
+        nn.backward(Y, Yhat);
+
+        const std::vector<double> before(nn.getParameters().data(), nn.getParameters().data() + nn.getParameters().cols());
+        const std::vector<double> gradients(nn.getGradients().data(), nn.getGradients().data() + nn.getGradients().cols());
+        double squares = 0.0;
+        for (const double g : gradients)
+            squares += g * g;
+        REQUIRE( squares > 0.0 );
+        REQUIRE( nn.gradientNorm() == Catch::Approx(std::sqrt(squares)) );
+
+        nn.update();
+        const double* after = nn.getParameters().data();
+        for (std::size_t i = 0; i < before.size(); ++i)
+            REQUIRE( after[i] == Catch::Approx(before[i] - 0.2 * gradients[i]).margin(1e-15) );
+
+        // dW of the last layer sits where its W is
+        const auto& last = nn.getLayers().back();
+        const auto offset = last.getW().data().data() - nn.getParameters().data();
+        REQUIRE( last.getW()(0, 3) == Catch::Approx(before[offset + 3] - 0.2 * gradients[offset + 3]).margin(1e-15) );
+    }
+
+    SECTION("parameters move between networks with one copy") {
+        auto trained = build(4);
+        (void)trained.train(X, Y);
+        auto other = build(8);
+        REQUIRE( other.predict(X)(0, 7) != trained.predict(X)(0, 7) );
+
+        other.setParameters(trained.getParameters());
+        REQUIRE( std::ranges::equal(other.predict(X).data(), trained.predict(X).data()) );
+
+        // An average of two networks is an average of their blocks
+        auto third = build(12);
+        Math::Matrix<double> average(trained.getParameters());
+        for (std::size_t i = 0; i < average.cols(); ++i)
+            average(0, i) = 0.5 * (average(0, i) + third.getParameters().data()[i]);
+        other.setParameters(average);
+        const auto& W0 = other.getLayers()[0].getW();
+        REQUIRE( W0(3, 1) == Catch::Approx(0.5 * (trained.getLayers()[0].getW()(3, 1) + third.getLayers()[0].getW()(3, 1))) );
+
+        auto bf16 = build(8, Math::Precision::BFloat16); // W16 follows
+        bf16.setParameters(trained.getParameters());
+        const auto expected = trained.predict(X), predicted = bf16.predict(X);
+        for (std::size_t i = 0; i < samples; ++i)
+            REQUIRE( predicted(0, i) == Catch::Approx(expected(0, i)).margin(0.02) );
+
+        NeuralNetworks::NeuralNetwork<double> smaller(LossType::BCE, 0.2, 5, 64, 1);
+        smaller.AddDenseLayer(2, 1, ActivationTypes::Sigmoid);
+        REQUIRE_THROWS_AS( smaller.setParameters(trained.getParameters()), std::invalid_argument );
+    }
+
+    SECTION("copies get arenas of their own, assignments keep the layers inside theirs") {
+        auto trained = build(4);
+        (void)trained.train(X, Y);
+        const Math::Matrix<double> expected = trained.predict(X);
+
+        auto copy = trained;
+        REQUIRE( copy.getParameters().data() != trained.getParameters().data() );
+        for (const auto& layer : copy.getLayers())
+            REQUIRE( layer.placedIn(copy.getParameters(), copy.getGradients()) );
+        REQUIRE( std::ranges::equal(copy.predict(X).data(), expected.data()) );
+        (void)copy.train(X, Y); // only the copy moves on
+        REQUIRE( std::ranges::equal(trained.predict(X).data(), expected.data()) );
+
+        auto assigned = build(8);
+        assigned = trained;
+        REQUIRE( std::ranges::equal(assigned.predict(X).data(), expected.data()) );
+
+        auto moved = build(8); // its old layers go back to its old arenas before those are replaced
+        const double* block = copy.getParameters().data();
+        moved = std::move(copy);
+        REQUIRE( moved.getParameters().data() == block );
+        for (const auto& layer : moved.getLayers())
+            REQUIRE( layer.placedIn(moved.getParameters(), moved.getGradients()) );
+        (void)moved.train(X, Y);
+
+        const NeuralNetworks::NeuralNetwork<double> empty(LossType::BCE, 0.2, 5, 64, 1);
+        auto emptyCopy = empty;
+        REQUIRE( emptyCopy.getLayers().empty() );
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Created by timwe on 12/3/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "Fixtures.h"
+
+TEST_CASE("PREDICT") {
+    using NeuralNetworks::ActivationTypes;
+    constexpr std::size_t samples = 300;
+
+    auto data = [](Math::Layout layout) { return NetworkFixtures::dataset<double>(3, samples, layout); };
+
+    auto build = [](Math::Layout layout, Math::Precision precision) {
+        return NetworkFixtures::network<double>({{3, 20, ActivationTypes::Tanh},
+                                                 {20, 41, ActivationTypes::ReLU}, // wider than the first, the buffers are sized to it
+                                                 {41, 7, ActivationTypes::Elu},
+                                                 {7, 1, ActivationTypes::Sigmoid}},
+                                                NeuralNetworks::LossType::BCE, 0.1, 30, 64, 5, layout, precision);
+    };
+
+    SECTION("predict gives the output of forward in both layouts") {
+        for (const auto layout : {Math::Layout::FeatureMajor, Math::Layout::SampleMajor}) {
+            const auto [X, Y] = data(layout);
+            auto nn = build(layout, Math::Precision::Full);
+            (void)nn.train(X, Y);
+
+            const Math::Matrix<double> expected = nn.forward(X);
+            const Math::Matrix<double> predicted = nn.predict(X);
+            REQUIRE( predicted.rows() == expected.rows() );
+            REQUIRE( predicted.cols() == expected.cols() );
+            REQUIRE( std::ranges::equal(predicted.data(), expected.data()) ); // the same gemms and epilogues, padding included
+        }
+    }
+
+    SECTION("BFloat16 networks predict with the bfloat16 weights and T activations") {
+        const auto [X, Y] = data(Math::Layout::FeatureMajor);
+        auto nn = build(Math::Layout::FeatureMajor, Math::Precision::BFloat16);
+        (void)nn.train(X, Y);
+
+        const Math::Matrix<double> expected = nn.forward(X);
+        const Math::Matrix<double> predicted = nn.predict(X);
+        for (std::size_t i = 0; i < samples; ++i)
+            REQUIRE( predicted(0, i) == Catch::Approx(expected(0, i)).margin(0.02) );
+    }
+
+    SECTION("buffers are reused and smaller batches fit into them") {
+        const auto [X, Y] = data(Math::Layout::SampleMajor);
+        auto nn = build(Math::Layout::SampleMajor, Math::Precision::Full);
+        (void)nn.train(X, Y);
+
+        Math::Matrix<double> Yhat;
+        NeuralNetworks::NeuralNetwork<double>::PredictBuffers buffers;
+        nn.predictInto(Yhat, X, buffers);
+        REQUIRE( buffers.ping.rows() == samples );
+        REQUIRE( buffers.ping.cols() == 41 );
+        const double* ping = buffers.ping.data().data();
+
+        const auto part = X.view().rowRange(10, 50);
+        nn.predictInto(Yhat, part, buffers);
+        REQUIRE( buffers.ping.data().data() == ping );
+        REQUIRE( Yhat.rows() == 50 );
+        const Math::Matrix<double> all = nn.predict(X);
+        for (std::size_t i = 0; i < 50; ++i)
+            REQUIRE( Yhat(i, 0) == all(10 + i, 0) ); // every sample only depends on itself
+
+        REQUIRE_THROWS_AS( nn.predictInto(Yhat, Y, buffers), std::logic_error );
+    }
+
+    SECTION("several threads predict with the same const network") {
+        const auto [X, Y] = data(Math::Layout::FeatureMajor);
+        auto trained = build(Math::Layout::FeatureMajor, Math::Precision::Full);
+        (void)trained.train(X, Y);
+        const auto& nn = trained;
+        const Math::Matrix<double> expected = nn.predict(X);
+
+        std::vector<Math::Matrix<double>> results(4);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < results.size(); ++t)
+            threads.emplace_back([&, t] {
+                NeuralNetworks::NeuralNetwork<double>::PredictBuffers buffers;
+                for (int repeat = 0; repeat < 20; ++repeat)
+                    nn.predictInto(results[t], X, buffers);
+            });
+        for (auto& thread : threads)
+            thread.join();
+
+        for (const auto& result : results)
+            REQUIRE( std::ranges::equal(result.data(), expected.data()) );
+    }
+}
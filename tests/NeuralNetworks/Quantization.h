@@ -0,0 +1,94 @@
+//
+// Created by timwe on 11/24/2025.
+//
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include "../../NeuralNetworks/QuantizedNetwork.h"
+#include "Fixtures.h"
+
+TEST_CASE("INT8 QUANTIZATION") {
+    using NeuralNetworks::ActivationTypes;
+    constexpr std::size_t samples = 400;
+    Math::Matrix<float> X(3, samples), Y(1, samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        X(0, i) = std::sin(0.37f * static_cast<float>(i));
+        X(1, i) = std::cos(0.11f * static_cast<float>(i));
+        X(2, i) = 2.0f * std::sin(0.05f * static_cast<float>(i));
+        Y(0, i) = X(0, i) * X(1, i) + 0.1f * X(2, i) > 0 ? 1.0f : 0.0f;
+    }
+
+    auto build = [](Math::Layout layout) {
+        NeuralNetworks::NeuralNetwork<float> nn(NeuralNetworks::LossType::BCE, 0.5, 400, 32, 11, layout);
+        nn.AddDenseLayer(3, 24, ActivationTypes::Tanh);
+        nn.AddDenseLayer(24, 70, ActivationTypes::ReLU); // more than 64 inputs for the next layer, two k blocks
+        nn.AddDenseLayer(70, 1, ActivationTypes::Sigmoid);
+        return nn;
+    };
+
+    SECTION("int8 predictions follow the float network on the held-out split") {
+        auto nn = build(Math::Layout::FeatureMajor);
+        auto [XTrain, YTrain, XTest, YTest] = nn.trainTestSplit(X, Y, 0.8f);
+        (void)nn.train(XTrain, YTrain);
+
+        auto quantized = NeuralNetworks::QuantizedNetwork<float>::quantize(nn, XTrain);
+        REQUIRE( quantized.layerCount() == 3 );
+
+        const auto report = NeuralNetworks::compareQuantized(nn, quantized, XTest, YTest);
+        REQUIRE( report.samples == XTest.cols() );
+        REQUIRE( report.agreement.has_value() );
+        REQUIRE( *report.agreement >= 0.95 );
+        REQUIRE( report.meanAbsError < 0.05 );
+        REQUIRE( report.quantizedLoss == Approx(report.floatLoss).margin(0.05) );
+
+        const auto single = quantized.forward(XTest.view().colRange(2, 1)); // batch 1 gives the same as inside a batch
+        REQUIRE( single(0, 0) == quantized.forward(XTest)(0, 2) );
+
+        REQUIRE_THROWS_AS( (void)quantized.forward(Y), std::invalid_argument );
+    }
+
+    SECTION("sample-major networks quantize to the same predictions") {
+        auto featureMajor = build(Math::Layout::FeatureMajor);
+        auto sampleMajor = build(Math::Layout::SampleMajor);
+        Math::Matrix<float> Xs = X, Ys = Y;
+        Xs.transposeSelf();
+        Ys.transposeSelf();
+        (void)featureMajor.train(X, Y);
+        (void)sampleMajor.train(Xs, Ys);
+
+        auto qf = NeuralNetworks::QuantizedNetwork<float>::quantize(featureMajor, X);
+        auto qs = NeuralNetworks::QuantizedNetwork<float>::quantize(sampleMajor, Xs);
+        const auto Yf = qf.forward(X);
+        const auto Ysm = qs.forward(Xs);
+        REQUIRE( Ysm.rows() == samples );
+        REQUIRE( Ysm.cols() == 1 );
+        std::size_t same = 0;
+        for (std::size_t i = 0; i < samples; ++i)
+            same += (Yf(0, i) >= 0.5f) == (Ysm(i, 0) >= 0.5f);
+        REQUIRE( same >= samples * 97 / 100 ); // same network up to float rounding, so nearly always the same int8 step
+    }
+
+    SECTION("a checkpointed network calibrates on the activations it doesn't keep") {
+        auto deep = [] {
+            return NetworkFixtures::network<float>({{3, 24, ActivationTypes::Tanh},
+                                                    {24, 24, ActivationTypes::ReLU},
+                                                    {24, 24, ActivationTypes::Tanh},
+                                                    {24, 1, ActivationTypes::Sigmoid}},
+                                                   NeuralNetworks::LossType::BCE, 0.5, 100, 32, 11);
+        };
+        auto reference = deep();
+        auto checkpointed = deep();
+        checkpointed.checkpointEvery(2);
+        (void)reference.train(X, Y);
+        (void)checkpointed.train(X, Y); // the same steps, see CHECKPOINTING
+        REQUIRE( checkpointed.getLayers()[0].getA().rows() == 0 ); // lent cache, went back after the last step
+
+        const auto expected = NeuralNetworks::QuantizedNetwork<float>::quantize(reference, X).forward(X);
+        const auto Yq = NeuralNetworks::QuantizedNetwork<float>::quantize(checkpointed, X).forward(X);
+        REQUIRE( std::ranges::equal(Yq.data(), expected.data()) );
+    }
+}
@@ -4,6 +4,24 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "Functions/Functions.h"
+#include "Math/Gemm.h"
+#include "Math/MatrixExpression.h"
+#include "Math/Elementwise.h"
+#include "Math/VectorMath.h"
+#include "Math/Allocator.h"
+#include "Math/MatrixView.h"
+#include "Math/ThreadPool.h"
+#include "Math/BFloat16.h"
+#include "Math/Statistics.h"
+#include "Math/Transpose.h"
+#include "Math/SparseMatrix.h"
+#include "NeuralNetworks/Layout.h"
+#include "NeuralNetworks/Activations.h"
+#include "NeuralNetworks/Predict.h"
+#include "NeuralNetworks/Checkpointing.h"
+#include "NeuralNetworks/Parameters.h"
+#include "NeuralNetworks/Quantization.h"
+#include "NeuralNetworks/Allocations.h"
 
 unsigned int Factorial( unsigned int number ) {
     return number <= 1 ? number : Factorial(number-1)*number;